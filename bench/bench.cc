@@ -0,0 +1,297 @@
+//----------------------------------*-C++-*----------------------------------//
+// Copyright 2023 UT-Battelle, LLC, and other Celeritas developers.
+// See the top-level COPYRIGHT file for details.
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+//---------------------------------------------------------------------------//
+//! \file bench/bench.cc
+//! \brief End-to-end load benchmark without an interactive GUI.
+//---------------------------------------------------------------------------//
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+#include <TApplication.h>
+#include <TEnv.h>
+#include <TEveManager.h>
+#include <TGeoManager.h>
+#include <TROOT.h>
+#include <TSystem.h>
+#include <sys/resource.h>
+
+#include "EvdCacheViewer.hh"
+#include "EventViewer.hh"
+#include "ParallelFor.hh"
+
+//---------------------------------------------------------------------------//
+/*!
+ * Terminal input options.
+ */
+struct TerminalInput
+{
+    std::string root_file;
+    std::string gdml_file;
+    std::string json_file;
+    unsigned int num_threads{default_num_threads()};
+    MCTruthViewerInterface::TrackDisplay track_display{
+        MCTruthViewerInterface::TrackDisplay::line};
+    double simplify_tolerance{0};
+    std::size_t tree_cache_mb{64};
+    TrackFilter filter;
+    bool rebuild_index{false};
+
+    // Only the ROOT input is necessary
+    explicit operator bool() const { return !root_file.empty(); }
+};
+
+//---------------------------------------------------------------------------//
+/*!
+ * Wall-clock time of each benchmark stage.
+ */
+class StageTimer
+{
+  public:
+    //! Start timing the first stage
+    StageTimer() : last_(Clock::now()) {}
+
+    //! End the current stage and start the next one
+    void stop(std::string name)
+    {
+        auto const now = Clock::now();
+        stages_.emplace_back(std::move(name), Seconds(now - last_).count());
+        last_ = now;
+    }
+
+    //! Stage names and durations [s]
+    std::vector<std::pair<std::string, double>> const& stages() const
+    {
+        return stages_;
+    }
+
+  private:
+    using Clock = std::chrono::steady_clock;
+    using Seconds = std::chrono::duration<double>;
+
+    Clock::time_point last_;
+    std::vector<std::pair<std::string, double>> stages_;
+};
+
+//---------------------------------------------------------------------------//
+/*!
+ * Peak resident set size [MiB].
+ */
+double peak_rss_mib()
+{
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    // Reported in bytes
+    return usage.ru_maxrss / (1024.0 * 1024.0);
+#else
+    // Reported in KiB
+    return usage.ru_maxrss / 1024.0;
+#endif
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Run all stages and write results as JSON.
+ */
+std::string run(TerminalInput const& input)
+{
+    // Eve is created without mapping its window
+    TApplication app("evd-bench", nullptr, nullptr);
+    ROOT::EnableThreadSafety();
+    TEveManager::Create(/* map_window = */ kFALSE);
+    StageTimer timer;
+
+    if (!input.gdml_file.empty())
+    {
+        TGeoManager::SetVerboseLevel(0);
+        TGeoManager::Import(input.gdml_file.c_str());
+        timer.stop("geometry_import");
+    }
+
+    if (input.tree_cache_mb > 0)
+    {
+        gEnv->SetValue("TFile.AsyncPrefetching", 1);
+    }
+    if (input.rebuild_index)
+    {
+        gSystem->Unlink((input.root_file + ".evdidx").c_str());
+    }
+
+    std::unique_ptr<MCTruthViewerInterface> viewer;
+    if (EvdCacheFile::is_cache_file(input.root_file))
+    {
+        // Converted file: the index is read when the file is opened
+        viewer = std::make_unique<EvdCacheViewer>(input.root_file);
+        timer.stop("file_open");
+    }
+    else
+    {
+        UPRootExtern<TFile> tfile(
+            TFile::Open(input.root_file.c_str(), "read"));
+        if (!tfile || tfile->IsZombie())
+        {
+            std::cout << "[ERROR] Could not open " << input.root_file
+                      << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        timer.stop("file_open");
+
+        viewer = EventViewer::make_viewer(std::move(tfile));
+        timer.stop("index_build");
+    }
+
+    viewer->set_num_threads(input.num_threads);
+    viewer->set_track_display(input.track_display);
+    viewer->set_filter(input.filter);
+    viewer->set_tree_cache_size(input.tree_cache_mb << 20);
+    if (input.simplify_tolerance > 0)
+    {
+        viewer->set_simplification(input.simplify_tolerance, 4);
+    }
+    viewer->add_event(-1);
+    timer.stop("load");
+    viewer->stop_workers();
+
+    auto const stats = viewer->load_stats();
+    double load_time = timer.stages().back().second;
+
+    std::ostringstream os;
+    os << "{\n"
+       << "  \"input\": \"" << input.root_file << "\",\n"
+       << "  \"threads\": " << input.num_threads << ",\n"
+       << "  \"events\": " << stats.num_events << ",\n"
+       << "  \"tracks\": " << stats.num_tracks << ",\n"
+       << "  \"steps\": " << stats.num_steps << ",\n"
+       << "  \"steps_per_second\": "
+       << (load_time > 0 ? stats.num_steps / load_time : 0) << ",\n"
+       << "  \"peak_rss_mib\": " << peak_rss_mib() << ",\n"
+       << "  \"tree_cache\": {\n"
+       << "    \"size_mib\": " << input.tree_cache_mb << ",\n"
+       << "    \"cached_bytes\": " << stats.cache.cached_bytes << ",\n"
+       << "    \"cached_reads\": " << stats.cache.cached_reads << ",\n"
+       << "    \"uncached_bytes\": " << stats.cache.uncached_bytes << ",\n"
+       << "    \"uncached_reads\": " << stats.cache.uncached_reads << ",\n"
+       << "    \"hit_fraction\": " << stats.cache.hit_fraction() << "\n"
+       << "  },\n"
+       << "  \"stages\": {\n";
+    for (auto const& stage : timer.stages())
+    {
+        os << "    \"" << stage.first << "\": " << stage.second << ",\n";
+    }
+    os << "    \"decode_thread_total\": " << stats.decode_time << ",\n"
+       << "    \"track_construction\": " << stats.draw_time << "\n"
+       << "  }\n"
+       << "}\n";
+    return os.str();
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Parse terminal input parameters.
+ */
+TerminalInput parse(int argc, char* argv[])
+{
+    TerminalInput input;
+    auto value = [&](int i) -> std::string {
+        if (i == argc - 1)
+        {
+            std::cout << "[ERROR] missing value for " << argv[i] << " flag."
+                      << std::endl;
+            std::exit(EXIT_FAILURE);
+        }
+        return argv[i + 1];
+    };
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg_i(argv[i]);
+        if (arg_i == "-threads")
+        {
+            input.num_threads = std::stoul(value(i++));
+        }
+        else if (arg_i == "-batch")
+        {
+            using TrackDisplay = MCTruthViewerInterface::TrackDisplay;
+            input.track_display = (value(i++) == "run")
+                                      ? TrackDisplay::batch_run
+                                      : TrackDisplay::batch_event;
+        }
+        else if (arg_i == "-simplify")
+        {
+            input.simplify_tolerance = std::stod(value(i++));
+        }
+        else if (arg_i == "-cache-size")
+        {
+            input.tree_cache_mb = std::stoul(value(i++));
+        }
+        else if (arg_i == "-events")
+        {
+            input.filter.set_event_range(value(i++));
+        }
+        else if (arg_i == "-json")
+        {
+            input.json_file = value(i++);
+        }
+        else if (arg_i == "-reindex")
+        {
+            input.rebuild_index = true;
+        }
+        else if (arg_i.length() > 4
+                 && arg_i.substr(arg_i.length() - 4) == "gdml")
+        {
+            input.gdml_file = arg_i;
+        }
+        else if (arg_i.length() > 4
+                 && (arg_i.substr(arg_i.length() - 4) == "root"
+                     || arg_i.substr(arg_i.length() - 4) == ".evd"))
+        {
+            input.root_file = arg_i;
+        }
+        else
+        {
+            std::cout << "[WARNING] Parameter " << arg_i
+                      << " not known. Skipping..." << std::endl;
+        }
+    }
+    return input;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Benchmark loading all events of an input file.
+ *
+ * \code
+ *  evd-bench simulation.root [geometry.gdml] [-threads n] [-batch event|run]
+ *            [-simplify tol] [-cache-size MB] [-events first:last:stride]
+ *            [-reindex] [-json output.json]
+ * \endcode
+ */
+int main(int argc, char* argv[])
+{
+    auto const input = parse(argc, argv);
+    if (!input)
+    {
+        std::cout << "[ERROR] No ROOT input specified. Check README.md for "
+                     "information."
+                  << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    auto const json = run(input);
+    if (input.json_file.empty())
+    {
+        std::cout << json;
+    }
+    else
+    {
+        std::ofstream(input.json_file) << json;
+        std::cout << "Results written to " << input.json_file << std::endl;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,390 @@
+//----------------------------------*-C++-*----------------------------------//
+// Copyright 2023 UT-Battelle, LLC, and other Celeritas developers.
+// See the top-level COPYRIGHT file for details.
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+//---------------------------------------------------------------------------//
+//! \file bench/generate.cc
+//! \brief Write synthetic MC truth files for benchmarking.
+//---------------------------------------------------------------------------//
+#include <array>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include <TFile.h>
+#include <TTree.h>
+
+#include "RootData.hh"
+#include "RootUniquePtr.hh"
+
+//---------------------------------------------------------------------------//
+/*!
+ * Terminal input options.
+ */
+struct TerminalInput
+{
+    std::string format;
+    std::string output_file;
+    std::size_t num_events{10};
+    std::size_t num_tracks{100};
+    std::size_t num_steps{100};
+    unsigned long seed{12345};
+
+    // Format and output are necessary
+    explicit operator bool() const
+    {
+        return (format == "rootdata" || format == "rsw")
+               && !output_file.empty();
+    }
+};
+
+//---------------------------------------------------------------------------//
+/*!
+ * Random walk of a single track.
+ *
+ * Each track starts near the origin with a random direction and loses a fixed
+ * fraction of its energy per step. Steps are mostly transportation or
+ * multiple scattering, with occasional discrete interactions that change
+ * direction. Tracks start at random times and move at a random fixed speed,
+ * so that some of them are slow and late.
+ */
+struct SyntheticTrack
+{
+    int id;
+    int parent_id;
+    int pdg;
+    std::vector<std::array<double, 3>> points;  //!< Vertex, then steps [cm]
+    std::vector<double> energy;  //!< Pre-step energy, per point [MeV]
+    std::vector<double> time;  //!< Global time, per point [s]
+    std::vector<rootdata::ProcessId> process;  //!< Per step
+};
+
+//---------------------------------------------------------------------------//
+/*!
+ * Generate a track with a given number of steps.
+ */
+SyntheticTrack
+make_track(std::mt19937_64& rng, int id, int parent_id, std::size_t num_steps)
+{
+    using rootdata::ProcessId;
+    static int const pdgs[] = {22, 22, 11, 11, -11, 13};
+    static ProcessId const interactions[] = {ProcessId::e_ioni,
+                                             ProcessId::e_brems,
+                                             ProcessId::compton,
+                                             ProcessId::photoelectric};
+
+    std::uniform_real_distribution<double> uniform(0, 1);
+    std::normal_distribution<double> normal(0, 1);
+    std::exponential_distribution<double> step_length(2);
+    std::exponential_distribution<double> start_time(1e8);
+
+    auto random_direction = [&] {
+        std::array<double, 3> dir{normal(rng), normal(rng), normal(rng)};
+        double norm = std::sqrt(dir[0] * dir[0] + dir[1] * dir[1]
+                                + dir[2] * dir[2]);
+        for (auto& d : dir)
+        {
+            d /= norm;
+        }
+        return dir;
+    };
+
+    SyntheticTrack result;
+    result.id = id;
+    result.parent_id = parent_id;
+    result.pdg = pdgs[rng() % (sizeof(pdgs) / sizeof(pdgs[0]))];
+    result.points.reserve(num_steps + 1);
+    result.energy.reserve(num_steps + 1);
+    result.time.reserve(num_steps + 1);
+    result.process.reserve(num_steps);
+
+    std::array<double, 3> pos{normal(rng), normal(rng), normal(rng)};
+    auto dir = random_direction();
+    double energy = 1000 * uniform(rng);
+    double time = start_time(rng);
+    double const speed = 3e10 * (0.01 + 0.99 * uniform(rng));  // [cm/s]
+    result.points.push_back(pos);
+    result.energy.push_back(energy);
+    result.time.push_back(time);
+
+    for (std::size_t i = 0; i < num_steps; i++)
+    {
+        double const u = uniform(rng);
+        ProcessId process = ProcessId::transportation;
+        if (u < 0.05)
+        {
+            // Discrete interaction: new direction
+            process = interactions[rng() % 4];
+            dir = random_direction();
+        }
+        else if (u < 0.5)
+        {
+            // Multiple scattering: small deflection
+            process = ProcessId::msc;
+            for (auto& d : dir)
+            {
+                d += 0.1 * normal(rng);
+            }
+        }
+
+        double const length = step_length(rng);
+        for (int j = 0; j < 3; j++)
+        {
+            pos[j] += length * dir[j];
+        }
+        energy *= 0.99;
+        time += length / speed;
+        result.points.push_back(pos);
+        result.energy.push_back(energy);
+        result.time.push_back(time);
+        result.process.push_back(process);
+    }
+    return result;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Generate all tracks of an event. The first track is the primary.
+ */
+std::vector<SyntheticTrack>
+make_event(std::mt19937_64& rng, TerminalInput const& input)
+{
+    std::vector<SyntheticTrack> result;
+    result.reserve(input.num_tracks);
+    for (std::size_t i = 0; i < input.num_tracks; i++)
+    {
+        int const parent_id = (i == 0) ? -1 : rng() % i;
+        result.push_back(make_track(rng, i, parent_id, input.num_steps));
+    }
+    return result;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Convert a synthetic track to the geant4-validation-app format.
+ */
+rootdata::Track to_rootdata(SyntheticTrack const& track)
+{
+    rootdata::Track result;
+    result.pdg = track.pdg;
+    result.id = track.id;
+    result.parent_id = track.parent_id < 0 ? 0 : track.parent_id;
+    result.length = 0;
+    result.energy_dep = track.energy.front() - track.energy.back();
+    result.vertex_energy = track.energy.front();
+    result.vertex_global_time = track.time.front();
+    result.vertex_direction = {0, 0, 1};
+    auto const& vtx = track.points.front();
+    result.vertex_position = {vtx[0], vtx[1], vtx[2]};
+    result.number_of_steps = track.process.size();
+
+    result.steps.resize(track.process.size());
+    for (std::size_t i = 0; i < result.steps.size(); i++)
+    {
+        auto const& pre = track.points[i];
+        auto const& post = track.points[i + 1];
+        auto& step = result.steps[i];
+        step.process_id = track.process[i];
+        step.kinetic_energy = track.energy[i + 1];
+        step.energy_loss = track.energy[i] - track.energy[i + 1];
+        step.direction = {0, 0, 1};
+        step.position = {post[0], post[1], post[2]};
+        step.global_time = track.time[i + 1];
+        result.length += std::hypot(
+            post[0] - pre[0], post[1] - pre[1], post[2] - pre[2]);
+    }
+    return result;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Write a geant4-validation-app \c events tree.
+ */
+void write_rootdata(TerminalInput const& input, TFile* tfile)
+{
+    std::mt19937_64 rng(input.seed);
+    rootdata::Event event;
+    auto* event_ptr = &event;
+
+    auto* ttree = new TTree("events", "events");
+    ttree->SetDirectory(tfile);
+    ttree->Branch("event", &event_ptr);
+
+    for (std::size_t i = 0; i < input.num_events; i++)
+    {
+        event.id = i;
+        event.primaries.clear();
+        event.secondaries.clear();
+        for (auto const& track : make_event(rng, input))
+        {
+            auto& tracks = (track.parent_id < 0) ? event.primaries
+                                                 : event.secondaries;
+            tracks.push_back(to_rootdata(track));
+        }
+        ttree->Fill();
+    }
+    ttree->Write();
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Write a \c celeritas::RootStepWriter \c steps tree.
+ *
+ * Steps are written the way a GPU run does: one step of every active track of
+ * an event at a time, so that tracks are interleaved in the tree.
+ */
+void write_rsw(TerminalInput const& input, TFile* tfile)
+{
+    std::mt19937_64 rng(input.seed);
+    int event_id, track_id, particle, track_step_count, parent_id;
+    double pre_pos[3], post_pos[3], pre_energy, step_length, energy_deposition;
+    double pre_time, post_time;
+
+    auto* ttree = new TTree("steps", "steps");
+    ttree->SetDirectory(tfile);
+    ttree->Branch("event_id", &event_id, "event_id/I");
+    ttree->Branch("track_id", &track_id, "track_id/I");
+    ttree->Branch("parent_id", &parent_id, "parent_id/I");
+    ttree->Branch("particle", &particle, "particle/I");
+    ttree->Branch("track_step_count", &track_step_count, "track_step_count/I");
+    ttree->Branch("pre_energy", &pre_energy, "pre_energy/D");
+    ttree->Branch("step_length", &step_length, "step_length/D");
+    ttree->Branch(
+        "energy_deposition", &energy_deposition, "energy_deposition/D");
+    ttree->Branch("pre_pos", pre_pos, "pre_pos[3]/D");
+    ttree->Branch("post_pos", post_pos, "post_pos[3]/D");
+    ttree->Branch("pre_time", &pre_time, "pre_time/D");
+    ttree->Branch("post_time", &post_time, "post_time/D");
+
+    for (std::size_t i = 0; i < input.num_events; i++)
+    {
+        auto const tracks = make_event(rng, input);
+        event_id = i;
+        for (std::size_t step = 0; step < input.num_steps; step++)
+        {
+            for (auto const& track : tracks)
+            {
+                auto const& pre = track.points[step];
+                auto const& post = track.points[step + 1];
+                track_id = track.id;
+                parent_id = track.parent_id;
+                particle = track.pdg;
+                track_step_count = step + 1;
+                pre_energy = track.energy[step];
+                energy_deposition = track.energy[step]
+                                    - track.energy[step + 1];
+                pre_time = track.time[step];
+                post_time = track.time[step + 1];
+                step_length = std::hypot(
+                    post[0] - pre[0], post[1] - pre[1], post[2] - pre[2]);
+                for (int j = 0; j < 3; j++)
+                {
+                    pre_pos[j] = pre[j];
+                    post_pos[j] = post[j];
+                }
+                ttree->Fill();
+            }
+        }
+    }
+    ttree->Write();
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Parse terminal input parameters.
+ */
+TerminalInput parse(int argc, char* argv[])
+{
+    TerminalInput input;
+    auto value = [&](int i) -> std::string {
+        if (i == argc - 1)
+        {
+            std::cout << "[ERROR] missing value for " << argv[i] << " flag."
+                      << std::endl;
+            std::exit(EXIT_FAILURE);
+        }
+        return argv[i + 1];
+    };
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg_i(argv[i]);
+        if (arg_i == "-events")
+        {
+            input.num_events = std::stoul(value(i++));
+        }
+        else if (arg_i == "-tracks")
+        {
+            input.num_tracks = std::stoul(value(i++));
+        }
+        else if (arg_i == "-steps")
+        {
+            input.num_steps = std::stoul(value(i++));
+        }
+        else if (arg_i == "-seed")
+        {
+            input.seed = std::stoul(value(i++));
+        }
+        else if (input.format.empty())
+        {
+            input.format = arg_i;
+        }
+        else if (input.output_file.empty())
+        {
+            input.output_file = arg_i;
+        }
+        else
+        {
+            std::cout << "[WARNING] Parameter " << arg_i
+                      << " not known. Skipping..." << std::endl;
+        }
+    }
+    return input;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Generate a synthetic input file.
+ *
+ * \code
+ *  evd-gen [rootdata|rsw] output.root [-events n] [-tracks n] [-steps n]
+ *          [-seed n]
+ * \endcode
+ */
+int main(int argc, char* argv[])
+{
+    auto const input = parse(argc, argv);
+    if (!input)
+    {
+        std::cout << "Usage: evd-gen [rootdata|rsw] output.root [-events n] "
+                     "[-tracks n] [-steps n] [-seed n]"
+                  << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    UPRootExtern<TFile> tfile(
+        TFile::Open(input.output_file.c_str(), "recreate"));
+    if (!tfile || tfile->IsZombie())
+    {
+        std::cout << "[ERROR] Could not create " << input.output_file
+                  << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    if (input.format == "rootdata")
+    {
+        write_rootdata(input, tfile.get());
+    }
+    else
+    {
+        write_rsw(input, tfile.get());
+    }
+    tfile->Close();
+
+    std::cout << "Wrote " << input.num_events << " events with "
+              << input.num_tracks << " tracks of " << input.num_steps
+              << " steps (" << input.format << ") to " << input.output_file
+              << std::endl;
+    return EXIT_SUCCESS;
+}
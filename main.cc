@@ -7,10 +7,20 @@
 //! \brief Geometry and event display for Celeritas.
 //---------------------------------------------------------------------------//
 #include <iostream>
+#include <memory>
 #include <string>
+#include <vector>
+#include <TEnv.h>
+#include <TEveQuadSet.h>
+#include <TROOT.h>
 
+#include "BoundingBox.hh"
+#include "EnergyDepositMap.hh"
 #include "EventViewer.hh"
 #include "MainViewer.hh"
+#include "ParallelFor.hh"
+#include "Profiler.hh"
+#include "ProjectionMap.hh"
 
 //---------------------------------------------------------------------------//
 /*!
@@ -19,12 +29,31 @@
 struct TerminalInput
 {
     std::string gdml_file;
-    std::string root_file;
+    std::vector<std::string> root_files;
     std::size_t event_id{0};
     int vis_option{0};
     int vis_level{1};
+    unsigned int num_threads{default_num_threads()};
+    MCTruthViewerInterface::TrackDisplay track_display{
+        MCTruthViewerInterface::TrackDisplay::line};
+    double simplify_tolerance{0};
+    bool segment_index{false};
+    bool track_trees{false};
+    bool time_window{false};
+    bool summary{false};
+    std::size_t event_cache_mb{512};
+    std::size_t tree_cache_mb{64};
+    unsigned int num_prefetch{2};
+    TrackFilter filter;
+    EnergyDepositMap::Dims edep_dims{0, 0, 0};  //!< Zero if not binned
+    std::string projections;  //!< Empty if tracks are projected
+    unsigned int projection_bins{512};
+    std::string region;
     bool is_cms{false};
+    bool geometry_cache{true};
     bool show_steps{false};
+    bool profile{false};
+    std::string profile_file;
 
     // Only the GDML input is necessary
     explicit operator bool() const { return !gdml_file.empty(); }
@@ -36,8 +65,16 @@ struct TerminalInput
  */
 void run(TerminalInput const& input)
 {
+    // Events may be decoded on worker threads
+    ROOT::EnableThreadSafety();
+
+    if (input.profile)
+    {
+        Profiler::instance().enable();
+    }
+
     // Initialize main viewer
-    MainViewer evd(input.gdml_file);
+    MainViewer evd(input.gdml_file, input.geometry_cache);
     evd.set_vis_option(input.vis_option);
     evd.set_vis_level(input.vis_level);
 
@@ -51,18 +88,130 @@ void run(TerminalInput const& input)
         evd.add_world_volume();
     }
 
-    if (!input.root_file.empty())
+    std::unique_ptr<EventViewer> event_viewer;
+    if (!input.root_files.empty())
     {
+        if (input.tree_cache_mb > 0)
+        {
+            // Read baskets ahead of the cache on a separate thread
+            gEnv->SetValue("TFile.AsyncPrefetching", 1);
+        }
+
         // Initialize event viewer
-        EventViewer event_viewer(input.root_file);
-        event_viewer.show_step_points(input.show_steps);
-        event_viewer.add_event(input.event_id);
+        event_viewer = std::make_unique<EventViewer>(input.root_files);
+        event_viewer->show_step_points(input.show_steps);
+        event_viewer->set_num_threads(input.num_threads);
+        event_viewer->set_track_display(input.track_display);
+
+        bool const edep_map = input.edep_dims[0] > 0;
+        event_viewer->set_filter(input.filter);
+        if (input.simplify_tolerance > 0)
+        {
+            event_viewer->set_simplification(input.simplify_tolerance, 4);
+        }
+        event_viewer->set_segment_index(input.segment_index);
+        event_viewer->set_track_trees(input.track_trees);
+        event_viewer->set_time_window(input.time_window);
+        event_viewer->set_event_cache(input.event_cache_mb << 20,
+                                      input.num_prefetch);
+        event_viewer->set_tree_cache_size(input.tree_cache_mb << 20);
+
+        BoundingBox region{};
+        std::unique_ptr<ProjectionMap> projections;
+        if (edep_map || !input.projections.empty())
+        {
+            region = input.region.empty() ? geometry_bbox()
+                                          : parse_bbox(input.region);
+        }
+        if (!input.projections.empty())
+        {
+            projections = std::make_unique<ProjectionMap>(
+                region,
+                input.projection_bins,
+                input.projections == "energy"
+                    ? ProjectionMap::Quantity::energy
+                    : ProjectionMap::Quantity::length);
+        }
+        auto show_projections = [&evd](ProjectionMap const& map) {
+            using Plane = ProjectionMap::Plane;
+            for (auto plane : {Plane::xy, Plane::zy, Plane::xz})
+            {
+                evd.set_projection(plane, map.make_quads(plane));
+            }
+        };
+
+        if (edep_map)
+        {
+            if (static_cast<int>(input.event_id) >= 0)
+            {
+                // Only bin the requested event
+                auto filter = input.filter;
+                filter.event_first = input.event_id;
+                filter.event_last = input.event_id + 1;
+                filter.event_stride = 1;
+                event_viewer->set_filter(filter);
+            }
+            if (projections)
+            {
+                // No track is loaded: projections are histogrammed first
+                event_viewer->fill_projections(projections.get());
+                show_projections(*projections);
+            }
+
+            // Energy deposition is binned before the GUI starts
+            EnergyDepositMap map(region, input.edep_dims);
+            event_viewer->draw_energy_map(&map);
+        }
+        else
+        {
+            // Tracks are drawn while the GUI is running
+            if (projections)
+            {
+                // Projections are histogrammed from the loaded events and
+                // shown once loading ends
+                evd.enable_projections();
+                event_viewer->load_projections(std::move(projections),
+                                               show_projections);
+            }
+            if (input.summary)
+            {
+                // Events are summarized before the GUI starts
+                event_viewer->load_summary();
+            }
+            event_viewer->start_loading(input.event_id);
+        }
     }
 
     // Start GUI
     evd.start_viewer();
+
+    if (input.profile)
+    {
+        // Stop background work before reporting
+        event_viewer.reset();
+        Profiler::instance().print_summary();
+        if (!input.profile_file.empty())
+        {
+            Profiler::instance().write_trace(input.profile_file);
+        }
+    }
 };
 
+//---------------------------------------------------------------------------//
+/*!
+ * Return the value following flag \c argv[i] , or stop if it is missing.
+ */
+std::string flag_value(int argc, char* argv[], int i)
+{
+    if (i == argc - 1)
+    {
+        std::cout << "[ERROR] missing value for " << argv[i] << " flag."
+                  << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    return argv[i + 1];
+}
+
 //---------------------------------------------------------------------------//
 /*!
  * Parse terminal input parameters.
@@ -99,6 +248,193 @@ TerminalInput parse(int argc, char* argv[])
             input.event_id = std::stol(argv[i + 1]);
             i++;
         }
+        else if (arg_i == "-threads")
+        {
+            if (i == argc - 1 || std::stoi(argv[i + 1]) < 1)
+            {
+                std::cout << "[ERROR] -threads requires a positive value."
+                          << std::endl;
+                std::exit(EXIT_FAILURE);
+            }
+            // Set number of threads for loading all events
+            input.num_threads = std::stoi(argv[i + 1]);
+            i++;
+        }
+        else if (arg_i == "-batch")
+        {
+            using TrackDisplay = MCTruthViewerInterface::TrackDisplay;
+            std::string mode = (i == argc - 1) ? "" : argv[i + 1];
+            if (mode == "event")
+            {
+                input.track_display = TrackDisplay::batch_event;
+            }
+            else if (mode == "run")
+            {
+                input.track_display = TrackDisplay::batch_run;
+            }
+            else
+            {
+                std::cout << "[ERROR] -batch must be either event or run."
+                          << std::endl;
+                std::exit(EXIT_FAILURE);
+            }
+            i++;
+        }
+        else if (arg_i == "-simplify")
+        {
+            if (i == argc - 1 || std::stod(argv[i + 1]) <= 0)
+            {
+                std::cout << "[ERROR] -simplify requires a positive "
+                             "tolerance."
+                          << std::endl;
+                std::exit(EXIT_FAILURE);
+            }
+            // Set track simplification tolerance [cm]
+            input.simplify_tolerance = std::stod(argv[i + 1]);
+            i++;
+        }
+        else if (arg_i == "-index")
+        {
+            // Index loaded segments for region queries and culling
+            input.segment_index = true;
+        }
+        else if (arg_i == "-ancestry")
+        {
+            // Index track parents for shower navigation
+            input.track_trees = true;
+        }
+        else if (arg_i == "-timeline")
+        {
+            // Sort loaded segments by time for time window scrubbing
+            input.time_window = true;
+        }
+        else if (arg_i == "-summary")
+        {
+            // List event summaries in a sortable table
+            input.summary = true;
+        }
+        else if (arg_i == "-event-cache")
+        {
+            // Memory limit of decoded events kept for navigation [MB]
+            input.event_cache_mb = std::stoul(flag_value(argc, argv, i));
+            i++;
+        }
+        else if (arg_i == "-cache-size")
+        {
+            // Maximum read-ahead cache of each reader [MB]
+            input.tree_cache_mb = std::stoul(flag_value(argc, argv, i));
+            i++;
+        }
+        else if (arg_i == "-prefetch")
+        {
+            // Number of events decoded ahead during navigation
+            input.num_prefetch = std::stoul(flag_value(argc, argv, i));
+            i++;
+        }
+        else if (arg_i == "-events")
+        {
+            // Select event range for drawing all events
+            input.filter.set_event_range(flag_value(argc, argv, i));
+            i++;
+        }
+        else if (arg_i == "-pdg")
+        {
+            // Only draw listed particles
+            input.filter.pdg_allow = parse_pdg_list(flag_value(argc, argv, i));
+            i++;
+        }
+        else if (arg_i == "-no-pdg")
+        {
+            // Never draw listed particles
+            input.filter.pdg_deny = parse_pdg_list(flag_value(argc, argv, i));
+            i++;
+        }
+        else if (arg_i == "-min-energy")
+        {
+            // Minimum track vertex energy [MeV]
+            input.filter.min_vertex_energy
+                = std::stod(flag_value(argc, argv, i));
+            i++;
+        }
+        else if (arg_i == "-min-length")
+        {
+            // Minimum track length [cm]
+            input.filter.min_length = std::stod(flag_value(argc, argv, i));
+            i++;
+        }
+        else if (arg_i == "-primaries")
+        {
+            // Only draw primary tracks
+            input.filter.primaries_only = true;
+        }
+        else if (arg_i == "-select")
+        {
+            // Only draw tracks passing an expression
+            input.filter.track_select = Expression(
+                flag_value(argc, argv, i), Expression::Scope::track);
+            i++;
+        }
+        else if (arg_i == "-event-select")
+        {
+            // Only draw events passing an expression
+            input.filter.event_select = Expression(
+                flag_value(argc, argv, i), Expression::Scope::event);
+            i++;
+        }
+        else if (arg_i == "-edep")
+        {
+            // Draw energy deposition binned in a voxel grid instead of tracks
+            input.edep_dims = parse_grid_dims(flag_value(argc, argv, i));
+            i++;
+        }
+        else if (arg_i == "-projections")
+        {
+            // Show histograms instead of tracks in the projection viewers
+            input.projections = flag_value(argc, argv, i);
+            if (input.projections != "length" && input.projections != "energy")
+            {
+                std::cout << "[ERROR] -projections must be either length or "
+                             "energy."
+                          << std::endl;
+                std::exit(EXIT_FAILURE);
+            }
+            i++;
+        }
+        else if (arg_i == "-projection-bins")
+        {
+            if (i == argc - 1 || std::stoi(argv[i + 1]) < 1)
+            {
+                std::cout << "[ERROR] -projection-bins requires a positive "
+                             "value."
+                          << std::endl;
+                std::exit(EXIT_FAILURE);
+            }
+            // Number of projection bins along each axis
+            input.projection_bins = std::stoi(argv[i + 1]);
+            i++;
+        }
+        else if (arg_i == "-region")
+        {
+            // Region binned by -edep and -projections [cm]
+            input.region = flag_value(argc, argv, i);
+            i++;
+        }
+        else if (arg_i == "-no-geo-cache")
+        {
+            // Always import the GDML file
+            input.geometry_cache = false;
+        }
+        else if (arg_i == "-profile")
+        {
+            // Print phase timings on exit, optionally writing a trace file
+            input.profile = true;
+            std::string next = (i == argc - 1) ? "" : argv[i + 1];
+            if (next.length() > 5 && next.substr(next.length() - 5) == ".json")
+            {
+                input.profile_file = next;
+                i++;
+            }
+        }
         else if (arg_i == "-s")
         {
             // Draw step points
@@ -116,10 +452,11 @@ TerminalInput parse(int argc, char* argv[])
             input.gdml_file = argv[i];
         }
         else if (arg_i.length() > 4
-                 && arg_i.substr(arg_i.length() - 4) == "root")
+                 && (arg_i.substr(arg_i.length() - 4) == "root"
+                     || arg_i.substr(arg_i.length() - 4) == ".evd"))
         {
-            // Fetch root simulation file
-            input.root_file = argv[i];
+            // Fetch root simulation files, or their evd-convert output
+            input.root_files.push_back(argv[i]);
         }
         else
         {
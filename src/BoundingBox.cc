@@ -0,0 +1,68 @@
+//----------------------------------*-C++-*----------------------------------//
+// Copyright 2023 UT-Battelle, LLC, and other Celeritas developers.
+// See the top-level COPYRIGHT file for details.
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+//---------------------------------------------------------------------------//
+//! \file src/BoundingBox.cc
+//---------------------------------------------------------------------------//
+#include "BoundingBox.hh"
+
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <TGeoBBox.h>
+#include <TGeoManager.h>
+#include <assert.h>
+#include <stdlib.h>
+
+//---------------------------------------------------------------------------//
+/*!
+ * Bounding box of the top volume of the loaded geometry.
+ */
+BoundingBox geometry_bbox()
+{
+    assert(gGeoManager && gGeoManager->GetTopVolume());
+    auto const* shape
+        = static_cast<TGeoBBox*>(gGeoManager->GetTopVolume()->GetShape());
+    double const half[] = {shape->GetDX(), shape->GetDY(), shape->GetDZ()};
+    double const* origin = shape->GetOrigin();
+
+    BoundingBox result;
+    for (int i = 0; i < 3; i++)
+    {
+        result.lower[i] = origin[i] - half[i];
+        result.upper[i] = origin[i] + half[i];
+    }
+    return result;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Parse a box [cm] from \c xmin,ymin,zmin,xmax,ymax,zmax .
+ */
+BoundingBox parse_bbox(std::string const& box)
+{
+    std::vector<double> values;
+    std::stringstream ss(box);
+    for (std::string value; std::getline(ss, value, ',');)
+    {
+        values.push_back(std::stod(value));
+    }
+
+    BoundingBox result;
+    if (values.size() == 6)
+    {
+        for (int i = 0; i < 3; i++)
+        {
+            result.lower[i] = values[i];
+            result.upper[i] = values[i + 3];
+        }
+    }
+    if (values.size() != 6 || !result)
+    {
+        std::cout << "[ERROR] Invalid box " << box
+                  << ". Expected xmin,ymin,zmin,xmax,ymax,zmax" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    return result;
+}
@@ -0,0 +1,38 @@
+//----------------------------------*-C++-*----------------------------------//
+// Copyright 2023 UT-Battelle, LLC, and other Celeritas developers.
+// See the top-level COPYRIGHT file for details.
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+//---------------------------------------------------------------------------//
+//! \file src/BoundingBox.hh
+//---------------------------------------------------------------------------//
+#pragma once
+
+#include <array>
+#include <string>
+
+//---------------------------------------------------------------------------//
+/*!
+ * Axis-aligned box [cm].
+ */
+struct BoundingBox
+{
+    std::array<double, 3> lower;
+    std::array<double, 3> upper;
+
+    //! Whether the box has a positive size along each axis
+    explicit operator bool() const
+    {
+        return upper[0] > lower[0] && upper[1] > lower[1]
+               && upper[2] > lower[2];
+    }
+};
+
+//---------------------------------------------------------------------------//
+// Free functions
+//---------------------------------------------------------------------------//
+
+// Bounding box of the top volume of the loaded geometry
+BoundingBox geometry_bbox();
+
+// Parse a box from "xmin,ymin,zmin,xmax,ymax,zmax" [cm]
+BoundingBox parse_bbox(std::string const& box);
@@ -0,0 +1,275 @@
+//----------------------------------*-C++-*----------------------------------//
+// Copyright 2023 UT-Battelle, LLC, and other Celeritas developers.
+// See the top-level COPYRIGHT file for details.
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+//---------------------------------------------------------------------------//
+//! \file src/EnergyDepositMap.cc
+//---------------------------------------------------------------------------//
+#include "EnergyDepositMap.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <TEveBoxSet.h>
+#include <TEveManager.h>
+#include <TEveRGBAPalette.h>
+#include <TEveRGBAPaletteOverlay.h>
+#include <TGLViewer.h>
+#include <assert.h>
+#include <stdlib.h>
+
+#include "MCTruthViewerInterface.hh"
+#include "ParallelFor.hh"
+#include "Profiler.hh"
+
+namespace
+{
+//---------------------------------------------------------------------------//
+// Parse a comma-separated list of numbers
+std::vector<double> parse_list(std::string const& list)
+{
+    std::vector<double> result;
+    std::stringstream ss(list);
+    for (std::string value; std::getline(ss, value, ',');)
+    {
+        result.push_back(std::stod(value));
+    }
+    return result;
+}
+
+//---------------------------------------------------------------------------//
+}  // namespace
+
+//---------------------------------------------------------------------------//
+/*!
+ * Construct with the binned region [cm] and number of voxels along each axis.
+ */
+EnergyDepositMap::EnergyDepositMap(BoundingBox const& box, Dims const& dims)
+    : box_(box), dims_(dims)
+{
+    for (int i = 0; i < 3; i++)
+    {
+        if (dims_[i] == 0 || !box_)
+        {
+            std::cout << "[ERROR] Energy deposition grid must have a positive "
+                         "size along each axis"
+                      << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        inv_width_[i] = dims_[i] / (box_.upper[i] - box_.lower[i]);
+    }
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Bin the energy deposits of all selected events.
+ *
+ * Events are decoded and binned on the viewer's worker threads. Each thread
+ * allocates its grid when it bins its first event, and the grids are summed
+ * in parallel, one range of voxels per thread.
+ */
+void EnergyDepositMap::fill(MCTruthViewerInterface& viewer)
+{
+    ScopedTimer timer("Energy deposition map");
+    auto const start = std::chrono::steady_clock::now();
+
+    viewer.set_decode_energy_deposition(true);
+    std::vector<Tally> tallies(viewer.num_threads());
+    viewer.scan_events([this, &tallies](EventData const& event,
+                                        unsigned int thread_id) {
+        auto& tally = tallies[thread_id];
+        if (tally.energy.empty())
+        {
+            tally.energy.assign(this->size(), 0);
+        }
+        this->add(event, &tally);
+    });
+
+    // Sum per-thread grids
+    std::vector<std::vector<double>> grids;
+    for (auto& tally : tallies)
+    {
+        outside_energy_ += tally.outside_energy;
+        num_steps_ += tally.num_steps;
+        grids.push_back(std::move(tally.energy));
+    }
+    energy_ = parallel_sum(grids, this->size(), viewer.num_threads());
+    inside_energy_ = 0;
+    for (auto e : energy_)
+    {
+        inside_energy_ += e;
+    }
+
+    std::chrono::duration<double> const time
+        = std::chrono::steady_clock::now() - start;
+    std::cout << "Energy deposition map: " << num_steps_ << " steps, "
+              << inside_energy_ << " MeV in " << dims_[0] << "x" << dims_[1]
+              << "x" << dims_[2] << " voxels, " << outside_energy_
+              << " MeV outside, in " << time.count() << " s" << std::endl;
+    if (num_steps_ == 0)
+    {
+        std::cout << "[WARNING] No energy deposition found in the input"
+                  << std::endl;
+    }
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Add the non-empty voxels to Eve as a single box set.
+ *
+ * Voxel values are stored in keV and colored with a palette spanning the
+ * smallest and largest non-empty voxels; its limits can be changed in the
+ * element editor. The palette is shown as an overlay of the main viewer.
+ */
+void EnergyDepositMap::draw() const
+{
+    int min_value = std::numeric_limits<int>::max();
+    int max_value = 0;
+    auto to_digit = [](double energy) {
+        double const kev = std::round(1e3 * energy);
+        return static_cast<int>(
+            std::min<double>(kev, std::numeric_limits<int>::max()));
+    };
+
+    auto* boxes = new TEveBoxSet("Energy deposition",
+                                 "Energy deposition per voxel [keV]");
+    boxes->Reset(TEveBoxSet::kBT_AABoxFixedDim, kFALSE, 4096);
+    boxes->SetDefWidth(1 / inv_width_[0]);
+    boxes->SetDefHeight(1 / inv_width_[1]);
+    boxes->SetDefDepth(1 / inv_width_[2]);
+
+    std::size_t index = 0;
+    for (unsigned int k = 0; k < dims_[2]; k++)
+    {
+        for (unsigned int j = 0; j < dims_[1]; j++)
+        {
+            for (unsigned int i = 0; i < dims_[0]; i++, index++)
+            {
+                int const value = to_digit(energy_[index]);
+                if (value <= 0)
+                {
+                    continue;
+                }
+                boxes->AddBox(box_.lower[0] + i / inv_width_[0],
+                              box_.lower[1] + j / inv_width_[1],
+                              box_.lower[2] + k / inv_width_[2]);
+                boxes->DigitValue(value);
+                min_value = std::min(min_value, value);
+                max_value = std::max(max_value, value);
+            }
+        }
+    }
+    boxes->RefitPlex();
+    Profiler::add(Profiler::Counter::elements_added, 1);
+
+    if (max_value == 0)
+    {
+        // Empty map: keep a valid palette range
+        min_value = 0;
+        max_value = 1;
+    }
+    auto* palette = new TEveRGBAPalette(min_value, max_value);
+    boxes->SetPalette(palette);
+    gEve->AddElement(boxes);
+
+    auto* overlay = new TEveRGBAPaletteOverlay(palette, 0.55, 0.1, 0.4, 0.05);
+    gEve->GetDefaultGLViewer()->AddOverlayElement(overlay);
+}
+
+//---------------------------------------------------------------------------//
+// PRIVATE
+//---------------------------------------------------------------------------//
+
+//---------------------------------------------------------------------------//
+/*!
+ * Number of voxels.
+ */
+std::size_t EnergyDepositMap::size() const
+{
+    return std::size_t(dims_[0]) * dims_[1] * dims_[2];
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Add the steps of an event to a thread's tally.
+ *
+ * The first point of each track is its vertex, so steps are the segments
+ * between consecutive points of a track.
+ */
+void EnergyDepositMap::add(EventData const& event, Tally* tally) const
+{
+    auto const& deposits = event.energy_deposits;
+    if (deposits.empty())
+    {
+        return;
+    }
+    assert(deposits.size() == event.points.size());
+
+    for (std::size_t t = 0; t < event.num_tracks(); t++)
+    {
+        for (auto p = event.offsets[t] + 1; p < event.offsets[t + 1]; p++)
+        {
+            double const energy = deposits[p];
+            if (!(energy > 0))
+            {
+                continue;
+            }
+            ++tally->num_steps;
+
+            auto const& pre = event.points[p - 1];
+            auto const& post = event.points[p];
+            std::size_t index = 0;
+            std::size_t stride = 1;
+            bool inside = true;
+            for (int i = 0; i < 3 && inside; i++)
+            {
+                double const mid = (double(pre[i]) + double(post[i])) / 2;
+                double const bin = std::floor((mid - box_.lower[i])
+                                              * inv_width_[i]);
+                inside = bin >= 0 && bin < dims_[i];
+                index += stride * static_cast<std::size_t>(inside ? bin : 0);
+                stride *= dims_[i];
+            }
+
+            if (inside)
+            {
+                tally->energy[index] += energy;
+            }
+            else
+            {
+                tally->outside_energy += energy;
+            }
+        }
+    }
+}
+
+//---------------------------------------------------------------------------//
+// FREE FUNCTIONS
+//---------------------------------------------------------------------------//
+
+//---------------------------------------------------------------------------//
+/*!
+ * Parse grid dimensions from \c n (cubic grid) or \c nx,ny,nz .
+ */
+EnergyDepositMap::Dims parse_grid_dims(std::string const& dims)
+{
+    auto const values = parse_list(dims);
+    if ((values.size() != 1 && values.size() != 3)
+        || *std::min_element(values.begin(), values.end()) < 1)
+    {
+        std::cout << "[ERROR] Invalid grid size " << dims
+                  << ". Expected n or nx,ny,nz" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    EnergyDepositMap::Dims result;
+    for (int i = 0; i < 3; i++)
+    {
+        result[i] = static_cast<unsigned int>(
+            values.size() == 1 ? values[0] : values[i]);
+    }
+    return result;
+}
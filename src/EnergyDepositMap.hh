@@ -0,0 +1,97 @@
+//----------------------------------*-C++-*----------------------------------//
+// Copyright 2023 UT-Battelle, LLC, and other Celeritas developers.
+// See the top-level COPYRIGHT file for details.
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+//---------------------------------------------------------------------------//
+//! \file src/EnergyDepositMap.hh
+//---------------------------------------------------------------------------//
+#pragma once
+
+#include <array>
+#include <string>
+#include <vector>
+
+#include "BoundingBox.hh"
+#include "EventData.hh"
+
+class MCTruthViewerInterface;
+
+//---------------------------------------------------------------------------//
+/*!
+ * Energy deposited in a regular 3D voxel grid, summed over events.
+ *
+ * The energy deposited along each step is assigned to the voxel containing
+ * the midpoint of the step; steps outside the box are only counted. Events
+ * are decoded and binned on worker threads, each filling its own grid, and
+ * grids are summed once all events are binned. Memory use is therefore
+ * bounded by the grid size times the number of threads, regardless of the
+ * number of steps.
+ *
+ * \code
+ *  EnergyDepositMap map(geometry_bbox(), {100, 100, 100});
+ *  map.fill(viewer);
+ *  map.draw();
+ * \endcode
+ */
+class EnergyDepositMap
+{
+  public:
+    //!@{
+    //! \name Type aliases
+    using Dims = std::array<unsigned int, 3>;
+    //!@}
+
+    // Construct with the binned region and number of voxels along each axis
+    EnergyDepositMap(BoundingBox const& box, Dims const& dims);
+
+    // Bin the energy deposits of all selected events on worker threads
+    void fill(MCTruthViewerInterface& viewer);
+
+    // Add the non-empty voxels to Eve as a single box set with a color scale
+    void draw() const;
+
+    //! Energy deposited in each voxel, x index varying fastest [MeV]
+    std::vector<double> const& energy() const { return energy_; }
+
+    //! Total energy deposited inside the box [MeV]
+    double inside_energy() const { return inside_energy_; }
+
+    //! Total energy deposited outside the box [MeV]
+    double outside_energy() const { return outside_energy_; }
+
+  private:
+    //// TYPES ////
+
+    //! Partial results of a single thread
+    struct Tally
+    {
+        std::vector<double> energy;
+        double outside_energy{0};
+        std::size_t num_steps{0};
+    };
+
+    //// DATA ////
+
+    BoundingBox box_;
+    Dims dims_;
+    std::array<double, 3> inv_width_;  //!< Voxels per cm along each axis
+    std::vector<double> energy_;
+    double inside_energy_{0};
+    double outside_energy_{0};
+    std::size_t num_steps_{0};
+
+    //// HELPER FUNCTIONS ////
+
+    // Number of voxels
+    std::size_t size() const;
+
+    // Add the steps of an event to a thread's tally
+    void add(EventData const& event, Tally* tally) const;
+};
+
+//---------------------------------------------------------------------------//
+// Free functions
+//---------------------------------------------------------------------------//
+
+// Parse grid dimensions from "n" or "nx,ny,nz"
+EnergyDepositMap::Dims parse_grid_dims(std::string const& dims);
@@ -0,0 +1,372 @@
+//----------------------------------*-C++-*----------------------------------//
+// Copyright 2023 UT-Battelle, LLC, and other Celeritas developers.
+// See the top-level COPYRIGHT file for details.
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+//---------------------------------------------------------------------------//
+//! \file src/EvdCacheFile.cc
+//---------------------------------------------------------------------------//
+#include "EvdCacheFile.hh"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <type_traits>
+#include <RZip.h>
+#include <assert.h>
+#include <stdlib.h>
+
+namespace
+{
+//---------------------------------------------------------------------------//
+// LZ4 level: blocks are written once and decompressed many times
+int const compression_level = 4;
+
+//---------------------------------------------------------------------------//
+}  // namespace
+
+//---------------------------------------------------------------------------//
+// EVDCACHEFILE
+//---------------------------------------------------------------------------//
+
+//---------------------------------------------------------------------------//
+/*!
+ * Whether a file starts with the event file magic string.
+ */
+bool EvdCacheFile::is_cache_file(std::string const& filename)
+{
+    std::ifstream in(filename, std::ios::binary);
+    char magic[sizeof(EvdCacheFormat::magic)];
+    in.read(magic, sizeof(magic));
+    return in && std::memcmp(magic, EvdCacheFormat::magic, sizeof(magic)) == 0;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Open a file and read its header and event index.
+ */
+EvdCacheFile::EvdCacheFile(std::string filename)
+    : filename_(std::move(filename)), in_(filename_, std::ios::binary)
+{
+    EvdCacheFormat::Header header;
+    in_.read(reinterpret_cast<char*>(&header), sizeof(header));
+    auto const& magic = EvdCacheFormat::magic;
+    if (!in_ || std::memcmp(header.magic, magic, sizeof(magic)) != 0)
+    {
+        std::cout << "[ERROR] " << filename_ << " is not an evd event file"
+                  << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    if (header.byte_order != EvdCacheFormat::byte_order)
+    {
+        std::cout << "[ERROR] " << filename_
+                  << " was written with a different byte order" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    flags_ = header.flags;
+
+    auto index = std::make_shared<std::vector<EventRecord>>(header.num_events);
+    in_.seekg(header.index_offset);
+    in_.read(reinterpret_cast<char*>(index->data()),
+             index->size() * sizeof(EventRecord));
+    if (!in_)
+    {
+        std::cout << "[ERROR] Event index of " << filename_ << " is truncated"
+                  << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    index_ = std::move(index);
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Open the same file again, sharing the event index.
+ */
+EvdCacheFile EvdCacheFile::reopen() const
+{
+    return EvdCacheFile(filename_, flags_, index_);
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Find event by id; null if not present.
+ */
+auto EvdCacheFile::find(int event_id) const -> EventRecord const*
+{
+    auto iter = std::lower_bound(
+        index_->begin(),
+        index_->end(),
+        event_id,
+        [](EventRecord const& e, int id) { return e.event_id < id; });
+    if (iter == index_->end() || iter->event_id != event_id)
+    {
+        return nullptr;
+    }
+    return &*iter;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Read the block of an event with a single seek and decompress it.
+ *
+ * Blocks larger than the ROOT compression buffer are stored as consecutive
+ * compressed buffers, each with its own header. Blocks that did not compress
+ * are stored as is.
+ */
+void EvdCacheFile::read(EventRecord const& event, std::vector<char>* block)
+{
+    assert(block);
+    bool const zipped = event.stored_size != event.size;
+    block->resize(event.size);
+    auto& stored = zipped ? stored_ : *block;
+    stored.resize(event.stored_size);
+
+    in_.seekg(event.offset);
+    in_.read(stored.data(), stored.size());
+    if (!in_)
+    {
+        std::cout << "[ERROR] Could not read event " << event.event_id
+                  << " from " << filename_ << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    if (!zipped)
+    {
+        return;
+    }
+
+    auto* src = reinterpret_cast<unsigned char*>(stored.data());
+    auto* tgt = reinterpret_cast<unsigned char*>(block->data());
+    std::uint64_t src_pos = 0;
+    std::uint64_t tgt_pos = 0;
+    bool valid = true;
+    while (valid && src_pos < event.stored_size)
+    {
+        int src_size = 0;
+        int tgt_size = 0;
+        int num_unzipped = 0;
+        valid = src_pos + 9 <= event.stored_size
+                && R__unzip_header(&src_size, src + src_pos, &tgt_size) == 0
+                && src_pos + src_size <= event.stored_size
+                && tgt_pos + tgt_size <= event.size;
+        if (valid)
+        {
+            R__unzip(&src_size,
+                     src + src_pos,
+                     &tgt_size,
+                     tgt + tgt_pos,
+                     &num_unzipped);
+            valid = (num_unzipped == tgt_size);
+        }
+        src_pos += src_size;
+        tgt_pos += tgt_size;
+    }
+    if (!valid || tgt_pos != event.size)
+    {
+        std::cout << "[ERROR] Event " << event.event_id << " of " << filename_
+                  << " is corrupted" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Open the file stream only, sharing an existing index.
+ */
+EvdCacheFile::EvdCacheFile(std::string filename,
+                           std::uint32_t flags,
+                           SPConstIndex index)
+    : filename_(std::move(filename))
+    , in_(filename_, std::ios::binary)
+    , flags_(flags)
+    , index_(std::move(index))
+{
+    if (!in_)
+    {
+        std::cout << "[ERROR] Could not open " << filename_ << std::endl;
+        exit(EXIT_FAILURE);
+    }
+}
+
+//---------------------------------------------------------------------------//
+// EVDCACHEWRITER
+//---------------------------------------------------------------------------//
+
+//---------------------------------------------------------------------------//
+/*!
+ * Create the output file, storing the per-point data selected by a
+ * combination of \c EvdCacheFormat::Flag values.
+ *
+ * The header is only filled in by \c close , so that an incomplete file is
+ * never mistaken for an event file.
+ */
+EvdCacheWriter::EvdCacheWriter(std::string const& filename,
+                               std::uint32_t flags)
+    : filename_(filename)
+    , out_(filename, std::ios::binary | std::ios::trunc)
+    , flags_(flags)
+{
+    if (!out_)
+    {
+        std::cout << "[ERROR] Could not create " << filename_ << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    EvdCacheFormat::Header header{};
+    out_.write(reinterpret_cast<char const*>(&header), sizeof(header));
+    offset_ = sizeof(header);
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Write the index if the file was not closed.
+ */
+EvdCacheWriter::~EvdCacheWriter()
+{
+    if (out_.is_open())
+    {
+        this->close();
+    }
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Append a decoded event.
+ *
+ * Events without parent ids are written with a parent id of -1, and events
+ * without other track attributes with a zero energy and length; events
+ * without interaction flags have none set. Energy deposits and global times
+ * are only written if selected by the flags, as zeros for events without
+ * them.
+ */
+void EvdCacheWriter::write(EventData const& event)
+{
+    using TrackRecord = EvdCacheFormat::TrackRecord;
+    assert(index_.empty() || index_.back().event_id < event.id);
+
+    auto const num_tracks = event.num_tracks();
+    auto const num_points = event.points.size();
+    bool const parents = !event.parent_ids.empty();
+    bool const attributes = !event.vertex_energies.empty();
+    bool const deposits = flags_ & EvdCacheFormat::energy_deposition;
+    bool const times = flags_ & EvdCacheFormat::times;
+
+    // Fill the decompressed block
+    block_.resize(num_tracks * sizeof(TrackRecord)
+                  + num_points
+                        * (3 * sizeof(float) + 1
+                           + (deposits + times) * sizeof(float)));
+    char* pos = block_.data();
+    for (std::size_t i = 0; i < num_tracks; i++)
+    {
+        TrackRecord track;
+        track.track_id = event.track_ids[i];
+        track.pdg = event.pdgs[i];
+        track.parent_id = parents ? event.parent_ids[i] : -1;
+        track.num_points = event.offsets[i + 1] - event.offsets[i];
+        track.vertex_energy = attributes ? event.vertex_energies[i] : 0;
+        track.length = attributes ? event.lengths[i] : 0;
+        std::memcpy(pos, &track, sizeof(track));
+        pos += sizeof(track);
+    }
+    if (std::is_same<real_type, float>::value)
+    {
+        std::memcpy(pos, event.points.data(), num_points * sizeof(Point));
+        pos += num_points * sizeof(Point);
+    }
+    else
+    {
+        for (auto const& point : event.points)
+        {
+            for (auto x : point)
+            {
+                float const value = x;
+                std::memcpy(pos, &value, sizeof(value));
+                pos += sizeof(value);
+            }
+        }
+    }
+    for (std::size_t i = 0; i < num_points; i++)
+    {
+        *pos++ = event.interaction.empty() ? 0 : event.interaction[i];
+    }
+    auto write_floats = [&pos, num_points](std::vector<float> const& values) {
+        if (values.empty())
+        {
+            std::memset(pos, 0, num_points * sizeof(float));
+        }
+        else
+        {
+            std::memcpy(pos, values.data(), num_points * sizeof(float));
+        }
+        pos += num_points * sizeof(float);
+    };
+    if (deposits)
+    {
+        write_floats(event.energy_deposits);
+    }
+    if (times)
+    {
+        write_floats(event.times);
+    }
+
+    // Compress in buffers of at most the ROOT limit
+    zipped_.resize(block_.size());
+    std::size_t zipped_size = 0;
+    bool compressed = true;
+    for (std::size_t first = 0; compressed && first < block_.size();
+         first += EvdCacheFormat::max_zip_size)
+    {
+        int src_size = std::min<std::size_t>(block_.size() - first,
+                                             EvdCacheFormat::max_zip_size);
+        int tgt_size = std::min<std::size_t>(zipped_.size() - zipped_size,
+                                             src_size);
+        int num_zipped = 0;
+        R__zipMultipleAlgorithm(compression_level,
+                                &src_size,
+                                block_.data() + first,
+                                &tgt_size,
+                                zipped_.data() + zipped_size,
+                                &num_zipped,
+                                ROOT::RCompressionSetting::EAlgorithm::kLZ4);
+        compressed = num_zipped > 0;
+        zipped_size += num_zipped;
+    }
+    compressed = compressed && zipped_size < block_.size();
+
+    EvdCacheFormat::EventRecord record;
+    record.event_id = event.id;
+    record.num_tracks = num_tracks;
+    record.num_points = num_points;
+    record.offset = offset_;
+    record.stored_size = compressed ? zipped_size : block_.size();
+    record.size = block_.size();
+    out_.write(compressed ? zipped_.data() : block_.data(),
+               record.stored_size);
+    offset_ += record.stored_size;
+    index_.push_back(record);
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Write the event index after the last event, then the header.
+ */
+void EvdCacheWriter::close()
+{
+    out_.write(reinterpret_cast<char const*>(index_.data()),
+               index_.size() * sizeof(EvdCacheFormat::EventRecord));
+
+    EvdCacheFormat::Header header{};
+    std::memcpy(header.magic, EvdCacheFormat::magic, sizeof(header.magic));
+    header.byte_order = EvdCacheFormat::byte_order;
+    header.flags = flags_;
+    header.num_events = index_.size();
+    header.index_offset = offset_;
+    out_.seekp(0);
+    out_.write(reinterpret_cast<char const*>(&header), sizeof(header));
+    offset_ += index_.size() * sizeof(EvdCacheFormat::EventRecord);
+
+    out_.close();
+    if (!out_)
+    {
+        std::cout << "[ERROR] Could not write " << filename_ << std::endl;
+        exit(EXIT_FAILURE);
+    }
+}
@@ -0,0 +1,184 @@
+//----------------------------------*-C++-*----------------------------------//
+// Copyright 2023 UT-Battelle, LLC, and other Celeritas developers.
+// See the top-level COPYRIGHT file for details.
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+//---------------------------------------------------------------------------//
+//! \file src/EvdCacheFile.hh
+//! \brief Display-optimized event file written by \c evd-convert .
+//---------------------------------------------------------------------------//
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "EventData.hh"
+
+//---------------------------------------------------------------------------//
+/*!
+ * Event file layout shared by \c EvdCacheFile and \c EvdCacheWriter .
+ *
+ * The file starts with a fixed-size header, followed by one block per event
+ * in increasing event id order, and ends with the event index. Each event
+ * block is compressed as a whole with LZ4 and holds, once decompressed:
+ * - one \c TrackRecord per track;
+ * - single precision positions [cm] of all track points, track after track;
+ * - one interaction flag byte per point;
+ * - if the \c energy_deposition flag of the header is set, one single
+ *   precision energy deposit [MeV] per point;
+ * - if the \c times flag of the header is set, one single precision global
+ *   time [ns] per point.
+ *
+ * Loading any event takes a single read of its block and a single
+ * decompression. Data are stored in the byte order of the machine that wrote
+ * the file, which is checked when it is opened.
+ */
+struct EvdCacheFormat
+{
+    //! Magic string, including format version
+    static constexpr char magic[8] = {'E', 'V', 'D', 'C', 'A', 'C', '0', '1'};
+
+    //! Written as is to detect a byte order mismatch
+    static constexpr std::uint32_t byte_order = 0x01020304;
+
+    //! Optional per-point data present in the event blocks, as header flags
+    enum Flag : std::uint32_t
+    {
+        energy_deposition = 1u << 0,
+        times = 1u << 1
+    };
+
+    //! Fixed-size header at the start of the file
+    struct Header
+    {
+        char magic[8];
+        std::uint32_t byte_order;
+        std::uint32_t flags;  //!< Combination of \c Flag values
+        std::uint64_t num_events;
+        std::uint64_t index_offset;  //!< Start of the event index [bytes]
+    };
+
+    //! Location and size of a single event block
+    struct EventRecord
+    {
+        std::int32_t event_id;
+        std::uint32_t num_tracks;
+        std::uint64_t num_points;
+        std::uint64_t offset;  //!< Start of the block [bytes]
+        std::uint64_t stored_size;  //!< Size in the file [bytes]
+        std::uint64_t size;  //!< Decompressed size [bytes]
+    };
+
+    //! Track-level data at the start of each event block
+    struct TrackRecord
+    {
+        std::int32_t track_id;
+        std::int32_t pdg;
+        std::int32_t parent_id;  //!< Negative for primaries
+        std::uint32_t num_points;
+        float vertex_energy;  //!< [MeV]
+        float length;  //!< [cm]
+    };
+
+    //! Largest buffer compressed at once by ROOT [bytes]
+    static constexpr int max_zip_size = 0xffffff;
+};
+
+//---------------------------------------------------------------------------//
+/*!
+ * Read-only access to an event file written by \c evd-convert .
+ *
+ * The header and event index are read when the file is opened. Copies made
+ * with \c reopen share the index and use their own file stream, so that
+ * events can be read concurrently.
+ */
+class EvdCacheFile
+{
+  public:
+    //!@{
+    //! \name Type aliases
+    using EventRecord = EvdCacheFormat::EventRecord;
+    using TrackRecord = EvdCacheFormat::TrackRecord;
+    using SPConstIndex = std::shared_ptr<std::vector<EventRecord> const>;
+    //!@}
+
+    // Whether a file starts with the event file magic string
+    static bool is_cache_file(std::string const& filename);
+
+    // Open a file and read its event index
+    explicit EvdCacheFile(std::string filename);
+
+    // Open the same file again with its own stream
+    EvdCacheFile reopen() const;
+
+    //! Events sorted by event id
+    std::vector<EventRecord> const& events() const { return *index_; }
+
+    // Find event by id; null if not present
+    EventRecord const* find(int event_id) const;
+
+    // Read and decompress the block of an event
+    void read(EventRecord const& event, std::vector<char>* block);
+
+    //! File name
+    std::string const& filename() const { return filename_; }
+
+    //! Whether event blocks hold per-point energy deposits
+    bool has_energy_deposition() const
+    {
+        return flags_ & EvdCacheFormat::energy_deposition;
+    }
+
+    //! Whether event blocks hold per-point global times
+    bool has_times() const { return flags_ & EvdCacheFormat::times; }
+
+  private:
+    std::string filename_;
+    std::ifstream in_;
+    std::uint32_t flags_{0};
+    SPConstIndex index_;
+    std::vector<char> stored_;
+
+    // Open the file stream only
+    EvdCacheFile(std::string filename,
+                 std::uint32_t flags,
+                 SPConstIndex index);
+};
+
+//---------------------------------------------------------------------------//
+/*!
+ * Write decoded events to a display-optimized event file.
+ *
+ * Events must be written in increasing event id order and should carry track
+ * attributes and interaction flags, and the per-point data selected by the
+ * header flags. The index is written by \c close .
+ */
+class EvdCacheWriter
+{
+  public:
+    // Create the output file, storing the given per-point data
+    EvdCacheWriter(std::string const& filename, std::uint32_t flags);
+
+    // Write the index if the file was not closed
+    ~EvdCacheWriter();
+
+    // Append a decoded event
+    void write(EventData const& event);
+
+    // Write the event index and close the file
+    void close();
+
+    //! Number of bytes written so far
+    std::uint64_t num_bytes() const { return offset_; }
+
+  private:
+    std::string filename_;
+    std::ofstream out_;
+    std::uint32_t flags_;  //!< Combination of \c EvdCacheFormat::Flag values
+    std::uint64_t offset_{0};
+    std::vector<EvdCacheFormat::EventRecord> index_;
+    std::vector<char> block_;
+    std::vector<char> zipped_;
+};
@@ -0,0 +1,264 @@
+//----------------------------------*-C++-*----------------------------------//
+// Copyright 2023 UT-Battelle, LLC, and other Celeritas developers.
+// See the top-level COPYRIGHT file for details.
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+//---------------------------------------------------------------------------//
+//! \file src/EvdCacheViewer.cc
+//---------------------------------------------------------------------------//
+#include "EvdCacheViewer.hh"
+
+#include <cstring>
+#include <type_traits>
+#include <assert.h>
+
+#include "Profiler.hh"
+
+//---------------------------------------------------------------------------//
+/*!
+ * Decode single events from an event file.
+ */
+class EvdCacheViewer::Reader final : public MCTruthViewerInterface::EventReader
+{
+  public:
+    // Construct with an open file and the viewer options to apply
+    Reader(EvdCacheFile file, EvdCacheViewer const& viewer);
+
+    // Decode all selected tracks of an event
+    EventData operator()(int event_id) final;
+
+    //! Access the event file
+    EvdCacheFile const& file() const { return file_; }
+
+  private:
+    EvdCacheFile file_;
+    EvdCacheViewer const& viewer_;
+    std::vector<char> block_;
+};
+
+//---------------------------------------------------------------------------//
+/*!
+ * Construct with input filename.
+ */
+EvdCacheViewer::EvdCacheViewer(std::string filename)
+{
+    reader_ = std::make_unique<Reader>(EvdCacheFile(std::move(filename)),
+                                       *this);
+}
+
+//---------------------------------------------------------------------------//
+//! Default destructor
+EvdCacheViewer::~EvdCacheViewer() = default;
+
+//---------------------------------------------------------------------------//
+/*!
+ * Whether event blocks hold per-point energy deposits, i.e. whether the
+ * converted input had them.
+ */
+bool EvdCacheViewer::has_energy_deposition() const
+{
+    return reader_->file().has_energy_deposition();
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Whether event blocks hold per-point global times.
+ */
+bool EvdCacheViewer::has_times() const
+{
+    return reader_->file().has_times();
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Sorted list of event ids in the file index.
+ */
+std::vector<int> EvdCacheViewer::event_ids()
+{
+    auto const& events = reader_->file().events();
+    std::vector<int> result;
+    result.reserve(events.size());
+    for (auto const& event : events)
+    {
+        result.push_back(event.event_id);
+    }
+    return result;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Reader using the input file handle.
+ */
+auto EvdCacheViewer::reader() -> EventReader&
+{
+    return *reader_;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Open the input file again, sharing its index, and create a new reader.
+ */
+auto EvdCacheViewer::make_reader() const -> std::unique_ptr<EventReader>
+{
+    return std::make_unique<Reader>(reader_->file().reopen(), *this);
+}
+
+//---------------------------------------------------------------------------//
+// READER
+//---------------------------------------------------------------------------//
+
+//---------------------------------------------------------------------------//
+/*!
+ * Construct with an open file and the viewer options to apply.
+ */
+EvdCacheViewer::Reader::Reader(EvdCacheFile file,
+                               EvdCacheViewer const& viewer)
+    : file_(std::move(file)), viewer_(viewer)
+{
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Read the block of an event and copy its selected tracks.
+ *
+ * Points of consecutive tracks are contiguous in the block, so the points of
+ * each selected track are copied at once.
+ */
+EventData EvdCacheViewer::Reader::operator()(int event_id)
+{
+    using TrackRecord = EvdCacheFile::TrackRecord;
+
+    auto const* record = file_.find(event_id);
+    assert(record);
+    {
+        ScopedTimer timer("Event block read");
+        file_.read(*record, &block_);
+    }
+    Profiler::add(Profiler::Counter::bytes_read, block_.size());
+    Profiler::add(Profiler::Counter::entries_decoded, 1);
+
+    auto const num_tracks = record->num_tracks;
+    auto const num_points = record->num_points;
+    char const* tracks = block_.data();
+    char const* points = tracks + num_tracks * sizeof(TrackRecord);
+    char const* interaction = points + num_points * 3 * sizeof(float);
+    char const* deposits = interaction + num_points;
+    char const* times
+        = deposits
+          + (file_.has_energy_deposition() ? num_points * sizeof(float) : 0);
+    assert(times + (file_.has_times() ? num_points * sizeof(float) : 0)
+           == block_.data() + block_.size());
+
+    auto const& filter = viewer_.filter();
+    bool const interactions = viewer_.needs_interactions();
+    bool const attributes = viewer_.needs_attributes();
+    bool const parents = viewer_.needs_parents();
+    bool const energy_deposition = viewer_.needs_energy_deposition();
+    bool const needs_times = viewer_.needs_times();
+
+    // Select tracks before copying anything
+    std::vector<TrackRecord> selected;
+    std::vector<std::size_t> first_point;
+    std::size_t num_selected_points = 0;
+    std::size_t first = 0;
+    for (std::size_t i = 0; i < num_tracks; i++)
+    {
+        TrackRecord track;
+        std::memcpy(&track, tracks + i * sizeof(TrackRecord), sizeof(track));
+        if (filter.pass_track(track.pdg,
+                              track.vertex_energy,
+                              track.length,
+                              track.parent_id < 0))
+        {
+            selected.push_back(track);
+            first_point.push_back(first);
+            num_selected_points += track.num_points;
+        }
+        first += track.num_points;
+    }
+    assert(first == num_points);
+
+    EventData result;
+    result.id = event_id;
+    result.reserve(selected.size(), num_selected_points);
+    if (interactions)
+    {
+        result.interaction.reserve(num_selected_points);
+    }
+    if (energy_deposition)
+    {
+        result.energy_deposits.reserve(num_selected_points);
+    }
+    if (needs_times)
+    {
+        result.times.reserve(num_selected_points);
+    }
+
+    for (std::size_t i = 0; i < selected.size(); i++)
+    {
+        auto const& track = selected[i];
+        result.add_track(track.track_id, track.pdg);
+        if (attributes)
+        {
+            result.add_attributes(
+                track.parent_id, track.vertex_energy, track.length);
+        }
+        else if (parents)
+        {
+            result.add_parent(track.parent_id);
+        }
+
+        char const* src = points + first_point[i] * 3 * sizeof(float);
+        auto const n = track.num_points;
+        if (std::is_same<real_type, float>::value)
+        {
+            auto const size = result.points.size();
+            result.points.resize(size + n);
+            std::memcpy(result.points.data() + size, src, n * sizeof(Point));
+            result.offsets.back() += n;
+        }
+        else
+        {
+            for (std::size_t j = 0; j < n; j++)
+            {
+                float pos[3];
+                std::memcpy(pos, src + j * sizeof(pos), sizeof(pos));
+                result.add_point(pos[0], pos[1], pos[2]);
+            }
+        }
+
+        if (interactions)
+        {
+            char const* flags = interaction + first_point[i];
+            result.interaction.insert(
+                result.interaction.end(), flags, flags + n);
+        }
+
+        if (energy_deposition)
+        {
+            // Files written before deposits were stored have none
+            auto& energy_deposits = result.energy_deposits;
+            auto const size = energy_deposits.size();
+            energy_deposits.resize(size + n, 0);
+            if (file_.has_energy_deposition())
+            {
+                std::memcpy(energy_deposits.data() + size,
+                            deposits + first_point[i] * sizeof(float),
+                            n * sizeof(float));
+            }
+        }
+
+        if (needs_times)
+        {
+            // Files written before times were stored have none
+            auto const size = result.times.size();
+            result.times.resize(size + n, 0);
+            if (file_.has_times())
+            {
+                std::memcpy(result.times.data() + size,
+                            times + first_point[i] * sizeof(float),
+                            n * sizeof(float));
+            }
+        }
+    }
+    return result;
+}
@@ -0,0 +1,59 @@
+//----------------------------------*-C++-*----------------------------------//
+// Copyright 2023 UT-Battelle, LLC, and other Celeritas developers.
+// See the top-level COPYRIGHT file for details.
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+//---------------------------------------------------------------------------//
+//! \file src/EvdCacheViewer.hh
+//---------------------------------------------------------------------------//
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "EvdCacheFile.hh"
+#include "MCTruthViewerInterface.hh"
+
+//---------------------------------------------------------------------------//
+/*!
+ * Draw event MC truth data from files written by \c evd-convert .
+ *
+ * The event index is read when the file is opened, and each event is loaded
+ * with a single read and decompression of its block. Track selection uses
+ * the track records at the start of the block, so only the points of
+ * selected tracks are copied.
+ *
+ * This is a secondary class meant to be used along with \c MainViewer , which
+ * *MUST* be initialized before this class is constructed.
+ */
+class EvdCacheViewer final : public MCTruthViewerInterface
+{
+  public:
+    // Construct with input filename
+    explicit EvdCacheViewer(std::string filename);
+
+    // Default destructor
+    ~EvdCacheViewer();
+
+    // Whether event blocks hold per-point energy deposits
+    bool has_energy_deposition() const final;
+
+    // Whether event blocks hold per-point global times
+    bool has_times() const final;
+
+  protected:
+    // Sorted list of event ids available in the input
+    std::vector<int> event_ids() override;
+
+    // Reader using the input file handle
+    EventReader& reader() override;
+
+    // Create a reader with its own file handle
+    std::unique_ptr<EventReader> make_reader() const override;
+
+  private:
+    class Reader;
+
+    //// DATA ////
+
+    std::unique_ptr<Reader> reader_;
+};
@@ -0,0 +1,16 @@
+//----------------------------------*-C++-*----------------------------------//
+// Copyright 2023 UT-Battelle, LLC, and other Celeritas developers.
+// See the top-level COPYRIGHT file for details.
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+//---------------------------------------------------------------------------//
+//! \file EveInterfaceLinkDef.hh
+//! \brief Eve classes added to the ROOT dictionary.
+//---------------------------------------------------------------------------//
+#ifdef __CINT__
+
+// clang-format off
+#pragma link C++ class TrackSegmentSet+;
+#pragma link C++ class TrackSegmentSetGL+;
+// clang-format on
+
+#endif
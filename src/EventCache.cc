@@ -0,0 +1,112 @@
+//----------------------------------*-C++-*----------------------------------//
+// Copyright 2023 UT-Battelle, LLC, and other Celeritas developers.
+// See the top-level COPYRIGHT file for details.
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+//---------------------------------------------------------------------------//
+//! \file src/EventCache.cc
+//---------------------------------------------------------------------------//
+#include "EventCache.hh"
+
+#include <assert.h>
+
+//---------------------------------------------------------------------------//
+/*!
+ * Construct with memory limit [bytes].
+ */
+EventCache::EventCache(std::size_t max_bytes) : max_bytes_(max_bytes) {}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Find an event and mark it as most recently used; null if not cached.
+ */
+auto EventCache::find(int event_id) -> SPConstEvent
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto iter = index_.find(event_id);
+    if (iter == index_.end())
+    {
+        return nullptr;
+    }
+    entries_.splice(entries_.begin(), entries_, iter->second);
+    return iter->second->event;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Whether an event is cached, without changing its use order.
+ */
+bool EventCache::contains(int event_id) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return index_.count(event_id) > 0;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Add an event as most recently used, evicting the least recently used ones
+ * until the memory limit is met.
+ *
+ * Events larger than the memory limit are not cached.
+ */
+void EventCache::insert(int event_id, SPConstEvent event)
+{
+    assert(event);
+    auto const num_bytes = EventCache::memory_size(*event);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (num_bytes > max_bytes_ || index_.count(event_id))
+    {
+        return;
+    }
+
+    while (num_bytes_ + num_bytes > max_bytes_)
+    {
+        assert(!entries_.empty());
+        num_bytes_ -= entries_.back().num_bytes;
+        index_.erase(entries_.back().event_id);
+        entries_.pop_back();
+    }
+
+    entries_.push_front({event_id, std::move(event), num_bytes});
+    index_[event_id] = entries_.begin();
+    num_bytes_ += num_bytes;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Estimated memory used by cached events [bytes].
+ */
+std::size_t EventCache::num_bytes() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return num_bytes_;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Number of cached events.
+ */
+std::size_t EventCache::size() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entries_.size();
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Estimate memory used by a decoded event [bytes].
+ */
+std::size_t EventCache::memory_size(EventData const& event)
+{
+    return sizeof(EventData) + event.track_ids.capacity() * sizeof(int)
+           + event.pdgs.capacity() * sizeof(int)
+           + event.offsets.capacity() * sizeof(event.offsets[0])
+           + event.parent_ids.capacity() * sizeof(int)
+           + (event.vertex_energies.capacity() + event.lengths.capacity())
+                 * sizeof(float)
+           + event.points.capacity() * sizeof(Point)
+           + event.interaction.capacity() / 8
+           + event.energy_deposits.capacity() * sizeof(float)
+           + event.times.capacity() * sizeof(float)
+           + event.significance.capacity() * sizeof(float);
+}
@@ -0,0 +1,72 @@
+//----------------------------------*-C++-*----------------------------------//
+// Copyright 2023 UT-Battelle, LLC, and other Celeritas developers.
+// See the top-level COPYRIGHT file for details.
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+//---------------------------------------------------------------------------//
+//! \file src/EventCache.hh
+//---------------------------------------------------------------------------//
+#pragma once
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "EventData.hh"
+
+//---------------------------------------------------------------------------//
+/*!
+ * Least-recently-used cache of decoded events with a memory limit.
+ *
+ * Events are shared with the caller, so an event evicted from the cache stays
+ * valid while it is in use. The memory of an event is estimated from the
+ * capacity of its track vectors. All functions are thread safe.
+ */
+class EventCache
+{
+  public:
+    //!@{
+    //! \name Type aliases
+    using SPConstEvent = std::shared_ptr<EventData const>;
+    //!@}
+
+    // Construct with memory limit [bytes]
+    explicit EventCache(std::size_t max_bytes);
+
+    // Find an event and mark it as most recently used; null if not cached
+    SPConstEvent find(int event_id);
+
+    // Whether an event is cached, without changing its use order
+    bool contains(int event_id) const;
+
+    // Add an event, evicting the least recently used ones if needed
+    void insert(int event_id, SPConstEvent event);
+
+    // Estimated memory used by cached events [bytes]
+    std::size_t num_bytes() const;
+
+    // Number of cached events
+    std::size_t size() const;
+
+    // Estimate memory used by a decoded event [bytes]
+    static std::size_t memory_size(EventData const& event);
+
+  private:
+    //// TYPES ////
+
+    struct Entry
+    {
+        int event_id;
+        SPConstEvent event;
+        std::size_t num_bytes;
+    };
+    using EntryList = std::list<Entry>;
+
+    //// DATA ////
+
+    std::size_t max_bytes_;
+    std::size_t num_bytes_{0};
+    EntryList entries_;  //!< Most recently used first
+    std::unordered_map<int, EntryList::iterator> index_;
+    mutable std::mutex mutex_;
+};
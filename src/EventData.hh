@@ -0,0 +1,144 @@
+//----------------------------------*-C++-*----------------------------------//
+// Copyright 2023 UT-Battelle, LLC, and other Celeritas developers.
+// See the top-level COPYRIGHT file for details.
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+//---------------------------------------------------------------------------//
+//! \file src/EventData.hh
+//! \brief Decoded event data, independent of the input file format.
+//---------------------------------------------------------------------------//
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+#include <assert.h>
+
+//---------------------------------------------------------------------------//
+// Type aliases
+
+//! Coordinate type of decoded points; Eve stores single precision as well
+#ifdef EVD_DOUBLE_POINTS
+using real_type = double;
+#else
+using real_type = float;
+#endif
+
+//! Position [cm]
+using Point = std::array<real_type, 3>;
+
+//---------------------------------------------------------------------------//
+/*!
+ * Non-owning view of a single track of an \c EventData .
+ *
+ * Track geometry is the vertex followed by the post-step position of every
+ * step, in step order. \c first is the index of the first point in the
+ * per-point arrays of the event.
+ */
+struct TrackView
+{
+    int id;
+    int pdg;
+    Point const* points;
+    std::size_t num_points;
+    std::size_t first;
+};
+
+//---------------------------------------------------------------------------//
+/*!
+ * All drawable tracks of a single event, stored as structure of arrays.
+ *
+ * Points of all tracks are stored contiguously, track after track; the
+ * points of track \c i are in [offsets[i], offsets[i + 1]). Interaction flags
+ * are optional and filled only by readers with access to the step process.
+ * Energy deposits and global times are optional as well and only decoded on
+ * request. Point significance is filled by \c TrackSimplifier . All four are
+ * either empty or have one entry per point. Track attributes (parent, vertex
+ * energy, and length) are only decoded on request, e.g. to convert the input;
+ * they are either empty or have one entry per track. Parents can be decoded
+ * without the other attributes to navigate showers.
+ *
+ * \code
+ *  EventData event;
+ *  event.add_track(track_id, pdg);
+ *  event.add_point(x, y, z);
+ * \endcode
+ */
+struct EventData
+{
+    int id;
+
+    //!@{
+    //! Per-track data
+    std::vector<int> track_ids;
+    std::vector<int> pdgs;
+    std::vector<std::uint32_t> offsets{0};
+    std::vector<int> parent_ids;  //!< Negative for primaries
+    std::vector<float> vertex_energies;  //!< [MeV]
+    std::vector<float> lengths;  //!< [cm]
+    //!@}
+
+    //!@{
+    //! Per-point data
+    std::vector<Point> points;  //!< [cm]
+    std::vector<bool> interaction;  //!< Point ends a discrete interaction
+    std::vector<float> energy_deposits;  //!< Along the step ending here [MeV]
+    std::vector<float> times;  //!< Global time [ns]
+    std::vector<float> significance;  //!< Simplification tolerance [cm]
+    //!@}
+
+    //! Number of tracks
+    std::size_t num_tracks() const { return track_ids.size(); }
+
+    //! View of a single track
+    TrackView track(std::size_t i) const
+    {
+        assert(i < this->num_tracks());
+        return {track_ids[i],
+                pdgs[i],
+                points.data() + offsets[i],
+                offsets[i + 1] - offsets[i],
+                offsets[i]};
+    }
+
+    //! Start a new track; its points are added with \c add_point
+    void add_track(int track_id, int pdg)
+    {
+        track_ids.push_back(track_id);
+        pdgs.push_back(pdg);
+        offsets.push_back(offsets.back());
+    }
+
+    //! Set the attributes of the last track
+    void add_attributes(int parent_id, double vertex_energy, double length)
+    {
+        this->add_parent(parent_id);
+        vertex_energies.push_back(static_cast<float>(vertex_energy));
+        lengths.push_back(static_cast<float>(length));
+    }
+
+    //! Set the parent of the last track only
+    void add_parent(int parent_id)
+    {
+        assert(parent_ids.size() + 1 == track_ids.size());
+        parent_ids.push_back(parent_id);
+    }
+
+    //! Add a point [cm] to the last track
+    void add_point(double x, double y, double z)
+    {
+        assert(!track_ids.empty());
+        points.push_back({static_cast<real_type>(x),
+                          static_cast<real_type>(y),
+                          static_cast<real_type>(z)});
+        ++offsets.back();
+    }
+
+    //! Reserve memory for a given number of tracks and points
+    void reserve(std::size_t num_tracks, std::size_t num_points)
+    {
+        track_ids.reserve(num_tracks);
+        pdgs.reserve(num_tracks);
+        offsets.reserve(num_tracks + 1);
+        points.reserve(num_points);
+    }
+};
@@ -0,0 +1,279 @@
+//----------------------------------*-C++-*----------------------------------//
+// Copyright 2023 UT-Battelle, LLC, and other Celeritas developers.
+// See the top-level COPYRIGHT file for details.
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+//---------------------------------------------------------------------------//
+//! \file src/EventLoader.cc
+//---------------------------------------------------------------------------//
+#include "EventLoader.hh"
+
+#include <algorithm>
+#include <assert.h>
+
+#include "ParallelFor.hh"
+
+//---------------------------------------------------------------------------//
+/*!
+ * Construct with functions that create a reader and decode an event, called
+ * from worker threads.
+ */
+EventLoader::EventLoader(MakeReader make_reader, Decode decode)
+    : make_reader_(std::move(make_reader)), decode_(std::move(decode))
+{
+    assert(make_reader_ && decode_);
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Check that no load is running.
+ */
+EventLoader::~EventLoader()
+{
+    assert(!thread_.joinable());
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Clear the queue, counters, and cancellation before a new load of
+ * \c num_events events.
+ */
+void EventLoader::reset(std::size_t num_events)
+{
+    assert(!thread_.joinable());
+    queue_.clear();
+    max_queued_ = 0;
+    finished_ = false;
+    cancel_ = false;
+    num_decoded_ = 0;
+    num_events_ = num_events;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Run a load function on a background thread.
+ *
+ * The load is finished once \c load returns and all events it pushed are
+ * taken.
+ */
+void EventLoader::start(std::size_t num_events, std::function<void()> load)
+{
+    this->reset(num_events);
+    thread_ = std::thread([this, load = std::move(load)] {
+        load();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            finished_ = true;
+        }
+        cv_.notify_all();
+    });
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Decode events in chunks and pass each chunk, in order, to \c func .
+ *
+ * Each chunk of \c 4*num_threads events is decoded in parallel by readers
+ * created lazily by the worker thread that uses them. Decoding stops early if
+ * the load is cancelled. Chunks passed to \c push are queued until at most
+ * two of them are waiting to be drawn, so that memory use stays bounded when
+ * drawing is slower than decoding.
+ *
+ * If given, \c observe is called with each decoded event and the id of the
+ * worker thread that decoded it, on that thread.
+ */
+void EventLoader::decode_chunks(std::vector<int> const& ids,
+                                unsigned int num_threads,
+                                ChunkFunc const& func,
+                                Observe const& observe)
+{
+    std::vector<std::unique_ptr<EventReader>> readers(num_threads);
+    std::size_t const chunk_size = 4 * num_threads;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        max_queued_ = 2 * chunk_size;
+    }
+
+    for (std::size_t first = 0; first < ids.size() && !cancel_;
+         first += chunk_size)
+    {
+        auto const last = std::min(first + chunk_size, ids.size());
+        std::vector<EventData> events(last - first);
+        parallel_for(events.size(),
+                     num_threads,
+                     [&](std::size_t i, unsigned int thread_id) {
+                         if (cancel_)
+                         {
+                             return;
+                         }
+                         auto& reader = readers[thread_id];
+                         if (!reader)
+                         {
+                             reader = make_reader_();
+                         }
+                         events[i] = decode_(*reader, ids[first + i]);
+                         if (observe)
+                         {
+                             observe(events[i], thread_id);
+                         }
+                         ++num_decoded_;
+                     });
+        func(std::move(events));
+    }
+    this->add_cache_stats(readers);
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Decode events on worker threads and pass them to a function along with
+ * their index in \c ids and the thread id, without queueing them.
+ */
+void EventLoader::scan(std::vector<int> const& ids,
+                       unsigned int num_threads,
+                       ScanFunc const& func)
+{
+    std::vector<std::unique_ptr<EventReader>> readers(num_threads);
+    parallel_for(ids.size(),
+                 num_threads,
+                 [&](std::size_t i, unsigned int thread_id) {
+                     auto& reader = readers[thread_id];
+                     if (!reader)
+                     {
+                         reader = make_reader_();
+                     }
+                     func(i, decode_(*reader, ids[i]), thread_id);
+                 });
+    this->add_cache_stats(readers);
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Queue decoded events for drawing.
+ *
+ * Waits until the events fit in the queue along with the ones already
+ * waiting, or the queue is empty. Nothing is queued once the load is
+ * cancelled.
+ */
+void EventLoader::push(std::vector<EventData> events)
+{
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this, &events] {
+            return queue_.empty()
+                   || queue_.size() + events.size() <= max_queued_ || cancel_;
+        });
+        if (cancel_)
+        {
+            return;
+        }
+        for (auto& event : events)
+        {
+            queue_.push_back(std::move(event));
+        }
+    }
+    cv_.notify_all();
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Wait until events are queued or the load function has returned.
+ */
+void EventLoader::wait()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [this] { return !queue_.empty() || finished_; });
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Take the next queued event. Returns false if none is queued.
+ */
+bool EventLoader::pop(EventData* event)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (queue_.empty())
+        {
+            return false;
+        }
+        *event = std::move(queue_.front());
+        queue_.pop_front();
+    }
+    cv_.notify_all();
+    return true;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Join the background thread once the load function has returned and all of
+ * its events are taken. Returns true if the thread was joined by this call.
+ */
+bool EventLoader::join_finished()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!thread_.joinable() || !finished_ || !queue_.empty())
+        {
+            return false;
+        }
+    }
+    thread_.join();
+    return true;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Stop the load and discard the events that are not taken yet. Returns false
+ * if no load was running.
+ *
+ * Worker threads finish the event they are decoding, so this returns after at
+ * most one event per thread has been read.
+ */
+bool EventLoader::cancel()
+{
+    if (!thread_.joinable())
+    {
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        cancel_ = true;
+    }
+    cv_.notify_all();
+    thread_.join();
+    queue_.clear();
+    return true;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Input statistics of the readers used so far.
+ */
+TreeCacheStats EventLoader::cache_stats() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return cache_stats_;
+}
+
+//---------------------------------------------------------------------------//
+// PRIVATE
+//---------------------------------------------------------------------------//
+
+//---------------------------------------------------------------------------//
+/*!
+ * Add the input statistics of per-thread readers.
+ */
+void EventLoader::add_cache_stats(
+    std::vector<std::unique_ptr<EventReader>> const& readers)
+{
+    TreeCacheStats cache_stats;
+    for (auto const& reader : readers)
+    {
+        if (reader)
+        {
+            cache_stats += reader->cache_stats();
+        }
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    cache_stats_ += cache_stats;
+}
@@ -0,0 +1,121 @@
+//----------------------------------*-C++-*----------------------------------//
+// Copyright 2023 UT-Battelle, LLC, and other Celeritas developers.
+// See the top-level COPYRIGHT file for details.
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+//---------------------------------------------------------------------------//
+//! \file src/EventLoader.hh
+//---------------------------------------------------------------------------//
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "MCTruthViewerInterface.hh"
+
+//---------------------------------------------------------------------------//
+/*!
+ * Decode events on worker threads and queue them for drawing.
+ *
+ * \c start runs a load function on a background thread, which decodes events,
+ * e.g. with \c decode_chunks , and passes them to \c push . The thread that
+ * owns Eve takes them from the queue with \c pop . Decoding stops early once
+ * the load is cancelled.
+ *
+ * Readers are created by the worker threads that use them, and the input
+ * statistics of their read-ahead caches are accumulated over all loads.
+ */
+class EventLoader
+{
+  public:
+    //!@{
+    //! \name Type aliases
+    using EventReader = MCTruthViewerInterface::EventReader;
+    using MakeReader = std::function<std::unique_ptr<EventReader>()>;
+    using Decode = std::function<EventData(EventReader&, int)>;
+    using ChunkFunc = std::function<void(std::vector<EventData>)>;
+    using ScanFunc
+        = std::function<void(std::size_t, EventData const&, unsigned int)>;
+    using Observe = std::function<void(EventData const&, unsigned int)>;
+    //!@}
+
+    // Construct with functions called from worker threads
+    EventLoader(MakeReader make_reader, Decode decode);
+
+    // Check that no load is running
+    ~EventLoader();
+
+    // Clear the queue, counters, and cancellation before a new load
+    void reset(std::size_t num_events);
+
+    // Run a load function on a background thread
+    void start(std::size_t num_events, std::function<void()> load);
+
+    // Decode events in chunks and pass each chunk, in order, to a function
+    void decode_chunks(std::vector<int> const& ids,
+                       unsigned int num_threads,
+                       ChunkFunc const& func,
+                       Observe const& observe = nullptr);
+
+    // Decode events and pass them to a function on worker threads
+    void scan(std::vector<int> const& ids,
+              unsigned int num_threads,
+              ScanFunc const& func);
+
+    // Queue decoded events, waiting if too many are pending
+    void push(std::vector<EventData> events);
+
+    //! Count events decoded outside of \c decode_chunks
+    void count_decoded(std::size_t num_events) { num_decoded_ += num_events; }
+
+    // Wait until events are queued or the load is finished
+    void wait();
+
+    // Take the next queued event; false if none
+    bool pop(EventData* event);
+
+    // Join the background thread once all of its events are taken
+    bool join_finished();
+
+    // Stop the load, wait for it, and discard queued events
+    bool cancel();
+
+    //! Whether the background thread is running or not joined yet
+    bool running() const { return thread_.joinable(); }
+
+    //! Events selected for loading
+    std::size_t num_events() const { return num_events_; }
+
+    //! Events decoded so far
+    std::size_t num_decoded() const { return num_decoded_; }
+
+    //! Whether the load was cancelled
+    bool cancelled() const { return cancel_; }
+
+    // Input statistics of the readers used so far
+    TreeCacheStats cache_stats() const;
+
+  private:
+    MakeReader make_reader_;
+    Decode decode_;
+
+    std::thread thread_;
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<EventData> queue_;
+    std::size_t max_queued_{0};  //!< Zero to queue a single push at a time
+    bool finished_{false};
+    std::atomic<bool> cancel_{false};
+    std::atomic<std::size_t> num_decoded_{0};
+    std::size_t num_events_{0};
+    TreeCacheStats cache_stats_;
+
+    // Add the input statistics of per-thread readers
+    void add_cache_stats(
+        std::vector<std::unique_ptr<EventReader>> const& readers);
+};
@@ -0,0 +1,188 @@
+//----------------------------------*-C++-*----------------------------------//
+// Copyright 2023 UT-Battelle, LLC, and other Celeritas developers.
+// See the top-level COPYRIGHT file for details.
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+//---------------------------------------------------------------------------//
+//! \file src/EventNavigator.cc
+//---------------------------------------------------------------------------//
+#include "EventNavigator.hh"
+
+#include <string>
+#include <TEveBrowser.h>
+#include <TEveManager.h>
+#include <TGButton.h>
+#include <TGClient.h>
+#include <TGFrame.h>
+#include <TGLabel.h>
+#include <TGLayout.h>
+#include <TGNumberEntry.h>
+#include <WidgetMessageTypes.h>
+
+//---------------------------------------------------------------------------//
+/*!
+ * Navigation buttons and event id entry, embedded in the browser.
+ */
+class EventNavigator::Frame final : public TGMainFrame
+{
+  public:
+    // Construct in the window currently being embedded
+    explicit Frame(EventNavigator* navigator);
+
+    // Show the current event id
+    void update(int event_id);
+
+    //! Stop forwarding button clicks
+    void detach() { navigator_ = nullptr; }
+
+    // Handle buttons and event id entry
+    Bool_t ProcessMessage(Longptr_t msg, Longptr_t parm1, Longptr_t) final;
+
+  private:
+    enum
+    {
+        previous_id = 1,
+        next_id,
+        show_id
+    };
+
+    EventNavigator* navigator_;
+    TGLabel* label_;
+    TGNumberEntry* entry_;
+};
+
+//---------------------------------------------------------------------------//
+/*!
+ * Construct and add the navigation frame to the browser.
+ */
+EventNavigator::EventNavigator(MCTruthViewerInterface& viewer)
+    : viewer_(viewer)
+{
+    auto* browser = gEve->GetBrowser();
+    browser->StartEmbedding(TRootBrowser::kLeft);
+    frame_ = new Frame(this);
+    browser->StopEmbedding("Events");
+    frame_->update(viewer_.current_event());
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * The frame is owned by the browser and may outlive the navigator.
+ */
+EventNavigator::~EventNavigator()
+{
+    frame_->detach();
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Show a given event.
+ */
+void EventNavigator::show_event(int event_id)
+{
+    viewer_.show_event(event_id);
+    frame_->update(viewer_.current_event());
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Show the next (positive) or previous (negative) event.
+ */
+void EventNavigator::step_event(int offset)
+{
+    viewer_.step_event(offset);
+    frame_->update(viewer_.current_event());
+}
+
+//---------------------------------------------------------------------------//
+// FRAME
+//---------------------------------------------------------------------------//
+
+//---------------------------------------------------------------------------//
+/*!
+ * Construct in the window currently being embedded.
+ */
+EventNavigator::Frame::Frame(EventNavigator* navigator)
+    : TGMainFrame(gClient->GetRoot(), 300, 100), navigator_(navigator)
+{
+    this->SetCleanup(kDeepCleanup);
+    auto* group = new TGGroupFrame(this, "Event");
+    label_ = new TGLabel(group, "No event");
+    group->AddFrame(label_, new TGLayoutHints(kLHintsExpandX, 2, 2, 4, 2));
+
+    // Previous/next buttons
+    auto* step_row = new TGHorizontalFrame(group);
+    auto* previous = new TGTextButton(step_row, "< Previous", previous_id);
+    auto* next = new TGTextButton(step_row, "Next >", next_id);
+    previous->Associate(this);
+    next->Associate(this);
+    step_row->AddFrame(previous, new TGLayoutHints(kLHintsExpandX, 0, 2));
+    step_row->AddFrame(next, new TGLayoutHints(kLHintsExpandX, 2, 0));
+    group->AddFrame(step_row, new TGLayoutHints(kLHintsExpandX, 2, 2, 2, 2));
+
+    // Jump to event id
+    auto* show_row = new TGHorizontalFrame(group);
+    entry_ = new TGNumberEntry(show_row,
+                               0,
+                               8,
+                               show_id,
+                               TGNumberFormat::kNESInteger,
+                               TGNumberFormat::kNEANonNegative);
+    entry_->Associate(this);
+    auto* show = new TGTextButton(show_row, "Show", show_id);
+    show->Associate(this);
+    show_row->AddFrame(entry_, new TGLayoutHints(kLHintsExpandX, 0, 2));
+    show_row->AddFrame(show, new TGLayoutHints(kLHintsNoHints, 2, 0));
+    group->AddFrame(show_row, new TGLayoutHints(kLHintsExpandX, 2, 2, 2, 4));
+
+    this->AddFrame(group, new TGLayoutHints(kLHintsExpandX, 4, 4, 4, 4));
+    this->MapSubwindows();
+    this->Resize(this->GetDefaultSize());
+    this->MapWindow();
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Show the current event id.
+ */
+void EventNavigator::Frame::update(int event_id)
+{
+    if (event_id < 0)
+    {
+        return;
+    }
+    label_->SetText(("Showing event " + std::to_string(event_id)).c_str());
+    entry_->SetIntNumber(event_id);
+    this->Layout();
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Step through events or show the entered event id.
+ */
+Bool_t EventNavigator::Frame::ProcessMessage(Longptr_t msg,
+                                             Longptr_t parm1,
+                                             Longptr_t)
+{
+    if (!navigator_)
+    {
+        return kTRUE;
+    }
+
+    bool const clicked = (GET_MSG(msg) == kC_COMMAND
+                          && GET_SUBMSG(msg) == kCM_BUTTON);
+    bool const entered = (GET_MSG(msg) == kC_TEXTENTRY
+                          && GET_SUBMSG(msg) == kTE_ENTER);
+    if (clicked && parm1 == previous_id)
+    {
+        navigator_->step_event(-1);
+    }
+    else if (clicked && parm1 == next_id)
+    {
+        navigator_->step_event(1);
+    }
+    else if ((clicked || entered) && parm1 == show_id)
+    {
+        navigator_->show_event(entry_->GetIntNumber());
+    }
+    return kTRUE;
+}
@@ -0,0 +1,43 @@
+//----------------------------------*-C++-*----------------------------------//
+// Copyright 2023 UT-Battelle, LLC, and other Celeritas developers.
+// See the top-level COPYRIGHT file for details.
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+//---------------------------------------------------------------------------//
+//! \file src/EventNavigator.hh
+//---------------------------------------------------------------------------//
+#pragma once
+
+#include "MCTruthViewerInterface.hh"
+
+//---------------------------------------------------------------------------//
+/*!
+ * Previous/next/jump-to-event controls in an \c Events tab of the browser.
+ *
+ * Events are replaced through \c MCTruthViewerInterface::show_event , so that
+ * cached and prefetched events are shown without reading the input.
+ */
+class EventNavigator
+{
+  public:
+    // Construct and add the navigation frame to the browser
+    explicit EventNavigator(MCTruthViewerInterface& viewer);
+
+    // Detach from the navigation frame owned by the browser
+    ~EventNavigator();
+
+    // Show a given event
+    void show_event(int event_id);
+
+    // Show the next (positive) or previous (negative) event
+    void step_event(int offset);
+
+  private:
+    //// TYPES ////
+
+    class Frame;
+
+    //// DATA ////
+
+    MCTruthViewerInterface& viewer_;
+    Frame* frame_{nullptr};
+};
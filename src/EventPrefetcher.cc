@@ -0,0 +1,186 @@
+//----------------------------------*-C++-*----------------------------------//
+// Copyright 2023 UT-Battelle, LLC, and other Celeritas developers.
+// See the top-level COPYRIGHT file for details.
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+//---------------------------------------------------------------------------//
+//! \file src/EventPrefetcher.cc
+//---------------------------------------------------------------------------//
+#include "EventPrefetcher.hh"
+
+#include <assert.h>
+
+//---------------------------------------------------------------------------//
+/*!
+ * Construct and start the worker thread.
+ */
+EventPrefetcher::EventPrefetcher(EventCache& cache,
+                                 MakeReader make_reader,
+                                 Decode decode,
+                                 Keep keep)
+    : cache_(cache)
+    , make_reader_(std::move(make_reader))
+    , decode_(std::move(decode))
+    , keep_(std::move(keep))
+{
+    assert(make_reader_ && decode_ && keep_);
+    worker_ = std::thread([this] { this->run(); });
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Stop the worker after the event it is decoding.
+ */
+EventPrefetcher::~EventPrefetcher()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    worker_.join();
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Replace pending requests with new ones, served in order.
+ *
+ * The event being decoded, if any, is not interrupted. Cached candidates
+ * count as kept without being decoded again.
+ */
+void EventPrefetcher::request(std::vector<Request> requests)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending_.clear();
+        for (auto& request : requests)
+        {
+            pending_.push_back({std::move(request)});
+        }
+        ++generation_;
+    }
+    cv_.notify_all();
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Decode an event ahead of pending ones, unless it is cached, and wait until
+ * the worker has passed it to \c keep .
+ */
+void EventPrefetcher::fetch(int event_id)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    urgent_ = event_id;
+    cv_.notify_all();
+    cv_.wait(lock, [this, event_id] {
+        return urgent_ != event_id && in_flight_ != event_id;
+    });
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Wait until an event is no longer being decoded by the worker.
+ *
+ * This lets the caller pick up an event from the cache instead of decoding it
+ * a second time.
+ */
+void EventPrefetcher::wait(int event_id)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [this, event_id] { return in_flight_ != event_id; });
+}
+
+//---------------------------------------------------------------------------//
+// PRIVATE
+//---------------------------------------------------------------------------//
+
+//---------------------------------------------------------------------------//
+/*!
+ * Decode fetched and requested events that are not cached yet.
+ */
+void EventPrefetcher::run()
+{
+    std::unique_ptr<EventReader> reader;
+    while (true)
+    {
+        int event_id = -1;
+        bool requested = false;
+        std::size_t generation;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            in_flight_ = -1;
+            cv_.notify_all();
+            while (!stop_ && !this->next_event(&event_id, &requested))
+            {
+                cv_.wait(lock);
+            }
+            if (stop_)
+            {
+                return;
+            }
+            in_flight_ = event_id;
+            generation = generation_;
+        }
+
+        if (!reader)
+        {
+            reader = make_reader_();
+        }
+        auto event = decode_(*reader, event_id);
+        if (!keep_(event_id, event))
+        {
+            continue;
+        }
+        cache_.insert(event_id, std::make_shared<EventData>(std::move(event)));
+        if (requested)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (generation == generation_ && !pending_.empty())
+            {
+                ++pending_.front().num_kept;
+            }
+        }
+    }
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Pick the next event to decode, with the mutex held: the fetched event, if
+ * any, or the next candidate of the first request that still wants some.
+ * Cached events are skipped.
+ */
+bool EventPrefetcher::next_event(int* event_id, bool* requested)
+{
+    if (urgent_ >= 0)
+    {
+        *event_id = urgent_;
+        *requested = false;
+        urgent_ = -1;
+        if (!cache_.contains(*event_id))
+        {
+            return true;
+        }
+        // Wake up the fetching thread
+        cv_.notify_all();
+    }
+
+    while (!pending_.empty())
+    {
+        auto& front = pending_.front();
+        auto const& ids = front.request.event_ids;
+        if (front.num_kept >= front.request.num_wanted
+            || front.next == ids.size())
+        {
+            pending_.pop_front();
+            continue;
+        }
+        *event_id = ids[front.next++];
+        if (cache_.contains(*event_id))
+        {
+            ++front.num_kept;
+            continue;
+        }
+        *requested = true;
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,100 @@
+//----------------------------------*-C++-*----------------------------------//
+// Copyright 2023 UT-Battelle, LLC, and other Celeritas developers.
+// See the top-level COPYRIGHT file for details.
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+//---------------------------------------------------------------------------//
+//! \file src/EventPrefetcher.hh
+//---------------------------------------------------------------------------//
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "EventCache.hh"
+#include "MCTruthViewerInterface.hh"
+
+//---------------------------------------------------------------------------//
+/*!
+ * Decode events on a worker thread and add them to an event cache.
+ *
+ * Each call to \c request replaces the list of pending requests, so that only
+ * the neighbors of the event currently shown are decoded. A request lists
+ * candidate events, in decoding order, of which only the first few that are
+ * kept are wanted: events are only added to the cache if \c keep accepts
+ * them, e.g. if they pass an event selection, and candidates are decoded until
+ * enough of them are kept. \c fetch decodes an event ahead of the pending
+ * ones, so that the calling thread never decodes events only to test them.
+ * The worker uses its own reader, created on first use.
+ */
+class EventPrefetcher
+{
+  public:
+    //!@{
+    //! \name Type aliases
+    using EventReader = MCTruthViewerInterface::EventReader;
+    using MakeReader = std::function<std::unique_ptr<EventReader>()>;
+    using Decode = std::function<EventData(EventReader&, int)>;
+    using Keep = std::function<bool(int, EventData const&)>;
+    //!@}
+
+    //! Candidate events, of which only the first \c num_wanted kept ones
+    struct Request
+    {
+        std::vector<int> event_ids;
+        std::size_t num_wanted;
+    };
+
+    // Construct and start the worker thread
+    EventPrefetcher(EventCache& cache,
+                    MakeReader make_reader,
+                    Decode decode,
+                    Keep keep);
+
+    // Stop the worker after the current event
+    ~EventPrefetcher();
+
+    // Replace pending requests with new ones, served in order
+    void request(std::vector<Request> requests);
+
+    // Decode an event ahead of pending ones and wait until it is processed
+    void fetch(int event_id);
+
+    // Wait until an event is no longer being decoded by the worker
+    void wait(int event_id);
+
+  private:
+    //// TYPES ////
+
+    struct Pending
+    {
+        Request request;
+        std::size_t next{0};  //!< Next candidate to decode
+        std::size_t num_kept{0};
+    };
+
+    //// DATA ////
+
+    EventCache& cache_;
+    MakeReader make_reader_;
+    Decode decode_;
+    Keep keep_;
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<Pending> pending_;
+    std::size_t generation_{0};  //!< Incremented when requests are replaced
+    int urgent_{-1};
+    int in_flight_{-1};
+    bool stop_{false};
+    std::thread worker_;
+
+    //// HELPER FUNCTIONS ////
+
+    void run();
+    bool next_event(int* event_id, bool* requested);
+};
@@ -0,0 +1,400 @@
+//----------------------------------*-C++-*----------------------------------//
+// Copyright 2023 UT-Battelle, LLC, and other Celeritas developers.
+// See the top-level COPYRIGHT file for details.
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+//---------------------------------------------------------------------------//
+//! \file src/EventSelection.cc
+//---------------------------------------------------------------------------//
+#include "EventSelection.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <assert.h>
+
+#include "EventLoader.hh"
+#include "EventPrefetcher.hh"
+#include "MCTruthViewerInterface.hh"
+#include "Profiler.hh"
+
+namespace
+{
+//---------------------------------------------------------------------------//
+// Candidates prefetched per wanted event while events are tested one by one
+constexpr int select_lookahead = 16;
+//---------------------------------------------------------------------------//
+}  // namespace
+
+//---------------------------------------------------------------------------//
+/*!
+ * Construct for a viewer, whose filter, readers, and loader are used to list,
+ * decode, and test events.
+ */
+EventSelection::EventSelection(MCTruthViewerInterface& viewer)
+    : viewer_(viewer)
+{
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Check that the prefetcher is stopped.
+ */
+EventSelection::~EventSelection()
+{
+    assert(!prefetcher_);
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Set the memory limit [bytes] of the decoded event cache, and the number of
+ * events after the current one that are decoded ahead of time.
+ */
+void EventSelection::set_cache(std::size_t max_bytes,
+                               unsigned int num_prefetch)
+{
+    assert(!cache_);
+    cache_bytes_ = max_bytes;
+    num_prefetch_ = num_prefetch;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Forget selected events and tested events after the filter changed.
+ */
+void EventSelection::reset()
+{
+    ids_.clear();
+    selected_ = false;
+    std::lock_guard<std::mutex> lock(mutex_);
+    results_.clear();
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Sorted ids of the events that pass the event selection.
+ */
+std::vector<int> const& EventSelection::ids()
+{
+    if (!selected_)
+    {
+        auto const& filter = viewer_.filter_;
+        ids_ = viewer_.event_ids();
+        ids_.erase(std::remove_if(ids_.begin(),
+                                  ids_.end(),
+                                  [&filter](int id) {
+                                      return !filter.pass_event(id);
+                                  }),
+                   ids_.end());
+        if (filter.event_select)
+        {
+            this->apply_event_select(&ids_);
+        }
+        selected_ = true;
+    }
+    return ids_;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Whether an event passes the event selection expression, if any.
+ *
+ * Unless all events were already selected, the expression is evaluated on
+ * this event only, by the prefetcher thread: the event is decoded there and
+ * only cached if it passes, so that showing it afterwards does not decode it
+ * again, and events that fail are neither decoded on the calling thread nor
+ * kept in the cache.
+ */
+bool EventSelection::passes(int event_id)
+{
+    if (!viewer_.filter_.event_select)
+    {
+        return true;
+    }
+    if (selected_)
+    {
+        return std::binary_search(ids_.begin(), ids_.end(), event_id);
+    }
+
+    this->cache();
+    prefetcher_->wait(event_id);
+    bool result = false;
+    if (!this->tested(event_id, &result))
+    {
+        prefetcher_->fetch(event_id);
+        this->tested(event_id, &result);
+    }
+    return result;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Event that passes the event selection, reached by stepping \c offset
+ * selected events forward (positive) or backward (negative) from the current
+ * one. Returns a negative id if there is no such event.
+ */
+int EventSelection::step(int offset)
+{
+    assert(offset != 0);
+    int const direction = (offset > 0) ? 1 : -1;
+    int event_id = current_;
+    for (int i = 0; i != offset; i += direction)
+    {
+        do
+        {
+            auto const next = this->neighbors(event_id, direction);
+            if (next.empty())
+            {
+                return -1;
+            }
+            event_id = next.front();
+        } while (!this->passes(event_id));
+    }
+    return event_id;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Set the event currently shown and prefetch its neighbors; a negative id
+ * means that all events are drawn.
+ */
+void EventSelection::set_current(int event_id)
+{
+    current_ = event_id;
+    if (event_id >= 0)
+    {
+        this->cache();
+        this->prefetch_neighbors();
+    }
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Decoded event cache, created along with the prefetcher on first use.
+ */
+EventCache& EventSelection::cache()
+{
+    if (!cache_)
+    {
+        cache_ = std::make_unique<EventCache>(cache_bytes_);
+        prefetcher_ = std::make_unique<EventPrefetcher>(
+            *cache_,
+            [this] { return viewer_.make_reader(); },
+            [this](MCTruthViewerInterface::EventReader& reader, int event_id) {
+                return viewer_.decode(reader, event_id);
+            },
+            [this](int event_id, EventData const& event) {
+                return this->test(event_id, event);
+            });
+    }
+    return *cache_;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Decoded event from the cache or, if missing, from the input.
+ *
+ * If the prefetcher is decoding the event, wait for it instead of decoding
+ * the event a second time. Missing events are decoded by the prefetcher
+ * thread, and only decoded here if the cache could not keep them.
+ */
+auto EventSelection::cached_event(int event_id, bool* from_cache)
+    -> SPConstEvent
+{
+    auto& cache = this->cache();
+    prefetcher_->wait(event_id);
+    if (auto result = cache.find(event_id))
+    {
+        *from_cache = true;
+        return result;
+    }
+
+    *from_cache = false;
+    prefetcher_->fetch(event_id);
+    if (auto result = cache.find(event_id))
+    {
+        return result;
+    }
+    auto result = std::make_shared<EventData const>(
+        viewer_.decode(viewer_.reader(), event_id));
+    cache.insert(event_id, result);
+    return result;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Stop the prefetcher after the event it is decoding.
+ */
+void EventSelection::stop()
+{
+    prefetcher_.reset();
+}
+
+//---------------------------------------------------------------------------//
+// PRIVATE
+//---------------------------------------------------------------------------//
+
+//---------------------------------------------------------------------------//
+/*!
+ * Up to \c |count| events in the selected range following \c event_id , or
+ * preceding it if \c count is negative, nearest first.
+ *
+ * Available ids are requested from the input in small batches, so that only
+ * the part of the input around the event is indexed. Events known to fail
+ * the event selection are skipped.
+ */
+std::vector<int> EventSelection::neighbors(int event_id, int count)
+{
+    assert(count != 0);
+    auto const& filter = viewer_.filter_;
+    std::size_t const num_wanted = std::abs(count);
+    int const batch = count * filter.event_stride;
+    std::vector<int> result;
+    while (result.size() < num_wanted)
+    {
+        auto const ids = viewer_.neighbor_ids(event_id, batch);
+        for (auto id : ids)
+        {
+            bool const outside = (count > 0) ? id >= filter.event_last
+                                             : id < filter.event_first;
+            if (outside)
+            {
+                return result;
+            }
+            if (filter.pass_event(id) && !this->fails(id)
+                && result.size() < num_wanted)
+            {
+                result.push_back(id);
+            }
+        }
+        if (static_cast<int>(ids.size()) < std::abs(batch))
+        {
+            break;
+        }
+        event_id = ids.back();
+    }
+    return result;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Whether an event is known to fail the event selection expression, without
+ * testing it.
+ */
+bool EventSelection::fails(int event_id) const
+{
+    if (!viewer_.filter_.event_select)
+    {
+        return false;
+    }
+    if (selected_)
+    {
+        return !std::binary_search(ids_.begin(), ids_.end(), event_id);
+    }
+    bool passes = true;
+    return this->tested(event_id, &passes) && !passes;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Result of the event selection expression for an event tested on its own.
+ * Returns false if the event was not tested yet.
+ */
+bool EventSelection::tested(int event_id, bool* passes) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto iter = results_.find(event_id);
+    if (iter == results_.end())
+    {
+        return false;
+    }
+    *passes = iter->second;
+    return true;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Test an event decoded by the prefetcher against the event selection
+ * expression, if any, and remember the result. Returns whether it passes.
+ */
+bool EventSelection::test(int event_id, EventData const& event)
+{
+    auto const& event_select = viewer_.filter_.event_select;
+    if (!event_select)
+    {
+        return true;
+    }
+    bool const result = event_select.pass_event(event);
+    std::lock_guard<std::mutex> lock(mutex_);
+    results_[event_id] = result;
+    return result;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Remove the events failing the event selection expression.
+ *
+ * The expression is evaluated in a single scan of the given events, decoded
+ * on worker threads with their tracks already selected, so that events that
+ * fail it are never drawn or prefetched.
+ */
+void EventSelection::apply_event_select(std::vector<int>* ids)
+{
+    ScopedTimer timer("Event selection");
+    auto const start = std::chrono::steady_clock::now();
+
+    auto const& event_select = viewer_.filter_.event_select;
+    std::vector<char> passed(ids->size(), 0);
+    viewer_.loader_->scan(*ids,
+                          viewer_.num_threads_,
+                          [&event_select, &passed](std::size_t i,
+                                                   EventData const& event,
+                                                   unsigned int) {
+                              passed[i] = event_select.pass_event(event);
+                          });
+
+    auto const num_events = ids->size();
+    std::size_t num_passed = 0;
+    for (std::size_t i = 0; i < num_events; i++)
+    {
+        if (passed[i])
+        {
+            (*ids)[num_passed++] = (*ids)[i];
+        }
+    }
+    ids->resize(num_passed);
+
+    std::chrono::duration<double> const time
+        = std::chrono::steady_clock::now() - start;
+    std::cout << "Event selection: " << num_passed << " of " << num_events
+              << " events pass \"" << event_select.source() << "\" in "
+              << time.count() << " s" << std::endl;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Prefetch the events in the selected range following the current one, then
+ * the one preceding it.
+ *
+ * Only the neighbors of the current event are looked up, so that showing a
+ * single event never lists all events of the input. When events are tested
+ * against the event selection one by one, more candidates are listed, so
+ * that the prefetcher keeps testing them until enough of them pass.
+ */
+void EventSelection::prefetch_neighbors()
+{
+    if (num_prefetch_ == 0)
+    {
+        return;
+    }
+
+    int const lookahead = (viewer_.filter_.event_select && !selected_)
+                              ? select_lookahead
+                              : 1;
+    std::vector<EventPrefetcher::Request> requests;
+    requests.push_back(
+        {this->neighbors(current_, lookahead * static_cast<int>(num_prefetch_)),
+         num_prefetch_});
+    requests.push_back({this->neighbors(current_, -lookahead), 1});
+    prefetcher_->request(std::move(requests));
+}
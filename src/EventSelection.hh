@@ -0,0 +1,109 @@
+//----------------------------------*-C++-*----------------------------------//
+// Copyright 2023 UT-Battelle, LLC, and other Celeritas developers.
+// See the top-level COPYRIGHT file for details.
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+//---------------------------------------------------------------------------//
+//! \file src/EventSelection.hh
+//---------------------------------------------------------------------------//
+#pragma once
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "EventCache.hh"
+
+class EventPrefetcher;
+class MCTruthViewerInterface;
+
+//---------------------------------------------------------------------------//
+/*!
+ * Events of a viewer that pass its selection, and navigation among them.
+ *
+ * All selected events are listed with \c ids , which tests the event
+ * selection expression on all of them in a single parallel scan. When a
+ * single event is shown, events are instead looked up around the current
+ * one, and tested one at a time on the prefetcher thread. Decoded events are
+ * kept in an LRU cache, and the events following and preceding the current
+ * one are decoded ahead of time. \c stop must be called before the viewer's
+ * concrete implementation is destroyed.
+ */
+class EventSelection
+{
+  public:
+    //!@{
+    //! \name Type aliases
+    using SPConstEvent = EventCache::SPConstEvent;
+    //!@}
+
+    // Construct for a viewer, using its filter and readers
+    explicit EventSelection(MCTruthViewerInterface& viewer);
+
+    // Check that the prefetcher is stopped
+    ~EventSelection();
+
+    // Set decoded event cache size [bytes] and number of prefetched events
+    void set_cache(std::size_t max_bytes, unsigned int num_prefetch);
+
+    // Forget selected events after the filter changed
+    void reset();
+
+    // Events that pass the event selection
+    std::vector<int> const& ids();
+
+    // Whether an event passes the event selection expression, if any
+    bool passes(int event_id);
+
+    // Event reached by stepping from the current one; negative if none
+    int step(int offset);
+
+    //! Event currently shown; negative if all events are drawn
+    int current() const { return current_; }
+
+    // Set the event currently shown and prefetch its neighbors
+    void set_current(int event_id);
+
+    // Decoded event cache, created along with the prefetcher on first use
+    EventCache& cache();
+
+    // Decoded event from the cache or, if missing, from the input
+    SPConstEvent cached_event(int event_id, bool* from_cache);
+
+    // Stop prefetching
+    void stop();
+
+    //! Whether the prefetcher is running
+    bool prefetching() const { return prefetcher_ != nullptr; }
+
+  private:
+    MCTruthViewerInterface& viewer_;
+
+    std::size_t cache_bytes_{std::size_t(512) << 20};
+    unsigned int num_prefetch_{2};
+    std::unique_ptr<EventCache> cache_;
+    std::unique_ptr<EventPrefetcher> prefetcher_;
+    std::vector<int> ids_;
+    bool selected_{false};  //!< Selected ids are up to date
+    std::map<int, bool> results_;  //!< Single events tested
+    mutable std::mutex mutex_;  //!< Guards single event results
+    int current_{-1};
+
+    // Events in the selected range following or preceding an event
+    std::vector<int> neighbors(int event_id, int count);
+
+    // Whether an event is known to fail the event selection expression
+    bool fails(int event_id) const;
+
+    // Result of the event selection expression for a single tested event
+    bool tested(int event_id, bool* passes) const;
+
+    // Test a decoded event against the event selection and remember it
+    bool test(int event_id, EventData const& event);
+
+    // Remove the events failing the event selection expression
+    void apply_event_select(std::vector<int>* ids);
+
+    // Prefetch events around the current one
+    void prefetch_neighbors();
+};
@@ -0,0 +1,424 @@
+//----------------------------------*-C++-*----------------------------------//
+// Copyright 2023 UT-Battelle, LLC, and other Celeritas developers.
+// See the top-level COPYRIGHT file for details.
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+//---------------------------------------------------------------------------//
+//! \file src/EventSummary.cc
+//---------------------------------------------------------------------------//
+#include "EventSummary.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <sstream>
+#include <TSystem.h>
+#include <assert.h>
+
+#include "MCTruthViewerInterface.hh"
+#include "Profiler.hh"
+
+namespace
+{
+//---------------------------------------------------------------------------//
+// Sidecar file magic string, including format version
+char const sidecar_magic[8] = {'E', 'V', 'D', 'S', 'U', 'M', '0', '1'};
+
+//---------------------------------------------------------------------------//
+template<class T>
+void write_pod(std::ostream& os, T const& value)
+{
+    os.write(reinterpret_cast<char const*>(&value), sizeof(T));
+}
+
+template<class T>
+bool read_pod(std::istream& is, T* value)
+{
+    is.read(reinterpret_cast<char*>(value), sizeof(T));
+    return static_cast<bool>(is);
+}
+
+template<class T>
+void write_vector(std::ostream& os, std::vector<T> const& vec)
+{
+    write_pod(os, static_cast<std::uint64_t>(vec.size()));
+    os.write(reinterpret_cast<char const*>(vec.data()),
+             vec.size() * sizeof(T));
+}
+
+template<class T>
+bool read_vector(std::istream& is, std::vector<T>* vec)
+{
+    std::uint64_t size{0};
+    if (!read_pod(is, &size))
+    {
+        return false;
+    }
+    vec->resize(size);
+    is.read(reinterpret_cast<char*>(vec->data()), size * sizeof(T));
+    return static_cast<bool>(is);
+}
+
+//---------------------------------------------------------------------------//
+// Column counting a PDG code: species of batched tracks, or other
+EventSummary::Species species(int pdg)
+{
+    using PDG = MCTruthViewerInterface::PDG;
+    switch (MCTruthViewerInterface::species(pdg))
+    {
+        case PDG::gamma:
+            return EventSummary::gamma;
+        case PDG::e_minus:
+            return EventSummary::e_minus;
+        case PDG::e_plus:
+            return EventSummary::e_plus;
+        case PDG::mu_minus:
+            return EventSummary::mu_minus;
+        default:
+            return EventSummary::other;
+    }
+}
+
+//---------------------------------------------------------------------------//
+// Length of the diagonal of the bounding box of an event [cm]
+double extent(EventSummary::Row const& row)
+{
+    double result = 0;
+    for (int i = 0; i < 3; i++)
+    {
+        double const width = row.upper[i] - row.lower[i];
+        result += width * width;
+    }
+    return std::sqrt(result);
+}
+
+//---------------------------------------------------------------------------//
+}  // namespace
+
+//---------------------------------------------------------------------------//
+/*!
+ * Load the table from its sidecar file if it is up to date. Otherwise build
+ * it with a single scan of the selected events and save it for later runs.
+ */
+EventSummary
+EventSummary::load_or_build(MCTruthViewerInterface& viewer,
+                            std::vector<std::string> const& inputs,
+                            TrackFilter const& filter)
+{
+    assert(!inputs.empty());
+    EventSummary result;
+    auto const key = EventSummary::make_key(inputs, filter);
+    auto const filename = inputs.front() + ".evdsum";
+
+    bool loaded;
+    {
+        ScopedTimer timer("Event summary read");
+        loaded = result.read(filename, key);
+    }
+    if (loaded)
+    {
+        std::cout << "Event summary: " << filename << " ("
+                  << result.rows_.size() << " events)" << std::endl;
+        return result;
+    }
+
+    {
+        ScopedTimer timer("Event summary build");
+        result.build(viewer);
+    }
+    if (result.write(filename, key))
+    {
+        std::cout << "Event summary: built and saved to " << filename << " ("
+                  << result.rows_.size() << " events)" << std::endl;
+    }
+    else
+    {
+        std::cout << "[WARNING] Could not write event summary to " << filename
+                  << std::endl;
+    }
+    return result;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Summarize a decoded event.
+ *
+ * The primary energy is only summed if parents and vertex energies were
+ * decoded, and the energy deposition and number of interactions only if
+ * their per-point data was.
+ */
+auto EventSummary::summarize(EventData const& event) -> Row
+{
+    Row result;
+    result.event_id = event.id;
+    result.num_tracks = event.num_tracks();
+
+    bool const has_primaries = event.parent_ids.size() == event.num_tracks()
+                               && event.vertex_energies.size()
+                                      == event.num_tracks();
+    for (std::size_t t = 0; t < event.num_tracks(); t++)
+    {
+        auto const n = event.offsets[t + 1] - event.offsets[t];
+        result.num_steps += n > 0 ? n - 1 : 0;
+        ++result.species_counts[species(event.pdgs[t])];
+        if (has_primaries && event.parent_ids[t] < 0)
+        {
+            result.primary_energy += event.vertex_energies[t];
+        }
+    }
+
+    result.num_interactions
+        = std::count(event.interaction.begin(), event.interaction.end(), true);
+    for (auto e : event.energy_deposits)
+    {
+        result.energy_deposition += e;
+    }
+
+    if (!event.points.empty())
+    {
+        result.lower.fill(std::numeric_limits<float>::infinity());
+        result.upper.fill(-std::numeric_limits<float>::infinity());
+        for (auto const& point : event.points)
+        {
+            for (int i = 0; i < 3; i++)
+            {
+                auto const x = static_cast<float>(point[i]);
+                result.lower[i] = std::min(result.lower[i], x);
+                result.upper[i] = std::max(result.upper[i], x);
+            }
+        }
+    }
+    return result;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Value of a column for a row. The extent is the length of the diagonal of
+ * the bounding box of the event [cm].
+ */
+double EventSummary::value(Row const& row, Column column)
+{
+    switch (column)
+    {
+        case Column::event_id:
+            return row.event_id;
+        case Column::num_tracks:
+            return row.num_tracks;
+        case Column::num_steps:
+            return row.num_steps;
+        case Column::num_interactions:
+            return row.num_interactions;
+        case Column::primary_energy:
+            return row.primary_energy;
+        case Column::energy_deposition:
+            return row.energy_deposition;
+        case Column::extent:
+            return extent(row);
+        case Column::num_gamma:
+            return row.species_counts[gamma];
+        case Column::num_e_minus:
+            return row.species_counts[e_minus];
+        case Column::num_e_plus:
+            return row.species_counts[e_plus];
+        case Column::num_mu_minus:
+            return row.species_counts[mu_minus];
+        case Column::num_other:
+            return row.species_counts[other];
+        default:
+            assert(false);
+            return 0;
+    }
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Column name.
+ */
+char const* EventSummary::to_string(Column column)
+{
+    switch (column)
+    {
+        case Column::event_id:
+            return "Event id";
+        case Column::num_tracks:
+            return "Tracks";
+        case Column::num_steps:
+            return "Steps";
+        case Column::num_interactions:
+            return "Interactions";
+        case Column::primary_energy:
+            return "Primary energy [MeV]";
+        case Column::energy_deposition:
+            return "Energy deposition [MeV]";
+        case Column::extent:
+            return "Extent [cm]";
+        case Column::num_gamma:
+            return "gamma";
+        case Column::num_e_minus:
+            return "e-";
+        case Column::num_e_plus:
+            return "e+";
+        case Column::num_mu_minus:
+            return "mu-";
+        case Column::num_other:
+            return "Other species";
+        default:
+            assert(false);
+            return "";
+    }
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Row positions sorted by a column. Rows are sorted by event id, so a stable
+ * sort breaks ties by increasing event id in either direction.
+ */
+std::vector<std::size_t>
+EventSummary::sorted(Column column, bool descending) const
+{
+    std::vector<double> values(rows_.size());
+    for (std::size_t i = 0; i < rows_.size(); i++)
+    {
+        values[i] = EventSummary::value(rows_[i], column);
+    }
+
+    std::vector<std::size_t> result(rows_.size());
+    std::iota(result.begin(), result.end(), 0);
+    std::stable_sort(
+        result.begin(), result.end(), [&](std::size_t lhs, std::size_t rhs) {
+            return descending ? values[lhs] > values[rhs]
+                              : values[lhs] < values[rhs];
+        });
+    return result;
+}
+
+//---------------------------------------------------------------------------//
+// PRIVATE
+//---------------------------------------------------------------------------//
+
+//---------------------------------------------------------------------------//
+/*!
+ * Properties used to validate a sidecar file: name, size, and modification
+ * time of every input, followed by the track filter and its expressions.
+ */
+std::string EventSummary::make_key(std::vector<std::string> const& inputs,
+                                   TrackFilter const& filter)
+{
+    std::ostringstream os;
+    for (auto const& input : inputs)
+    {
+        FileStat_t stat;
+        if (gSystem->GetPathInfo(input.c_str(), stat) != 0)
+        {
+            stat.fSize = -1;
+            stat.fMtime = -1;
+        }
+        os << input << ' ' << stat.fSize << ' ' << stat.fMtime << '\n';
+    }
+
+    os << "events " << filter.event_first << ':' << filter.event_last << ':'
+       << filter.event_stride << "\npdg";
+    for (auto pdg : filter.pdg_allow)
+    {
+        os << ' ' << pdg;
+    }
+    os << "\nno-pdg";
+    for (auto pdg : filter.pdg_deny)
+    {
+        os << ' ' << pdg;
+    }
+    os.precision(std::numeric_limits<double>::max_digits10);
+    os << "\nmin-energy " << filter.min_vertex_energy << "\nmin-length "
+       << filter.min_length << "\nprimaries " << filter.primaries_only
+       << "\nselect " << filter.track_select.source() << "\nevent-select "
+       << filter.event_select.source();
+    return os.str();
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Build the table in a single scan of the selected events.
+ *
+ * Track attributes, interaction flags, and energy deposits are decoded for
+ * the scan only. Each worker thread appends the rows of the events it decodes
+ * to its own list, and the lists are merged and sorted by event id.
+ */
+void EventSummary::build(MCTruthViewerInterface& viewer)
+{
+    auto const start = std::chrono::steady_clock::now();
+
+    viewer.set_decode_attributes(true);
+    std::vector<std::vector<Row>> tallies(viewer.num_threads());
+    viewer.scan_events(
+        [&tallies](EventData const& event, unsigned int thread_id) {
+            tallies[thread_id].push_back(EventSummary::summarize(event));
+        });
+    viewer.set_decode_attributes(false);
+
+    rows_.clear();
+    for (auto const& tally : tallies)
+    {
+        rows_.insert(rows_.end(), tally.begin(), tally.end());
+    }
+    std::sort(rows_.begin(), rows_.end(), [](Row const& lhs, Row const& rhs) {
+        return lhs.event_id < rhs.event_id;
+    });
+
+    std::chrono::duration<double> const time
+        = std::chrono::steady_clock::now() - start;
+    std::cout << "Event summary: scanned " << rows_.size() << " events in "
+              << time.count() << " s" << std::endl;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Read sidecar file, returning false if it is missing or stale.
+ */
+bool EventSummary::read(std::string const& filename, std::string const& key)
+{
+    std::ifstream input(filename, std::ios::binary);
+    if (!input)
+    {
+        return false;
+    }
+
+    char magic[sizeof(sidecar_magic)];
+    input.read(magic, sizeof(magic));
+    if (!input || std::memcmp(magic, sidecar_magic, sizeof(magic)) != 0)
+    {
+        return false;
+    }
+
+    std::vector<char> stored;
+    if (!read_vector(input, &stored)
+        || std::string(stored.begin(), stored.end()) != key)
+    {
+        // Sidecar belongs to different or modified inputs, or another filter
+        return false;
+    }
+    return read_vector(input, &rows_);
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Write sidecar file.
+ */
+bool EventSummary::write(std::string const& filename,
+                         std::string const& key) const
+{
+    std::ofstream output(filename, std::ios::binary | std::ios::trunc);
+    if (!output)
+    {
+        return false;
+    }
+
+    output.write(sidecar_magic, sizeof(sidecar_magic));
+    write_vector(output, std::vector<char>(key.begin(), key.end()));
+    write_vector(output, rows_);
+
+    return static_cast<bool>(output);
+}
@@ -0,0 +1,117 @@
+//----------------------------------*-C++-*----------------------------------//
+// Copyright 2023 UT-Battelle, LLC, and other Celeritas developers.
+// See the top-level COPYRIGHT file for details.
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+//---------------------------------------------------------------------------//
+//! \file src/EventSummary.hh
+//---------------------------------------------------------------------------//
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "EventData.hh"
+#include "TrackFilter.hh"
+
+class MCTruthViewerInterface;
+
+//---------------------------------------------------------------------------//
+/*!
+ * Per-event summary of the selected events, used to browse and sort events
+ * without decoding their steps again.
+ *
+ * The table is filled in a single scan of the input, with events decoded and
+ * summarized on the viewer's worker threads, and persisted to a sidecar file
+ * (\c [first input].evdsum ). The sidecar is reused as long as the names,
+ * sizes, and modification times of the inputs and the track filter match the
+ * ones stored in its header.
+ *
+ * \code
+ *  auto summary = EventSummary::load_or_build(viewer, filenames, filter);
+ *  auto order = summary.sorted(EventSummary::Column::energy_deposition, true);
+ *  viewer.show_event(summary.rows()[order.front()].event_id);
+ * \endcode
+ */
+class EventSummary
+{
+  public:
+    //! Species grouped by \c MCTruthViewerInterface::species , in the order
+    //! of \c Row::species_counts
+    enum Species
+    {
+        gamma,
+        e_minus,
+        e_plus,
+        mu_minus,
+        other,
+        num_species
+    };
+
+    //! Sortable quantities
+    enum class Column
+    {
+        event_id,
+        num_tracks,
+        num_steps,
+        num_interactions,
+        primary_energy,
+        energy_deposition,
+        extent,
+        num_gamma,
+        num_e_minus,
+        num_e_plus,
+        num_mu_minus,
+        num_other,
+        size_
+    };
+
+    //! Summary of a single event
+    struct Row
+    {
+        std::int32_t event_id{0};
+        std::uint32_t num_tracks{0};
+        std::uint64_t num_steps{0};
+        std::uint64_t num_interactions{0};  //!< Discrete interaction steps
+        double primary_energy{0};  //!< Summed primary vertex energy [MeV]
+        double energy_deposition{0};  //!< Summed over all steps [MeV]
+        std::array<float, 3> lower{0, 0, 0};  //!< Bounding box of points [cm]
+        std::array<float, 3> upper{0, 0, 0};
+        std::array<std::uint32_t, num_species> species_counts{};
+    };
+
+    // Load the table from its sidecar file or build it from the input
+    static EventSummary load_or_build(MCTruthViewerInterface& viewer,
+                                      std::vector<std::string> const& inputs,
+                                      TrackFilter const& filter);
+
+    // Summarize a decoded event
+    static Row summarize(EventData const& event);
+
+    // Value of a column for a row
+    static double value(Row const& row, Column column);
+
+    // Column name
+    static char const* to_string(Column column);
+
+    // Row positions sorted by a column, ties broken by event id
+    std::vector<std::size_t> sorted(Column column, bool descending) const;
+
+    //! Rows sorted by event id
+    std::vector<Row> const& rows() const { return rows_; }
+
+  private:
+    //// DATA ////
+
+    std::vector<Row> rows_;
+
+    //// HELPER FUNCTIONS ////
+
+    static std::string make_key(std::vector<std::string> const& inputs,
+                                TrackFilter const& filter);
+
+    void build(MCTruthViewerInterface& viewer);
+    bool read(std::string const& filename, std::string const& key);
+    bool write(std::string const& filename, std::string const& key) const;
+};
@@ -0,0 +1,264 @@
+//----------------------------------*-C++-*----------------------------------//
+// Copyright 2023 UT-Battelle, LLC, and other Celeritas developers.
+// See the top-level COPYRIGHT file for details.
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+//---------------------------------------------------------------------------//
+//! \file src/EventTable.cc
+//---------------------------------------------------------------------------//
+#include "EventTable.hh"
+
+#include <cstdio>
+#include <string>
+#include <TEveBrowser.h>
+#include <TEveManager.h>
+#include <TGButton.h>
+#include <TGClient.h>
+#include <TGComboBox.h>
+#include <TGFrame.h>
+#include <TGLabel.h>
+#include <TGLayout.h>
+#include <TGListBox.h>
+#include <WidgetMessageTypes.h>
+
+namespace
+{
+//---------------------------------------------------------------------------//
+// Number of sorted rows listed; each one is a window of its own
+constexpr std::size_t max_listed_rows = 1000;
+
+//---------------------------------------------------------------------------//
+// Listed text of a row: event id, sorted value, and deposited energy
+std::string row_text(EventSummary::Row const& row, EventSummary::Column column)
+{
+    char value[64];
+    std::snprintf(value,
+                  sizeof(value),
+                  "%.6g",
+                  EventSummary::value(row, column));
+    char energy[64];
+    std::snprintf(energy,
+                  sizeof(energy),
+                  "%.4g MeV, %u tracks",
+                  row.energy_deposition,
+                  row.num_tracks);
+    return "Event " + std::to_string(row.event_id) + ":  " + value + "  ("
+           + energy + ")";
+}
+
+//---------------------------------------------------------------------------//
+}  // namespace
+
+//---------------------------------------------------------------------------//
+/*!
+ * Sort controls and row list, embedded in the browser.
+ */
+class EventTable::Frame final : public TGMainFrame
+{
+  public:
+    // Construct in the window currently being embedded
+    explicit Frame(EventTable* table);
+
+    // Replace the listed rows
+    void list(std::vector<std::string> const& rows, std::string const& status);
+
+    //! Stop forwarding selections
+    void detach() { table_ = nullptr; }
+
+    // Handle sort controls and row selection
+    Bool_t
+    ProcessMessage(Longptr_t msg, Longptr_t parm1, Longptr_t parm2) final;
+
+  private:
+    enum
+    {
+        column_id = 1,
+        descending_id,
+        rows_id
+    };
+
+    EventTable* table_;
+    TGComboBox* column_;
+    TGCheckButton* descending_;
+    TGLabel* status_;
+    TGListBox* rows_;
+
+    // Sort by the selected column and direction
+    void sort();
+};
+
+//---------------------------------------------------------------------------//
+/*!
+ * Construct and add the table frame to the browser, listing the events with
+ * the most deposited energy first.
+ */
+EventTable::EventTable(MCTruthViewerInterface& viewer, EventSummary summary)
+    : viewer_(viewer), summary_(std::move(summary))
+{
+    auto* browser = gEve->GetBrowser();
+    browser->StartEmbedding(TRootBrowser::kLeft);
+    frame_ = new Frame(this);
+    browser->StopEmbedding("Summary");
+    this->sort(Column::energy_deposition, true);
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * The frame is owned by the browser and may outlive the table.
+ */
+EventTable::~EventTable()
+{
+    frame_->detach();
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Sort rows by a column and list the first ones.
+ */
+void EventTable::sort(Column column, bool descending)
+{
+    order_ = summary_.sorted(column, descending);
+    if (order_.size() > max_listed_rows)
+    {
+        order_.resize(max_listed_rows);
+    }
+
+    auto const& rows = summary_.rows();
+    std::vector<std::string> lines;
+    lines.reserve(order_.size());
+    for (auto i : order_)
+    {
+        lines.push_back(row_text(rows[i], column));
+    }
+
+    std::string status = std::to_string(rows.size()) + " events by "
+                         + EventSummary::to_string(column);
+    if (order_.size() < rows.size())
+    {
+        status += ", first " + std::to_string(order_.size()) + " listed";
+    }
+    frame_->list(lines, status);
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Show the event of a listed row.
+ */
+void EventTable::show_row(std::size_t position)
+{
+    if (position < order_.size())
+    {
+        viewer_.show_event(summary_.rows()[order_[position]].event_id);
+    }
+}
+
+//---------------------------------------------------------------------------//
+// FRAME
+//---------------------------------------------------------------------------//
+
+//---------------------------------------------------------------------------//
+/*!
+ * Construct in the window currently being embedded.
+ */
+EventTable::Frame::Frame(EventTable* table)
+    : TGMainFrame(gClient->GetRoot(), 300, 400), table_(table)
+{
+    this->SetCleanup(kDeepCleanup);
+
+    // Sort column and direction
+    auto* sort_group = new TGGroupFrame(this, "Sort");
+    column_ = new TGComboBox(sort_group, column_id);
+    for (int i = 0; i < static_cast<int>(Column::size_); i++)
+    {
+        column_->AddEntry(EventSummary::to_string(static_cast<Column>(i)), i);
+    }
+    column_->Select(static_cast<int>(Column::energy_deposition), kFALSE);
+    column_->Resize(200, 20);
+    column_->Associate(this);
+    sort_group->AddFrame(column_,
+                         new TGLayoutHints(kLHintsExpandX, 2, 2, 4, 2));
+    descending_ = new TGCheckButton(sort_group, "Descending", descending_id);
+    descending_->SetState(kButtonDown);
+    descending_->Associate(this);
+    sort_group->AddFrame(descending_,
+                         new TGLayoutHints(kLHintsNoHints, 2, 2, 2, 4));
+    this->AddFrame(sort_group, new TGLayoutHints(kLHintsExpandX, 4, 4, 4, 4));
+
+    // Sorted rows
+    auto* event_group = new TGGroupFrame(this, "Events");
+    status_ = new TGLabel(event_group, "No event");
+    event_group->AddFrame(status_,
+                          new TGLayoutHints(kLHintsExpandX, 2, 2, 4, 2));
+    rows_ = new TGListBox(event_group, rows_id);
+    rows_->Resize(200, 300);
+    rows_->Associate(this);
+    event_group->AddFrame(
+        rows_, new TGLayoutHints(kLHintsExpandX | kLHintsExpandY, 2, 2, 2, 4));
+    this->AddFrame(
+        event_group,
+        new TGLayoutHints(kLHintsExpandX | kLHintsExpandY, 4, 4, 4, 4));
+
+    this->MapSubwindows();
+    this->Resize(this->GetDefaultSize());
+    this->MapWindow();
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Replace the listed rows, whose entry ids are their positions.
+ */
+void EventTable::Frame::list(std::vector<std::string> const& rows,
+                             std::string const& status)
+{
+    rows_->RemoveAll();
+    for (std::size_t i = 0; i < rows.size(); i++)
+    {
+        rows_->AddEntry(rows[i].c_str(), static_cast<Int_t>(i));
+    }
+    rows_->Layout();
+    status_->SetText(status.c_str());
+    this->Layout();
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Sort again when the column or direction changes, or show a selected row.
+ */
+Bool_t EventTable::Frame::ProcessMessage(Longptr_t msg,
+                                         Longptr_t parm1,
+                                         Longptr_t parm2)
+{
+    if (!table_ || GET_MSG(msg) != kC_COMMAND)
+    {
+        return kTRUE;
+    }
+
+    switch (GET_SUBMSG(msg))
+    {
+        case kCM_COMBOBOX:
+        case kCM_CHECKBUTTON:
+            if (parm1 == column_id || parm1 == descending_id)
+            {
+                this->sort();
+            }
+            break;
+        case kCM_LISTBOX:
+            if (parm1 == rows_id && parm2 >= 0)
+            {
+                table_->show_row(parm2);
+            }
+            break;
+        default:
+            break;
+    }
+    return kTRUE;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Sort by the selected column and direction.
+ */
+void EventTable::Frame::sort()
+{
+    table_->sort(static_cast<Column>(column_->GetSelected()),
+                 descending_->IsDown());
+}
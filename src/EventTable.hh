@@ -0,0 +1,55 @@
+//----------------------------------*-C++-*----------------------------------//
+// Copyright 2023 UT-Battelle, LLC, and other Celeritas developers.
+// See the top-level COPYRIGHT file for details.
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+//---------------------------------------------------------------------------//
+//! \file src/EventTable.hh
+//---------------------------------------------------------------------------//
+#pragma once
+
+#include <vector>
+
+#include "EventSummary.hh"
+#include "MCTruthViewerInterface.hh"
+
+//---------------------------------------------------------------------------//
+/*!
+ * Sortable list of event summaries in a \c Summary tab of the browser.
+ *
+ * Events are sorted by any column of the summary table, without reading the
+ * input, and the first rows of the sorted table are listed. Selecting a row
+ * replaces the drawn tracks with those of its event through
+ * \c MCTruthViewerInterface::show_event .
+ */
+class EventTable
+{
+  public:
+    //!@{
+    //! \name Type aliases
+    using Column = EventSummary::Column;
+    //!@}
+
+    // Construct and add the table frame to the browser
+    EventTable(MCTruthViewerInterface& viewer, EventSummary summary);
+
+    // Detach from the table frame owned by the browser
+    ~EventTable();
+
+    // Sort rows by a column and list the first ones
+    void sort(Column column, bool descending);
+
+    // Show the event of a listed row
+    void show_row(std::size_t position);
+
+  private:
+    //// TYPES ////
+
+    class Frame;
+
+    //// DATA ////
+
+    MCTruthViewerInterface& viewer_;
+    EventSummary summary_;
+    std::vector<std::size_t> order_;  //!< Sorted row positions
+    Frame* frame_{nullptr};
+};
@@ -7,51 +7,275 @@
 //---------------------------------------------------------------------------//
 #include "EventViewer.hh"
 
+#include <glob.h>
 #include <assert.h>
 #include <stdlib.h>
 
+#include "EnergyDepositMap.hh"
+#include "EvdCacheViewer.hh"
+#include "EventNavigator.hh"
+#include "EventSummary.hh"
+#include "EventTable.hh"
+#include "LoadMonitor.hh"
+#include "MultiFileViewer.hh"
+#include "Profiler.hh"
+#include "ProjectionMap.hh"
 #include "RSWViewer.hh"
 #include "RootDataViewer.hh"
+#include "SegmentQuery.hh"
+#include "ShowerNavigator.hh"
+#include "TimeSlider.hh"
 
 //---------------------------------------------------------------------------//
 /*!
- * Construct with ROOT input filename.
+ * Construct with ROOT input filenames or glob patterns.
+ *
+ * Events of multiple files are merged into a single list, and files are only
+ * opened once their events are needed.
  */
-EventViewer::EventViewer(std::string root_filename)
+EventViewer::EventViewer(std::vector<std::string> const& root_filenames)
 {
+    filenames_ = EventViewer::expand_inputs(root_filenames);
+    if (filenames_.size() == 1)
+    {
+        viewer_ = EventViewer::make_viewer(filenames_.front());
+        std::cout << "Simulation input: " << filenames_.front() << std::endl;
+        return;
+    }
+
+    std::cout << "Simulation input: " << filenames_.size() << " files"
+              << std::endl;
+    viewer_ = std::make_unique<MultiFileViewer>(
+        filenames_, [](std::string const& filename) {
+            return EventViewer::make_viewer(filename);
+        });
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Construct the concrete implementation that reads an input file.
+ *
+ * Files converted with \c evd-convert are detected by their header and read
+ * without ROOT I/O.
+ */
+std::unique_ptr<MCTruthViewerInterface>
+EventViewer::make_viewer(std::string const& filename)
+{
+    if (EvdCacheFile::is_cache_file(filename))
+    {
+        ScopedTimer timer("Event reader setup");
+        return std::make_unique<EvdCacheViewer>(filename);
+    }
+
     UPRootExtern<TFile> tfile;
-    tfile.reset(TFile::Open(root_filename.c_str(), "read"));
-    assert(tfile->IsOpen());
+    {
+        ScopedTimer timer("TFile::Open");
+        tfile.reset(TFile::Open(filename.c_str(), "read"));
+    }
+    if (!tfile || tfile->IsZombie())
+    {
+        std::cout << "[ERROR] Could not open " << filename << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    ScopedTimer timer("Event reader setup");
+    return EventViewer::make_viewer(std::move(tfile));
+}
 
+//---------------------------------------------------------------------------//
+/*!
+ * Construct the concrete implementation that reads an open input file.
+ */
+std::unique_ptr<MCTruthViewerInterface>
+EventViewer::make_viewer(UPRootExtern<TFile> tfile)
+{
+    std::unique_ptr<MCTruthViewerInterface> result;
     if (tfile->Get("events"))
     {
-        viewer_.reset(new RootDataViewer(std::move(tfile)));
+        result.reset(new RootDataViewer(std::move(tfile)));
     }
 
     else if (tfile->Get("steps"))
     {
-        viewer_.reset(new RSWViewer(std::move(tfile)));
+        result.reset(new RSWViewer(std::move(tfile)));
     }
 
     else
     {
-        std::cout << "[ERROR] " << root_filename << " has no known TTrees"
+        std::cout << "[ERROR] " << tfile->GetName() << " has no known TTrees"
                   << std::endl;
         exit(EXIT_FAILURE);
     }
+    return result;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Expand glob patterns into alphabetically sorted lists of existing files.
+ *
+ * Patterns are usually expanded by the shell, but quoted ones let the file
+ * list exceed the shell's argument limit. Arguments without wildcards are
+ * kept as is, and the order of the arguments is preserved.
+ */
+std::vector<std::string>
+EventViewer::expand_inputs(std::vector<std::string> const& patterns)
+{
+    std::vector<std::string> result;
+    for (auto const& pattern : patterns)
+    {
+        if (pattern.find_first_of("*?[") == std::string::npos)
+        {
+            result.push_back(pattern);
+            continue;
+        }
+
+        glob_t matches;
+        if (glob(pattern.c_str(), 0, nullptr, &matches) != 0)
+        {
+            std::cout << "[ERROR] No input file matches " << pattern
+                      << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        std::vector<std::string> files(matches.gl_pathv,
+                                       matches.gl_pathv + matches.gl_pathc);
+        globfree(&matches);
+        result.insert(result.end(), files.begin(), files.end());
+    }
+    assert(!result.empty());
+    return result;
+}
 
-    std::cout << "Simulation input: " << root_filename << std::endl;
+//---------------------------------------------------------------------------//
+/*!
+ * Stop the GUI controls before the background workers.
+ */
+EventViewer::~EventViewer()
+{
+    table_.reset();
+    time_slider_.reset();
+    showers_.reset();
+    query_.reset();
+    navigator_.reset();
+    monitor_.reset();
+    viewer_->stop_workers();
 }
 
 //---------------------------------------------------------------------------//
 /*!
- * Call concrete add event function.
+ * Call concrete add event function. Returns once all tracks are drawn.
  */
 void EventViewer::add_event(int const event_id)
 {
     viewer_->add_event(event_id);
 }
 
+//---------------------------------------------------------------------------//
+/*!
+ * Decode events in the background and add them to Eve from the GUI event
+ * loop, showing progress in the browser.
+ *
+ * When a single event is loaded, navigation controls to show other events are
+ * added to the browser as well, and so are query controls when segments are
+ * indexed, shower controls when track ancestry is indexed, a time slider
+ * when segments are sorted by time, and a sortable event list when the
+ * summary table is loaded.
+ *
+ * Projection histograms requested with \c load_projections are filled from
+ * the loaded events, on the threads that decode them.
+ */
+void EventViewer::start_loading(int const event_id)
+{
+    if (projections_)
+    {
+        projections_->begin(*viewer_);
+        viewer_->set_load_observer(
+            [map = projections_.get()](EventData const& event,
+                                       unsigned int thread_id) {
+                map->add(event, thread_id);
+            });
+    }
+    viewer_->start_loading(event_id);
+    monitor_ = std::make_unique<LoadMonitor>(*viewer_);
+    if (projections_)
+    {
+        monitor_->set_on_done([this] { this->finish_projections(); });
+    }
+    monitor_->TurnOn();
+    if (event_id >= 0)
+    {
+        navigator_ = std::make_unique<EventNavigator>(*viewer_);
+    }
+    if (segment_index_)
+    {
+        query_ = std::make_unique<SegmentQuery>(*viewer_);
+    }
+    if (track_trees_)
+    {
+        showers_ = std::make_unique<ShowerNavigator>(*viewer_);
+    }
+    if (time_window_)
+    {
+        time_slider_ = std::make_unique<TimeSlider>(*viewer_);
+    }
+    if (summary_)
+    {
+        table_ = std::make_unique<EventTable>(*viewer_, std::move(*summary_));
+        summary_.reset();
+    }
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Bin the energy deposited by all selected events and add the voxel map to
+ * Eve, without drawing any track. Returns once all events are binned.
+ */
+void EventViewer::draw_energy_map(EnergyDepositMap* map)
+{
+    assert(map);
+    map->fill(*viewer_);
+    map->draw();
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Histogram the steps of all selected events on the projection planes.
+ * Returns once all events are histogrammed; tracks can be loaded afterwards.
+ */
+void EventViewer::fill_projections(ProjectionMap* map)
+{
+    assert(map);
+    map->fill(*viewer_);
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Histogram the steps of the events loaded by \c start_loading on the
+ * projection planes, without scanning the input before the GUI starts.
+ *
+ * Once loading ends, including when it is cancelled, \c on_filled is called
+ * with the histograms on the GUI thread, e.g. to show them. Must be called
+ * before \c start_loading .
+ */
+void EventViewer::load_projections(
+    std::unique_ptr<ProjectionMap> map,
+    std::function<void(ProjectionMap const&)> on_filled)
+{
+    assert(map && on_filled && !monitor_);
+    projections_ = std::move(map);
+    on_projected_ = std::move(on_filled);
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Load the summary table of all selected events from its sidecar file, or
+ * build it in a single scan of the input. Returns once the table is loaded;
+ * it is listed in the browser when loading starts.
+ */
+void EventViewer::load_summary()
+{
+    summary_ = std::make_unique<EventSummary>(
+        EventSummary::load_or_build(*viewer_, filenames_, filter_));
+}
+
 //---------------------------------------------------------------------------//
 /*!
  * Show/hide step points along tracks.
@@ -60,3 +284,142 @@ void EventViewer::show_step_points(bool value)
 {
     viewer_->show_step_points(value);
 }
+
+//---------------------------------------------------------------------------//
+/*!
+ * Set number of threads used when all events are loaded.
+ */
+void EventViewer::set_num_threads(unsigned int value)
+{
+    viewer_->set_num_threads(value);
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Set track representation.
+ */
+void EventViewer::set_track_display(MCTruthViewerInterface::TrackDisplay value)
+{
+    viewer_->set_track_display(value);
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Set event and track selection, applied while reading the input.
+ */
+void EventViewer::set_filter(TrackFilter const& filter)
+{
+    viewer_->set_filter(filter);
+    filter_ = filter;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Simplify tracks, keeping a given number of detail levels. The coarsest
+ * level uses the given tolerance [cm].
+ */
+void EventViewer::set_simplification(double tolerance, int num_levels)
+{
+    viewer_->set_simplification(tolerance, num_levels);
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Keep loaded events in memory and index their segments, adding region query
+ * and clip box culling controls to the browser.
+ */
+void EventViewer::set_segment_index(bool value)
+{
+    segment_index_ = value;
+    viewer_->set_keep_events(segment_index_ || track_trees_ || time_window_);
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Keep loaded events in memory and index their track ancestry, adding shower
+ * isolation and collapsing controls to the browser.
+ */
+void EventViewer::set_track_trees(bool value)
+{
+    track_trees_ = value;
+    viewer_->set_decode_parents(value);
+    viewer_->set_keep_events(segment_index_ || track_trees_ || time_window_);
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Keep loaded events in memory and sort their segments by time, adding a
+ * time window slider to the browser.
+ */
+void EventViewer::set_time_window(bool value)
+{
+    time_window_ = value;
+    viewer_->set_decode_times(value);
+    viewer_->set_keep_events(segment_index_ || track_trees_ || time_window_);
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Redraw loaded tracks at a given detail level.
+ */
+void EventViewer::set_detail_level(int level)
+{
+    viewer_->set_detail_level(level);
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Set the memory limit [bytes] of the decoded event cache and the number of
+ * events decoded ahead of the current one.
+ */
+void EventViewer::set_event_cache(std::size_t max_bytes,
+                                  unsigned int num_prefetch)
+{
+    viewer_->set_event_cache(max_bytes, num_prefetch);
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Set maximum read-ahead cache size of each reader [bytes].
+ */
+void EventViewer::set_tree_cache_size(Long64_t max_bytes)
+{
+    viewer_->set_tree_cache_size(max_bytes);
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Replace the drawn event.
+ */
+bool EventViewer::show_event(int event_id)
+{
+    return viewer_->show_event(event_id);
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Show the next (positive) or previous (negative) event.
+ */
+bool EventViewer::step_event(int offset)
+{
+    return viewer_->step_event(offset);
+}
+
+//---------------------------------------------------------------------------//
+// PRIVATE
+//---------------------------------------------------------------------------//
+
+//---------------------------------------------------------------------------//
+/*!
+ * Sum the projection histograms once loading ends and pass them on.
+ *
+ * Tracks decoded afterwards, e.g. when navigating, are not histogrammed.
+ */
+void EventViewer::finish_projections()
+{
+    viewer_->set_load_observer(nullptr);
+    projections_->finish(*viewer_);
+    on_projected_(*projections_);
+    projections_.reset();
+    on_projected_ = nullptr;
+}
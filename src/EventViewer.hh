@@ -7,10 +7,23 @@
 //---------------------------------------------------------------------------//
 #pragma once
 
+#include <functional>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "MCTruthViewerInterface.hh"
+#include "RootUniquePtr.hh"
+
+class EnergyDepositMap;
+class EventNavigator;
+class EventSummary;
+class EventTable;
+class LoadMonitor;
+class ProjectionMap;
+class SegmentQuery;
+class ShowerNavigator;
+class TimeSlider;
 
 //---------------------------------------------------------------------------//
 /*!
@@ -23,15 +36,100 @@
 class EventViewer
 {
   public:
-    // Construct with ROOT input filename
-    EventViewer(std::string root_filename);
+    // Construct with ROOT input filenames or glob patterns
+    EventViewer(std::vector<std::string> const& root_filenames);
+
+    // Stop background loading and prefetching
+    ~EventViewer();
+
+    // Create the concrete viewer for an input file
+    static std::unique_ptr<MCTruthViewerInterface>
+    make_viewer(std::string const& filename);
+
+    // Create the concrete viewer for an open input file
+    static std::unique_ptr<MCTruthViewerInterface>
+    make_viewer(UPRootExtern<TFile> tfile);
+
+    // Expand glob patterns into sorted lists of existing files
+    static std::vector<std::string>
+    expand_inputs(std::vector<std::string> const& patterns);
 
     // Add event tracks
     void add_event(int event_id);
 
+    // Load event tracks in the background while the GUI is running
+    void start_loading(int event_id);
+
+    // Bin the energy deposited by selected events and draw it
+    void draw_energy_map(EnergyDepositMap* map);
+
+    // Histogram the steps of selected events on the projection planes
+    void fill_projections(ProjectionMap* map);
+
+    // Histogram the steps of the events loaded by start_loading
+    void load_projections(
+        std::unique_ptr<ProjectionMap> map,
+        std::function<void(ProjectionMap const&)> on_filled);
+
+    // Load or build the summary table of selected events
+    void load_summary();
+
     // Draw step points along track
     void show_step_points(bool value);
 
+    // Set number of threads used to load all events
+    void set_num_threads(unsigned int value);
+
+    // Draw tracks as individual lines or batched by species
+    void set_track_display(MCTruthViewerInterface::TrackDisplay value);
+
+    // Set event and track selection applied while reading
+    void set_filter(TrackFilter const& filter);
+
+    // Enable track simplification
+    void set_simplification(double tolerance, int num_levels);
+
+    // Index loaded segments for region queries and clip box culling
+    void set_segment_index(bool value);
+
+    // Index track ancestry for shower isolation and collapsing
+    void set_track_trees(bool value);
+
+    // Sort loaded segments by time for time window scrubbing
+    void set_time_window(bool value);
+
+    // Redraw loaded tracks at a given detail level
+    void set_detail_level(int level);
+
+    // Set decoded event cache size [bytes] and number of prefetched events
+    void set_event_cache(std::size_t max_bytes, unsigned int num_prefetch);
+
+    // Set maximum read-ahead cache size of each reader [bytes]
+    void set_tree_cache_size(Long64_t max_bytes);
+
+    // Replace the drawn event
+    bool show_event(int event_id);
+
+    // Show the next (positive) or previous (negative) event
+    bool step_event(int offset);
+
   private:
+    std::vector<std::string> filenames_;
+    TrackFilter filter_;
     std::unique_ptr<MCTruthViewerInterface> viewer_;
+    std::unique_ptr<LoadMonitor> monitor_;
+    std::unique_ptr<EventNavigator> navigator_;
+    std::unique_ptr<SegmentQuery> query_;
+    std::unique_ptr<ShowerNavigator> showers_;
+    std::unique_ptr<TimeSlider> time_slider_;
+    std::unique_ptr<EventSummary> summary_;
+    std::unique_ptr<EventTable> table_;
+    std::unique_ptr<ProjectionMap> projections_;
+    std::function<void(ProjectionMap const&)> on_projected_;
+    bool segment_index_{false};
+    bool track_trees_{false};
+    bool time_window_{false};
+
+    // Sum the projection histograms of a finished load and pass them on
+    void finish_projections();
 };
@@ -0,0 +1,702 @@
+//----------------------------------*-C++-*----------------------------------//
+// Copyright 2023 UT-Battelle, LLC, and other Celeritas developers.
+// See the top-level COPYRIGHT file for details.
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+//---------------------------------------------------------------------------//
+//! \file src/Expression.cc
+//---------------------------------------------------------------------------//
+#include "Expression.hh"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <assert.h>
+
+namespace
+{
+//---------------------------------------------------------------------------//
+// Maximum number of values on the evaluation stack
+constexpr std::size_t max_stack = 32;
+
+//---------------------------------------------------------------------------//
+// Track index used to evaluate event quantities
+constexpr std::size_t no_track = static_cast<std::size_t>(-1);
+
+//---------------------------------------------------------------------------//
+// Variable names and whether they describe a single track
+struct VariableName
+{
+    char const* name;
+    Expression::Variable variable;
+    bool track_only;
+};
+
+VariableName const variable_names[] = {
+    // clang-format off
+    {"event_id",      Expression::Variable::event_id,      false},
+    {"track_id",      Expression::Variable::track_id,      true},
+    {"pdg",           Expression::Variable::pdg,           true},
+    {"parent_id",     Expression::Variable::parent_id,     true},
+    {"primary",       Expression::Variable::primary,       true},
+    {"vertex_energy", Expression::Variable::vertex_energy, true},
+    {"length",        Expression::Variable::length,        true},
+    {"num_steps",     Expression::Variable::num_steps,     false},
+    {"energy_dep",    Expression::Variable::energy_dep,    false},
+    {"num_tracks",    Expression::Variable::num_tracks,    false}
+    // clang-format on
+};
+
+//---------------------------------------------------------------------------//
+// Sum a per-point array over a range of points; zero if it was not decoded
+double sum_points(std::vector<float> const& values,
+                  std::size_t first,
+                  std::size_t last)
+{
+    if (values.empty())
+    {
+        return 0;
+    }
+    double result = 0;
+    for (auto i = first; i < last; i++)
+    {
+        result += values[i];
+    }
+    return result;
+}
+
+//---------------------------------------------------------------------------//
+// Value of a per-track array; zero if it was not decoded
+template<class T>
+double track_value(std::vector<T> const& values, std::size_t track)
+{
+    return values.empty() ? 0 : values[track];
+}
+
+//---------------------------------------------------------------------------//
+}  // namespace
+
+//---------------------------------------------------------------------------//
+/*!
+ * Recursive descent parser emitting the postfix program of an expression.
+ */
+class Expression::Parser
+{
+  public:
+    // Parse from a position of the source, which is advanced
+    Parser(Expression* result, std::size_t* pos)
+        : result_(result), text_(result->source_), pos_(*pos)
+    {
+    }
+
+    // Parse a whole expression, up to the end of the source
+    void parse_all();
+
+    // Parse a function argument, up to its closing parenthesis
+    void parse_argument();
+
+  private:
+    Expression* result_;
+    std::string const& text_;
+    std::size_t& pos_;
+    std::size_t stack_size_{0};
+
+    void parse_or();
+    void parse_and();
+    void parse_comparison();
+    void parse_sum();
+    void parse_product();
+    void parse_unary();
+    void parse_primary();
+    void parse_function(std::string const& name);
+    void parse_variable(std::string const& name);
+
+    bool accept(char const* token);
+    void expect(char const* token);
+    void emit(Instruction instruction);
+    [[noreturn]] void fail(std::string const& message) const;
+};
+
+//---------------------------------------------------------------------------//
+/*!
+ * Compile an expression.
+ *
+ * Syntax errors and variables that are not available in the scope stop the
+ * program with an error message.
+ */
+Expression::Expression(std::string const& source, Scope scope)
+    : source_(source), scope_(scope)
+{
+    std::size_t pos = 0;
+    Parser(this, &pos).parse_all();
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Whether a variable is used, including inside functions.
+ */
+bool Expression::uses(Variable variable) const
+{
+    for (auto const& instruction : program_)
+    {
+        if (instruction.op == Op::variable
+            && instruction.variable == variable)
+        {
+            return true;
+        }
+    }
+    return std::any_of(arguments_.begin(),
+                       arguments_.end(),
+                       [variable](Expression const& argument) {
+                           return argument.uses(variable);
+                       });
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Whether a track of a decoded event passes a track expression.
+ */
+bool Expression::pass_track(EventData const& event, std::size_t track) const
+{
+    assert(scope_ == Scope::track);
+    assert(track < event.num_tracks());
+    return this->evaluate(event, track) != 0;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Whether a decoded event passes an event expression.
+ */
+bool Expression::pass_event(EventData const& event) const
+{
+    assert(scope_ == Scope::event);
+    return this->evaluate(event, no_track) != 0;
+}
+
+//---------------------------------------------------------------------------//
+// PRIVATE
+//---------------------------------------------------------------------------//
+
+//---------------------------------------------------------------------------//
+/*!
+ * Run the postfix program for a track, or for the event if the track is out
+ * of range.
+ */
+double Expression::evaluate(EventData const& event, std::size_t track) const
+{
+    double stack[max_stack];
+    std::size_t size = 0;
+    for (auto const& instruction : program_)
+    {
+        switch (instruction.op)
+        {
+            case Op::constant:
+                stack[size++] = instruction.value;
+                break;
+            case Op::variable:
+                stack[size++]
+                    = this->value(instruction.variable, event, track);
+                break;
+            case Op::sum:
+            case Op::min:
+            case Op::max:
+            case Op::count:
+                stack[size++] = Expression::aggregate(
+                    instruction.op, arguments_[instruction.argument], event);
+                break;
+            case Op::abs:
+                stack[size - 1] = std::fabs(stack[size - 1]);
+                break;
+            case Op::negate:
+                stack[size - 1] = -stack[size - 1];
+                break;
+            case Op::logical_not:
+                stack[size - 1] = (stack[size - 1] == 0);
+                break;
+            default:
+                --size;
+                stack[size - 1] = Expression::apply(
+                    instruction.op, stack[size - 1], stack[size]);
+        }
+    }
+    assert(size == 1);
+    return stack[0];
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Apply a binary operator. Comparisons and logical operators return 0 or 1.
+ */
+double Expression::apply(Op op, double lhs, double rhs)
+{
+    switch (op)
+    {
+        case Op::add:
+            return lhs + rhs;
+        case Op::subtract:
+            return lhs - rhs;
+        case Op::multiply:
+            return lhs * rhs;
+        case Op::divide:
+            return lhs / rhs;
+        case Op::equal:
+            return lhs == rhs;
+        case Op::not_equal:
+            return lhs != rhs;
+        case Op::less:
+            return lhs < rhs;
+        case Op::less_equal:
+            return lhs <= rhs;
+        case Op::greater:
+            return lhs > rhs;
+        case Op::greater_equal:
+            return lhs >= rhs;
+        case Op::logical_and:
+            return lhs != 0 && rhs != 0;
+        case Op::logical_or:
+            return lhs != 0 || rhs != 0;
+        default:
+            assert(false);
+            return 0;
+    }
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Value of a variable of a track, or of the whole event if the track is out
+ * of range.
+ */
+double Expression::value(Variable variable,
+                         EventData const& event,
+                         std::size_t track) const
+{
+    bool const is_track = track < event.num_tracks();
+    std::size_t const first = is_track ? event.offsets[track] : 0;
+    std::size_t const last = is_track ? event.offsets[track + 1]
+                                      : event.points.size();
+    switch (variable)
+    {
+        case Variable::event_id:
+            return event.id;
+        case Variable::track_id:
+            return event.track_ids[track];
+        case Variable::pdg:
+            return event.pdgs[track];
+        case Variable::parent_id:
+            return track_value(event.parent_ids, track);
+        case Variable::primary:
+            return track_value(event.parent_ids, track) < 0;
+        case Variable::vertex_energy:
+            return track_value(event.vertex_energies, track);
+        case Variable::length:
+            return track_value(event.lengths, track);
+        case Variable::num_steps:
+            if (is_track)
+            {
+                return last > first ? last - first - 1 : 0;
+            }
+            // Every track has its vertex and one point per step
+            return event.points.size()
+                   - std::min(event.points.size(), event.num_tracks());
+        case Variable::energy_dep:
+            return sum_points(event.energy_deposits, first, last);
+        case Variable::num_tracks:
+            return event.num_tracks();
+        default:
+            assert(false);
+            return 0;
+    }
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Combine the values of a track expression over all tracks of an event.
+ */
+double Expression::aggregate(Op op,
+                             Expression const& argument,
+                             EventData const& event)
+{
+    double result = 0;
+    for (std::size_t t = 0; t < event.num_tracks(); t++)
+    {
+        double const value = argument.evaluate(event, t);
+        switch (op)
+        {
+            case Op::sum:
+                result += value;
+                break;
+            case Op::count:
+                result += (value != 0);
+                break;
+            case Op::min:
+                result = (t == 0) ? value : std::min(result, value);
+                break;
+            case Op::max:
+                result = (t == 0) ? value : std::max(result, value);
+                break;
+            default:
+                assert(false);
+        }
+    }
+    return result;
+}
+
+//---------------------------------------------------------------------------//
+// PARSER
+//---------------------------------------------------------------------------//
+
+//---------------------------------------------------------------------------//
+/*!
+ * Parse a whole expression, up to the end of the source.
+ */
+void Expression::Parser::parse_all()
+{
+    this->parse_or();
+    if (pos_ < text_.size())
+    {
+        this->fail("unexpected '" + text_.substr(pos_) + "'");
+    }
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Parse a function argument, up to its closing parenthesis.
+ */
+void Expression::Parser::parse_argument()
+{
+    this->parse_or();
+    this->expect(")");
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Logical or of logical ands.
+ */
+void Expression::Parser::parse_or()
+{
+    this->parse_and();
+    while (this->accept("||"))
+    {
+        this->parse_and();
+        this->emit({Op::logical_or});
+    }
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Logical and of comparisons.
+ */
+void Expression::Parser::parse_and()
+{
+    this->parse_comparison();
+    while (this->accept("&&"))
+    {
+        this->parse_comparison();
+        this->emit({Op::logical_and});
+    }
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Comparison of sums. Two-character operators are matched first.
+ */
+void Expression::Parser::parse_comparison()
+{
+    this->parse_sum();
+    static std::pair<char const*, Op> const operators[] = {
+        {"==", Op::equal},
+        {"!=", Op::not_equal},
+        {"<=", Op::less_equal},
+        {">=", Op::greater_equal},
+        {"<", Op::less},
+        {">", Op::greater},
+    };
+    for (bool found = true; found;)
+    {
+        found = false;
+        for (auto const& token_op : operators)
+        {
+            if (this->accept(token_op.first))
+            {
+                this->parse_sum();
+                this->emit({token_op.second});
+                found = true;
+                break;
+            }
+        }
+    }
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Sum or difference of products.
+ */
+void Expression::Parser::parse_sum()
+{
+    this->parse_product();
+    while (true)
+    {
+        if (this->accept("+"))
+        {
+            this->parse_product();
+            this->emit({Op::add});
+        }
+        else if (this->accept("-"))
+        {
+            this->parse_product();
+            this->emit({Op::subtract});
+        }
+        else
+        {
+            return;
+        }
+    }
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Product or ratio of unary expressions.
+ */
+void Expression::Parser::parse_product()
+{
+    this->parse_unary();
+    while (true)
+    {
+        if (this->accept("*"))
+        {
+            this->parse_unary();
+            this->emit({Op::multiply});
+        }
+        else if (this->accept("/"))
+        {
+            this->parse_unary();
+            this->emit({Op::divide});
+        }
+        else
+        {
+            return;
+        }
+    }
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Negation or logical not of a unary expression, or a primary expression.
+ */
+void Expression::Parser::parse_unary()
+{
+    if (this->accept("-"))
+    {
+        this->parse_unary();
+        this->emit({Op::negate});
+    }
+    else if (text_.compare(pos_, 2, "!=") != 0 && this->accept("!"))
+    {
+        this->parse_unary();
+        this->emit({Op::logical_not});
+    }
+    else
+    {
+        this->parse_primary();
+    }
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Number, variable, function call, or parenthesized expression.
+ */
+void Expression::Parser::parse_primary()
+{
+    if (this->accept("("))
+    {
+        this->parse_or();
+        this->expect(")");
+        return;
+    }
+
+    char const* begin = text_.c_str() + pos_;
+    if (std::isdigit(static_cast<unsigned char>(*begin)) || *begin == '.')
+    {
+        char* end = nullptr;
+        double const value = std::strtod(begin, &end);
+        pos_ += end - begin;
+        Instruction instruction{Op::constant};
+        instruction.value = value;
+        this->emit(instruction);
+        return;
+    }
+
+    std::size_t end = pos_;
+    while (end < text_.size()
+           && (std::isalnum(static_cast<unsigned char>(text_[end]))
+               || text_[end] == '_'))
+    {
+        ++end;
+    }
+    if (end == pos_ || std::isdigit(static_cast<unsigned char>(text_[pos_])))
+    {
+        this->fail(pos_ < text_.size()
+                       ? "unexpected '" + text_.substr(pos_) + "'"
+                       : "unexpected end of expression");
+    }
+    std::string const name = text_.substr(pos_, end - pos_);
+    pos_ = end;
+    if (this->accept("("))
+    {
+        this->parse_function(name);
+    }
+    else
+    {
+        this->parse_variable(name);
+    }
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Function call, after its opening parenthesis.
+ *
+ * The argument of \c abs is compiled inline. The argument of the functions
+ * over tracks is compiled into a separate track expression.
+ */
+void Expression::Parser::parse_function(std::string const& name)
+{
+    if (name == "abs")
+    {
+        this->parse_argument();
+        this->emit({Op::abs});
+        return;
+    }
+
+    static std::pair<char const*, Op> const functions[] = {
+        {"sum", Op::sum},
+        {"min", Op::min},
+        {"max", Op::max},
+        {"count", Op::count},
+    };
+    auto iter = std::find_if(
+        std::begin(functions), std::end(functions), [&name](auto const& f) {
+            return name == f.first;
+        });
+    if (iter == std::end(functions))
+    {
+        this->fail("unknown function '" + name + "'");
+    }
+    if (result_->scope_ != Scope::event)
+    {
+        this->fail("'" + name + "' is only available in event selections");
+    }
+
+    Expression argument;
+    argument.source_ = text_;
+    argument.scope_ = Scope::track;
+    auto const begin = pos_;
+    Parser(&argument, &pos_).parse_argument();
+    argument.source_ = text_.substr(begin, pos_ - begin - 1);
+
+    Instruction instruction{iter->second};
+    instruction.argument = result_->arguments_.size();
+    result_->arguments_.push_back(std::move(argument));
+    this->emit(instruction);
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Variable available in the scope of the expression.
+ */
+void Expression::Parser::parse_variable(std::string const& name)
+{
+    auto iter = std::find_if(std::begin(variable_names),
+                             std::end(variable_names),
+                             [&name](VariableName const& v) {
+                                 return name == v.name;
+                             });
+    if (iter == std::end(variable_names))
+    {
+        this->fail("unknown variable '" + name + "'");
+    }
+    if (iter->track_only && result_->scope_ == Scope::event)
+    {
+        this->fail("'" + name
+                   + "' is a track variable; use it in sum, min, max, or "
+                     "count");
+    }
+
+    Instruction instruction{Op::variable};
+    instruction.variable = iter->variable;
+    this->emit(instruction);
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Skip whitespace and consume a token if it comes next.
+ */
+bool Expression::Parser::accept(char const* token)
+{
+    while (pos_ < text_.size()
+           && std::isspace(static_cast<unsigned char>(text_[pos_])))
+    {
+        ++pos_;
+    }
+    auto const length = std::strlen(token);
+    if (text_.compare(pos_, length, token) != 0)
+    {
+        return false;
+    }
+    pos_ += length;
+    return true;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Consume a token, failing if it does not come next.
+ */
+void Expression::Parser::expect(char const* token)
+{
+    if (!this->accept(token))
+    {
+        this->fail(std::string("expected '") + token + "'");
+    }
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Append an instruction, keeping track of the evaluation stack size.
+ */
+void Expression::Parser::emit(Instruction instruction)
+{
+    switch (instruction.op)
+    {
+        case Op::constant:
+        case Op::variable:
+        case Op::sum:
+        case Op::min:
+        case Op::max:
+        case Op::count:
+            ++stack_size_;
+            break;
+        case Op::abs:
+        case Op::negate:
+        case Op::logical_not:
+            break;
+        default:
+            --stack_size_;
+    }
+    if (stack_size_ > max_stack)
+    {
+        this->fail("expression is too deeply nested");
+    }
+    result_->program_.push_back(instruction);
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Stop with an error message pointing at the current position.
+ */
+void Expression::Parser::fail(std::string const& message) const
+{
+    std::cout << "[ERROR] Invalid expression \"" << text_
+              << "\": " << message << " at position " << pos_ << std::endl;
+    exit(EXIT_FAILURE);
+}
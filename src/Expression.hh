@@ -0,0 +1,151 @@
+//----------------------------------*-C++-*----------------------------------//
+// Copyright 2023 UT-Battelle, LLC, and other Celeritas developers.
+// See the top-level COPYRIGHT file for details.
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+//---------------------------------------------------------------------------//
+//! \file src/Expression.hh
+//---------------------------------------------------------------------------//
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "EventData.hh"
+
+//---------------------------------------------------------------------------//
+/*!
+ * Selection expression over the tracks or events of decoded events.
+ *
+ * Expressions are parsed once into a postfix program, which is evaluated on
+ * a fixed-size stack without allocating, so that a single expression can be
+ * evaluated concurrently on worker threads. Supported syntax, with C
+ * precedence:
+ * - numbers (\c 1000 , \c 1e-3 ) and variables
+ * - \c || , \c && , \c ! , \c == , \c != , \c < , \c <= , \c > , \c >=
+ * - \c + , \c - , \c * , \c / , unary \c - , and parentheses
+ * - \c abs(x)
+ * - for events only, \c sum(x) , \c min(x) , \c max(x) , and \c count(x)
+ *   over the tracks of the event, where \c x is a track expression; \c count
+ *   is the number of tracks for which \c x is nonzero, and the others are
+ *   zero for events without tracks.
+ *
+ * Track variables are \c event_id , \c track_id , \c pdg , \c parent_id ,
+ * \c primary , \c vertex_energy [MeV], \c length [cm], \c num_steps , and
+ * \c energy_dep [MeV]. Event variables are \c event_id , \c num_tracks ,
+ * \c num_steps , and \c energy_dep . Attributes that were not decoded are
+ * zero; \c uses tells which ones must be.
+ *
+ * \code
+ *  Expression select("pdg == 13 && vertex_energy > 1000",
+ *                    Expression::Scope::track);
+ *  bool passed = select.pass_track(event, 0);
+ * \endcode
+ */
+class Expression
+{
+  public:
+    //! Whether an expression applies to single tracks or whole events
+    enum class Scope
+    {
+        track,
+        event
+    };
+
+    //! Quantities of a decoded track or event
+    enum class Variable
+    {
+        event_id,
+        track_id,
+        pdg,
+        parent_id,
+        primary,
+        vertex_energy,
+        length,
+        num_steps,
+        energy_dep,
+        num_tracks
+    };
+
+    //! Construct an empty expression, which is not evaluated
+    Expression() = default;
+
+    // Compile an expression, stopping on syntax errors
+    Expression(std::string const& source, Scope scope);
+
+    //! Whether an expression was compiled
+    explicit operator bool() const { return !program_.empty(); }
+
+    //! Source text
+    std::string const& source() const { return source_; }
+
+    // Whether a variable is used, including inside functions
+    bool uses(Variable variable) const;
+
+    // Whether a track of a decoded event passes a track expression
+    bool pass_track(EventData const& event, std::size_t track) const;
+
+    // Whether a decoded event passes an event expression
+    bool pass_event(EventData const& event) const;
+
+  private:
+    //// TYPES ////
+
+    enum class Op
+    {
+        constant,
+        variable,
+        sum,
+        min,
+        max,
+        count,
+        abs,
+        negate,
+        logical_not,
+        add,
+        subtract,
+        multiply,
+        divide,
+        equal,
+        not_equal,
+        less,
+        less_equal,
+        greater,
+        greater_equal,
+        logical_and,
+        logical_or
+    };
+
+    struct Instruction
+    {
+        Op op;
+        double value{0};  //!< Constant
+        Variable variable{Variable::event_id};
+        std::size_t argument{0};  //!< Track expression of a function
+    };
+
+    class Parser;
+
+    //// DATA ////
+
+    std::string source_;
+    Scope scope_{Scope::track};
+    std::vector<Instruction> program_;
+    std::vector<Expression> arguments_;  //!< Track expressions of functions
+
+    //// HELPER FUNCTIONS ////
+
+    // Evaluate for a track, or for the event if the track is out of range
+    double evaluate(EventData const& event, std::size_t track) const;
+
+    // Apply a binary operator
+    static double apply(Op op, double lhs, double rhs);
+
+    // Value of a variable of a track, or of the event
+    double value(Variable variable,
+                 EventData const& event,
+                 std::size_t track) const;
+
+    // Combine the values of a track expression over all tracks
+    static double
+    aggregate(Op op, Expression const& argument, EventData const& event);
+};
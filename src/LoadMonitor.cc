@@ -0,0 +1,219 @@
+//----------------------------------*-C++-*----------------------------------//
+// Copyright 2023 UT-Battelle, LLC, and other Celeritas developers.
+// See the top-level COPYRIGHT file for details.
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+//---------------------------------------------------------------------------//
+//! \file src/LoadMonitor.cc
+//---------------------------------------------------------------------------//
+#include "LoadMonitor.hh"
+
+#include <algorithm>
+#include <string>
+#include <TEveBrowser.h>
+#include <TEveManager.h>
+#include <TGButton.h>
+#include <TGClient.h>
+#include <TGFrame.h>
+#include <TGLabel.h>
+#include <TGLayout.h>
+#include <TGProgressBar.h>
+#include <WidgetMessageTypes.h>
+
+namespace
+{
+//---------------------------------------------------------------------------//
+// Timer period [ms]
+constexpr Long_t timer_period = 100;
+// Time spent adding events to Eve per timer tick [ms]
+constexpr double draw_budget = 50;
+// Minimum time between incremental redraws
+constexpr std::chrono::milliseconds redraw_period{1000};
+//---------------------------------------------------------------------------//
+}  // namespace
+
+//---------------------------------------------------------------------------//
+/*!
+ * Progress bar and cancel button, embedded in the browser.
+ *
+ * Button clicks are received through \c ProcessMessage , which does not
+ * require a dictionary for this class.
+ */
+class LoadMonitor::Frame final : public TGMainFrame
+{
+  public:
+    // Construct in the window currently being embedded
+    explicit Frame(LoadMonitor* monitor);
+
+    // Show loading progress
+    void update(MCTruthViewerInterface::LoadProgress const& progress);
+
+    //! Stop forwarding button clicks
+    void detach() { monitor_ = nullptr; }
+
+    // Handle cancel button
+    Bool_t ProcessMessage(Longptr_t msg, Longptr_t parm1, Longptr_t) final;
+
+  private:
+    enum
+    {
+        cancel_id = 1
+    };
+
+    LoadMonitor* monitor_;
+    TGLabel* label_;
+    TGHProgressBar* bar_;
+    TGTextButton* cancel_;
+};
+
+//---------------------------------------------------------------------------//
+/*!
+ * Construct and add the progress frame to the browser.
+ */
+LoadMonitor::LoadMonitor(MCTruthViewerInterface& viewer)
+    : TTimer(timer_period), viewer_(viewer), last_redraw_(Clock::now())
+{
+    auto* browser = gEve->GetBrowser();
+    browser->StartEmbedding(TRootBrowser::kLeft);
+    frame_ = new Frame(this);
+    browser->StopEmbedding("Loading");
+    frame_->update(viewer_.load_progress());
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * The frame is owned by the browser and may outlive the monitor.
+ */
+LoadMonitor::~LoadMonitor()
+{
+    frame_->detach();
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Call a function on the GUI thread once loading ends, including when it is
+ * cancelled, before the viewers are redrawn. It is called at most once.
+ */
+void LoadMonitor::set_on_done(std::function<void()> func)
+{
+    on_done_ = std::move(func);
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Draw loaded events and update progress.
+ *
+ * The timer is turned off once all events are drawn or loading is cancelled.
+ */
+Bool_t LoadMonitor::Notify()
+{
+    auto const num_drawn = viewer_.draw_loaded(draw_budget);
+    auto const progress = viewer_.load_progress();
+    frame_->update(progress);
+
+    if (progress.done && on_done_)
+    {
+        auto on_done = std::move(on_done_);
+        on_done_ = nullptr;
+        on_done();
+    }
+
+    auto const now = Clock::now();
+    if (progress.done || (num_drawn > 0 && now - last_redraw_ > redraw_period))
+    {
+        // Only redraw changed scenes, keeping the current camera
+        gEve->Redraw3D();
+        last_redraw_ = now;
+    }
+
+    if (progress.done)
+    {
+        this->TurnOff();
+    }
+    else
+    {
+        this->Reset();
+    }
+    return kTRUE;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Stop loading. Events that are already drawn stay in the viewer.
+ */
+void LoadMonitor::cancel()
+{
+    viewer_.cancel_loading();
+    this->Notify();
+}
+
+//---------------------------------------------------------------------------//
+// FRAME
+//---------------------------------------------------------------------------//
+
+//---------------------------------------------------------------------------//
+/*!
+ * Construct in the window currently being embedded.
+ */
+LoadMonitor::Frame::Frame(LoadMonitor* monitor)
+    : TGMainFrame(gClient->GetRoot(), 300, 100), monitor_(monitor)
+{
+    this->SetCleanup(kDeepCleanup);
+    auto* group = new TGGroupFrame(this, "Events");
+
+    label_ = new TGLabel(group, "Waiting for events...");
+    bar_ = new TGHProgressBar(group, TGProgressBar::kFancy, 250);
+    bar_->ShowPosition(kTRUE, kFALSE, "%.0f drawn");
+    cancel_ = new TGTextButton(group, "Cancel", cancel_id);
+    cancel_->Associate(this);
+
+    group->AddFrame(label_, new TGLayoutHints(kLHintsExpandX, 2, 2, 4, 2));
+    group->AddFrame(bar_, new TGLayoutHints(kLHintsExpandX, 2, 2, 2, 2));
+    group->AddFrame(cancel_, new TGLayoutHints(kLHintsRight, 2, 2, 2, 4));
+    this->AddFrame(group, new TGLayoutHints(kLHintsExpandX, 4, 4, 4, 4));
+
+    this->MapSubwindows();
+    this->Resize(this->GetDefaultSize());
+    this->MapWindow();
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Show loading progress.
+ */
+void LoadMonitor::Frame::update(
+    MCTruthViewerInterface::LoadProgress const& progress)
+{
+    std::string text;
+    if (progress.cancelled)
+    {
+        text = "Cancelled: ";
+    }
+    else if (progress.done)
+    {
+        text = "Done: ";
+    }
+    text += std::to_string(progress.num_drawn) + " of "
+            + std::to_string(progress.num_events) + " events ("
+            + std::to_string(progress.num_decoded) + " decoded)";
+    label_->SetText(text.c_str());
+
+    bar_->SetRange(0, std::max<std::size_t>(progress.num_events, 1));
+    bar_->SetPosition(progress.num_drawn);
+    cancel_->SetEnabled(!progress.done);
+    this->Layout();
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Cancel loading when the button is clicked.
+ */
+Bool_t
+LoadMonitor::Frame::ProcessMessage(Longptr_t msg, Longptr_t parm1, Longptr_t)
+{
+    if (GET_MSG(msg) == kC_COMMAND && GET_SUBMSG(msg) == kCM_BUTTON
+        && parm1 == cancel_id && monitor_)
+    {
+        monitor_->cancel();
+    }
+    return kTRUE;
+}
@@ -0,0 +1,63 @@
+//----------------------------------*-C++-*----------------------------------//
+// Copyright 2023 UT-Battelle, LLC, and other Celeritas developers.
+// See the top-level COPYRIGHT file for details.
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+//---------------------------------------------------------------------------//
+//! \file src/LoadMonitor.hh
+//---------------------------------------------------------------------------//
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <TTimer.h>
+
+#include "MCTruthViewerInterface.hh"
+
+//---------------------------------------------------------------------------//
+/*!
+ * Draw events loaded in the background from the GUI event loop.
+ *
+ * On every timer tick, decoded events are added to Eve for a limited time so
+ * that the GUI stays responsive. The viewers are redrawn incrementally at a
+ * lower rate and once more when loading ends. Progress is shown in a
+ * \c Loading tab of the browser, which also allows to cancel loading. A
+ * function can be called on the GUI thread once loading ends, before the
+ * final redraw, e.g. to show results accumulated while loading.
+ *
+ * \code
+ *  viewer.start_loading(-1);
+ *  LoadMonitor monitor(viewer);
+ *  monitor.TurnOn();
+ * \endcode
+ */
+class LoadMonitor : public TTimer
+{
+  public:
+    // Construct and add the progress frame to the browser
+    explicit LoadMonitor(MCTruthViewerInterface& viewer);
+
+    // Detach from the progress frame owned by the browser
+    ~LoadMonitor();
+
+    // Call a function once loading ends, including when it is cancelled
+    void set_on_done(std::function<void()> func);
+
+    // Draw loaded events and update progress
+    Bool_t Notify() final;
+
+    // Stop loading
+    void cancel();
+
+  private:
+    //// TYPES ////
+
+    class Frame;
+    using Clock = std::chrono::steady_clock;
+
+    //// DATA ////
+
+    MCTruthViewerInterface& viewer_;
+    Frame* frame_{nullptr};
+    Clock::time_point last_redraw_;
+    std::function<void()> on_done_;
+};
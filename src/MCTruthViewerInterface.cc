@@ -7,6 +7,453 @@
 //---------------------------------------------------------------------------//
 #include "MCTruthViewerInterface.hh"
 
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <type_traits>
+#include <TEveEventManager.h>
+#include <TEveManager.h>
+#include <assert.h>
+#include <stdlib.h>
+
+#include "EventLoader.hh"
+#include "EventSelection.hh"
+#include "Profiler.hh"
+
+namespace
+{
+//---------------------------------------------------------------------------//
+using Clock = std::chrono::steady_clock;
+using Milliseconds = std::chrono::duration<double, std::milli>;
+using Seconds = std::chrono::duration<double>;
+using Nanoseconds = std::chrono::nanoseconds;
+//---------------------------------------------------------------------------//
+}  // namespace
+
+//---------------------------------------------------------------------------//
+/*!
+ * Construct the background loader and the event selection, which decode
+ * events with the readers of the concrete class.
+ */
+MCTruthViewerInterface::MCTruthViewerInterface()
+    : loader_(std::make_unique<EventLoader>(
+        [this] { return this->make_reader(); },
+        [this](EventReader& reader, int event_id) {
+            return this->decode(reader, event_id);
+        }))
+    , selection_(std::make_unique<EventSelection>(*this))
+{
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Check that no background work is running.
+ */
+MCTruthViewerInterface::~MCTruthViewerInterface()
+{
+    assert(!loader_->running() && !selection_->prefetching());
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Add a single event to Eve or, if \c event_id is negative, all events.
+ *
+ * Events are decoded by the background loader while the calling thread adds
+ * them to Eve, and this function returns once all of them are drawn.
+ */
+void MCTruthViewerInterface::add_event(int const event_id)
+{
+    this->start_loading(event_id);
+    while (loader_->running())
+    {
+        loader_->wait();
+        this->draw_loaded(std::numeric_limits<double>::infinity());
+    }
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Start decoding a single event or, if \c event_id is negative, all events
+ * on a background thread.
+ *
+ * A single event is also added to the event cache, and its neighbors are
+ * prefetched so that the viewer can move to them quickly.
+ *
+ * All events are decoded in chunks by per-thread readers, see
+ * \c EventLoader::decode_chunks .
+ */
+void MCTruthViewerInterface::start_loading(int const event_id)
+{
+    assert(!loader_->running());
+    std::vector<int> ids;
+
+    if (event_id >= 0)
+    {
+        if (!this->has_event(event_id))
+        {
+            auto const available = this->event_ids();
+            std::cout << "[ERROR] event id " << event_id
+                      << " is not available. Last event id is "
+                      << (available.empty() ? -1 : available.back())
+                      << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        if (!selection_->passes(event_id))
+        {
+            std::cout << "[ERROR] event id " << event_id
+                      << " does not pass the event selection" << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        ids = {event_id};
+
+        // Start decoding neighbors along with the requested event
+        selection_->set_current(event_id);
+    }
+    else
+    {
+        // Apply event selection before reading anything
+        ids = selection_->ids();
+        selection_->set_current(-1);
+    }
+
+    num_drawn_ = 0;
+    bool const single_event = (event_id >= 0);
+    auto const num_events = ids.size();
+    loader_->start(num_events, [this, ids = std::move(ids), single_event] {
+        this->load(ids, single_event);
+    });
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Add queued events to Eve until the queue is empty or \c max_time [ms] has
+ * passed. Returns the number of events drawn.
+ *
+ * This must be called from the thread that owns Eve. Once the loader has
+ * finished and all of its events are drawn, the loader thread is joined.
+ */
+std::size_t MCTruthViewerInterface::draw_loaded(double const max_time)
+{
+    auto const start = Clock::now();
+
+    std::size_t result = 0;
+    EventData event;
+    while (loader_->pop(&event))
+    {
+        this->add_decoded_event(std::move(event));
+        ++num_drawn_;
+        ++result;
+
+        if (Milliseconds(Clock::now() - start).count() >= max_time)
+        {
+            break;
+        }
+    }
+
+    if (loader_->join_finished())
+    {
+        std::cout << "Loaded " << num_drawn_ << " of " << loader_->num_events()
+                  << " events" << std::endl;
+        this->print_simplification();
+        this->print_cache_stats();
+    }
+    return result;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Stop decoding events and discard the ones that are not drawn yet.
+ *
+ * Worker threads finish the event they are decoding, so this returns after at
+ * most one event per thread has been read.
+ */
+void MCTruthViewerInterface::cancel_loading()
+{
+    if (!loader_->cancel())
+    {
+        return;
+    }
+
+    std::cout << "Loading cancelled after " << num_drawn_ << " of "
+              << loader_->num_events() << " events" << std::endl;
+    this->print_simplification();
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Whether an event is available in the input.
+ *
+ * Implementations that index their input lazily can override this to avoid
+ * listing all events.
+ */
+bool MCTruthViewerInterface::has_event(int event_id)
+{
+    auto const ids = this->event_ids();
+    return std::binary_search(ids.begin(), ids.end(), event_id);
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Up to \c count available event ids following \c event_id or, if \c count
+ * is negative, up to \c -count ids preceding it, nearest first.
+ *
+ * The event itself does not need to be available. Implementations that index
+ * their input lazily can override this to avoid listing all events.
+ */
+std::vector<int> MCTruthViewerInterface::neighbor_ids(int event_id, int count)
+{
+    auto const ids = this->event_ids();
+    std::vector<int> result;
+    if (count > 0)
+    {
+        auto iter = std::upper_bound(ids.begin(), ids.end(), event_id);
+        for (; iter != ids.end() && static_cast<int>(result.size()) < count;
+             ++iter)
+        {
+            result.push_back(*iter);
+        }
+    }
+    else
+    {
+        auto iter = std::lower_bound(ids.begin(), ids.end(), event_id);
+        for (; iter != ids.begin() && static_cast<int>(result.size()) < -count;)
+        {
+            result.push_back(*--iter);
+        }
+    }
+    return result;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Progress of the background load.
+ */
+auto MCTruthViewerInterface::load_progress() const -> LoadProgress
+{
+    LoadProgress result;
+    result.num_events = loader_->num_events();
+    result.num_decoded = loader_->num_decoded();
+    result.num_drawn = num_drawn_;
+    result.cancelled = loader_->cancelled();
+    result.done = !loader_->running();
+    return result;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Number of events, tracks, and steps drawn so far, and time spent decoding
+ * and constructing tracks.
+ */
+auto MCTruthViewerInterface::load_stats() const -> LoadStats
+{
+    LoadStats result = stats_;
+    result.decode_time = Seconds(Nanoseconds(decode_ns_.load())).count();
+    result.cache = loader_->cache_stats();
+    return result;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Set the memory limit [bytes] of the decoded event cache, and the number of
+ * events after the current one that are decoded ahead of time.
+ */
+void MCTruthViewerInterface::set_event_cache(std::size_t max_bytes,
+                                             unsigned int num_prefetch)
+{
+    selection_->set_cache(max_bytes, num_prefetch);
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Set the maximum size [bytes] of the read-ahead cache of each reader; zero
+ * disables it. This must be set before events are read.
+ */
+void MCTruthViewerInterface::set_tree_cache_size(Long64_t max_bytes)
+{
+    tree_cache_size_ = max_bytes;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Decode the parent, vertex energy and length of every track, and flag its
+ * interaction points, even if they are not needed for drawing.
+ */
+void MCTruthViewerInterface::set_decode_attributes(bool value)
+{
+    decode_attributes_ = value;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Decode the energy deposited along each step, even if it is not needed for
+ * drawing.
+ */
+void MCTruthViewerInterface::set_decode_energy_deposition(bool value)
+{
+    decode_energy_deposition_ = value;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Decode the parent id of every track, even if it is not needed for drawing,
+ * e.g. to index the ancestry of drawn tracks.
+ */
+void MCTruthViewerInterface::set_decode_parents(bool value)
+{
+    decode_parents_ = value;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Decode the global time of every step point, even if it is not needed for
+ * drawing, e.g. to sort drawn segments by time.
+ */
+void MCTruthViewerInterface::set_decode_times(bool value)
+{
+    decode_times_ = value;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Pass each event decoded by \c start_loading to a function, along with the
+ * id of the thread that decoded it, before it is queued for drawing.
+ *
+ * The function is called on the worker threads, with thread ids smaller than
+ * the number of threads, so that it can accumulate results in per-thread
+ * state without locking. An empty function stops observing loads. This must
+ * not be changed while a background load is in progress.
+ */
+void MCTruthViewerInterface::set_load_observer(
+    std::function<void(EventData const&, unsigned int)> func)
+{
+    assert(!loader_->running());
+    load_observer_ = std::move(func);
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Decode all selected events without drawing them.
+ *
+ * Events are decoded on worker threads and passed to \c func on the calling
+ * thread, in order of increasing event id.
+ */
+void MCTruthViewerInterface::for_each_event(
+    std::function<void(EventData const&)> const& func)
+{
+    auto const& ids = selection_->ids();
+    loader_->reset(ids.size());
+    loader_->decode_chunks(ids,
+                           num_threads_,
+                           [&func](std::vector<EventData> events) {
+                               for (auto const& event : events)
+                               {
+                                   func(event);
+                               }
+                           });
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Decode all selected events without drawing or keeping them.
+ *
+ * Each event is passed to \c func on the worker thread that decoded it, along
+ * with the thread id, in no particular order. Thread ids are smaller than the
+ * number of threads, so that \c func can accumulate results in per-thread
+ * state without locking. At most one event per thread is in memory.
+ */
+void MCTruthViewerInterface::scan_events(
+    std::function<void(EventData const&, unsigned int)> const& func)
+{
+    assert(!loader_->running());
+    loader_->scan(selection_->ids(),
+                  num_threads_,
+                  [&func](std::size_t, EventData const& event,
+                          unsigned int thread_id) { func(event, thread_id); });
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Replace the drawn tracks with those of another event.
+ *
+ * Any background load is cancelled first. Returns false, keeping the current
+ * tracks, if the event is not available.
+ */
+bool MCTruthViewerInterface::show_event(int const event_id)
+{
+    if (event_id < 0 || !this->has_event(event_id))
+    {
+        std::cout << "[WARNING] event id " << event_id
+                  << " is not available" << std::endl;
+        return false;
+    }
+    if (!selection_->passes(event_id))
+    {
+        std::cout << "[WARNING] event id " << event_id
+                  << " does not pass the event selection" << std::endl;
+        return false;
+    }
+
+    auto const start = Clock::now();
+
+    this->cancel_loading();
+    bool from_cache = false;
+    auto const event = selection_->cached_event(event_id, &from_cache);
+
+    this->clear_events();
+    this->draw_event(*event);
+    if (this->keeps_events())
+    {
+        this->keep_event(*event);
+    }
+    selection_->set_current(event_id);
+    gEve->Redraw3D();
+
+    std::cout << "Event " << event_id << ": " << event->num_tracks()
+              << " tracks " << (from_cache ? "from cache" : "decoded")
+              << " and drawn in " << Milliseconds(Clock::now() - start).count()
+              << " ms" << std::endl;
+    return true;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Show the next (positive offset) or previous (negative offset) event that
+ * passes the event selection.
+ */
+bool MCTruthViewerInterface::step_event(int const offset)
+{
+    int const event_id = selection_->step(offset);
+    if (event_id < 0)
+    {
+        std::cout << "[WARNING] no " << (offset > 0 ? "next" : "previous")
+                  << " event" << std::endl;
+        return false;
+    }
+    return this->show_event(event_id);
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Event currently shown; negative if all events are drawn.
+ */
+int MCTruthViewerInterface::current_event() const
+{
+    return selection_->current();
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Stop background loading and prefetching.
+ */
+void MCTruthViewerInterface::stop_workers()
+{
+    this->cancel_loading();
+    selection_->stop();
+}
+
 //---------------------------------------------------------------------------//
 /*!
  * Draw each step point along the track.
@@ -16,6 +463,207 @@ void MCTruthViewerInterface::show_step_points(bool value)
     step_points_ = value;
 }
 
+//---------------------------------------------------------------------------//
+/*!
+ * Set number of threads used to decode events when all events are drawn.
+ */
+void MCTruthViewerInterface::set_num_threads(unsigned int value)
+{
+    assert(value > 0);
+    num_threads_ = value;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Set whether tracks are drawn as individual lines or batched by species.
+ */
+void MCTruthViewerInterface::set_track_display(TrackDisplay value)
+{
+    track_display_ = value;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Set event and track selection applied while reading.
+ */
+void MCTruthViewerInterface::set_filter(TrackFilter const& filter)
+{
+    filter_ = filter;
+    selection_->reset();
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Enable track simplification with the given coarsest tolerance [cm] and
+ * number of detail levels.
+ *
+ * Decoded events are kept in memory so that the detail level can be changed
+ * without reading the input again. Tracks are initially drawn at the coarsest
+ * level.
+ */
+void MCTruthViewerInterface::set_simplification(double tolerance,
+                                                int num_levels)
+{
+    simplifier_ = std::make_unique<TrackSimplifier>(tolerance, num_levels);
+    detail_level_ = 0;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Redraw all loaded tracks at a different detail level.
+ */
+void MCTruthViewerInterface::set_detail_level(int level)
+{
+    if (!simplifier_ || level == detail_level_)
+    {
+        return;
+    }
+    assert(level >= 0 && level < simplifier_->num_levels());
+    detail_level_ = level;
+
+    // Destroy current track elements and draw again from decoded data
+    this->redraw();
+    this->print_simplification();
+    gEve->Redraw3D();
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Number of detail levels; 1 if simplification is disabled.
+ */
+int MCTruthViewerInterface::num_detail_levels() const
+{
+    return simplifier_ ? simplifier_->num_levels() : 1;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Keep drawn events in memory, so that GUI controls can query them and draw
+ * them again.
+ */
+void MCTruthViewerInterface::set_keep_events(bool value)
+{
+    keep_events_ = value;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Destroy drawn tracks and draw the visible tracks of the kept events.
+ *
+ * Segment sets added by GUI controls are destroyed as well. Eve is not
+ * redrawn: callers must call \c gEve->Redraw3D afterwards.
+ */
+void MCTruthViewerInterface::redraw()
+{
+    this->destroy_tracks();
+    for (std::size_t e = 0; e < drawn_events_.size(); e++)
+    {
+        auto const& visible = visible_[e];
+        this->draw_event(drawn_events_[e],
+                         visible.empty() ? nullptr : &visible);
+    }
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Destroy the track elements drawn from the kept events, including segment
+ * sets added with \c add_segment_set .
+ */
+void MCTruthViewerInterface::destroy_tracks()
+{
+    for (auto* element : elements_)
+    {
+        element->Destroy();
+    }
+    elements_.clear();
+    lines_.clear();
+    run_segments_.clear();
+    total_points_ = drawn_points_ = 0;
+    ++tracks_revision_;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Add an empty segment set for the tracks of a species to Eve.
+ *
+ * The set is colored like the tracks of the species and destroyed along with
+ * the other drawn tracks, e.g. by \c redraw .
+ */
+TrackSegmentSet*
+MCTruthViewerInterface::add_segment_set(PDG species, std::string const& name)
+{
+    auto* result = new TrackSegmentSet(name.c_str());
+    result->SetLineColor(color(species));
+    result->SetMarkerColor(color(species));
+    gEve->AddElement(result);
+    Profiler::add(Profiler::Counter::elements_added, 1);
+    if (this->keeps_events())
+    {
+        elements_.push_back(result);
+    }
+    return result;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Show the tracks flagged by a mask for each kept event; an empty mask shows
+ * all tracks of the event.
+ *
+ * When every visible track already has its own line, other lines are only
+ * disabled, which is much faster than rebuilding them. Otherwise, e.g. with
+ * batched tracks, the visible tracks are drawn again.
+ */
+void MCTruthViewerInterface::set_visible(
+    std::vector<std::vector<char>> visible)
+{
+    assert(visible.size() == drawn_events_.size());
+    auto const start = Clock::now();
+    visible_ = std::move(visible);
+    auto shown = [this](std::size_t e, std::size_t i) {
+        return visible_[e].empty() || visible_[e][i];
+    };
+
+    bool toggle = (track_display_ == TrackDisplay::line
+                   && lines_.size() == drawn_events_.size());
+    std::size_t num_tracks = 0;
+    std::size_t num_shown = 0;
+    for (std::size_t e = 0; e < drawn_events_.size(); e++)
+    {
+        num_tracks += drawn_events_[e].num_tracks();
+        for (std::size_t i = 0; i < drawn_events_[e].num_tracks(); i++)
+        {
+            if (shown(e, i))
+            {
+                ++num_shown;
+                toggle = toggle && lines_[e][i];
+            }
+        }
+    }
+
+    if (toggle)
+    {
+        for (std::size_t e = 0; e < lines_.size(); e++)
+        {
+            for (std::size_t i = 0; i < lines_[e].size(); i++)
+            {
+                if (auto* line = lines_[e][i])
+                {
+                    line->SetRnrState(shown(e, i));
+                }
+            }
+        }
+    }
+    else
+    {
+        this->redraw();
+    }
+    gEve->Redraw3D();
+
+    std::cout << "Showing " << num_shown << " of " << num_tracks
+              << " tracks (" << Milliseconds(Clock::now() - start).count()
+              << " ms)" << std::endl;
+}
+
 //---------------------------------------------------------------------------//
 /*!
  * Convert PDG to string.
@@ -42,30 +690,407 @@ std::string MCTruthViewerInterface::to_string(PDG id)
  * Set up attributes of a TEveLine for drawing tracks.
  */
 void MCTruthViewerInterface::set_track_attributes(TEveLine* track, PDG pdg)
+{
+    track->SetLineColor(color(pdg));
+    if (species(pdg) == pdg)
+    {
+        // Known species
+        track->SetMarkerColor(color(pdg));
+        track->SetRnrPoints(step_points_);
+    }
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Name of the species used to group batched tracks: the particle name, or
+ * \c other for all unnamed particles.
+ */
+std::string MCTruthViewerInterface::species_name(int pdg)
+{
+    auto const result = species(pdg);
+    return (result == pdg) ? this->to_string(result) : std::string("other");
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Species used to group batched tracks: one of the named PDG values, or zero
+ * for all other particles.
+ */
+auto MCTruthViewerInterface::species(int pdg) -> PDG
 {
     switch (pdg)
     {
         case PDG::gamma:
-            track->SetLineColor(kGreen + 2);
-            track->SetMarkerColor(kGreen + 2);
-            track->SetRnrPoints(step_points_);
-            break;
         case PDG::e_minus:
-            track->SetLineColor(kAzure + 1);
-            track->SetMarkerColor(kAzure + 1);
-            track->SetRnrPoints(step_points_);
-            break;
         case PDG::e_plus:
-            track->SetLineColor(kRed + 2);
-            track->SetMarkerColor(kRed + 2);
-            track->SetRnrPoints(step_points_);
-            break;
         case PDG::mu_minus:
-            track->SetLineColor(kOrange + 1);
-            track->SetMarkerColor(kOrange + 1);
-            track->SetRnrPoints(step_points_);
-            break;
+            return static_cast<PDG>(pdg);
         default:
-            track->SetLineColor(kGray);
+            return static_cast<PDG>(0);
+    }
+}
+
+//---------------------------------------------------------------------------//
+// PRIVATE
+//---------------------------------------------------------------------------//
+
+//---------------------------------------------------------------------------//
+/*!
+ * Generate a TEveLine for each decoded track and add it to the viewer.
+ *
+ * Tracks are named \c [event_id]_[track_id]_[particle_name_or_pdg] . If
+ * \c visible is given, only the tracks it flags are drawn. If events are
+ * kept, the lines of each event are recorded so that they can be hidden
+ * later.
+ */
+void MCTruthViewerInterface::draw_event(EventData const& event,
+                                        std::vector<char> const* visible)
+{
+    if (track_display_ != TrackDisplay::line)
+    {
+        this->draw_event_segments(event, visible);
+        return;
+    }
+
+    std::vector<TEveLine*>* lines = nullptr;
+    if (this->keeps_events())
+    {
+        lines_.emplace_back(event.num_tracks(), nullptr);
+        lines = &lines_.back();
+    }
+
+    std::vector<Point> points;
+    for (std::size_t i = 0; i < event.num_tracks(); i++)
+    {
+        if (visible && !(*visible)[i])
+        {
+            continue;
+        }
+        auto const track = event.track(i);
+        auto const pdg = static_cast<PDG>(track.pdg);
+        auto track_line = new TEveLine(TEveLine::ETreeVarType_e::kTVT_XYZ);
+        track_line->SetName(this->track_name(event.id, track).c_str());
+        this->set_track_attributes(track_line, pdg);
+
+        auto const kept = this->simplified(event, track, &points);
+        set_points(track_line, kept.points, kept.num_points);
+        Profiler::add(Profiler::Counter::points_created, kept.num_points);
+
+        gEve->AddElement(track_line);
+        Profiler::add(Profiler::Counter::elements_added, 1);
+        if (this->keeps_events())
+        {
+            elements_.push_back(track_line);
+        }
+        if (lines)
+        {
+            (*lines)[i] = track_line;
+        }
     }
 }
+
+//---------------------------------------------------------------------------//
+/*!
+ * Merge the tracks of an event into one segment set per species.
+ *
+ * Sets are named \c [event_id]_[particle_name] , or \c [particle_name] when
+ * a single set per species is used for all events. If \c visible is given,
+ * only the tracks it flags are added.
+ */
+void MCTruthViewerInterface::draw_event_segments(
+    EventData const& event, std::vector<char> const* visible)
+{
+    bool const per_run = (track_display_ == TrackDisplay::batch_run);
+    std::map<int, TrackSegmentSet*> event_segments;
+    auto& segments = per_run ? run_segments_ : event_segments;
+
+    std::vector<Point> points;
+    for (std::size_t i = 0; i < event.num_tracks(); i++)
+    {
+        if (visible && !(*visible)[i])
+        {
+            continue;
+        }
+        auto const track = event.track(i);
+        auto const pdg = species(track.pdg);
+        auto& set = segments[pdg];
+        if (!set)
+        {
+            auto name = this->species_name(track.pdg);
+            if (!per_run)
+            {
+                name = std::to_string(event.id) + "_" + name;
+            }
+            set = this->add_segment_set(pdg, name);
+        }
+        auto const kept = this->simplified(event, track, &points);
+        set->add_track(this->track_name(event.id, track),
+                       kept.points,
+                       kept.num_points,
+                       step_points_ && pdg == track.pdg);
+        Profiler::add(Profiler::Counter::points_created, kept.num_points);
+    }
+
+    for (auto const& id_set : segments)
+    {
+        id_set.second->ComputeBBox();
+        id_set.second->StampObjProps();
+    }
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Decode an event, remove the tracks failing the track selection expression,
+ * and compute the simplification of the remaining tracks.
+ *
+ * This is called from worker threads and must not modify shared state.
+ */
+EventData
+MCTruthViewerInterface::decode(EventReader& reader, int event_id) const
+{
+    ScopedTimer timer("Decode event");
+    auto const start = Clock::now();
+    auto result = reader(event_id);
+    this->filter().select_tracks(&result);
+    if (simplifier_)
+    {
+        (*simplifier_)(&result);
+    }
+    decode_ns_ += std::chrono::duration_cast<Nanoseconds>(Clock::now() - start)
+                      .count();
+    return result;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Decode events on the loader thread.
+ *
+ * A single event is decoded with the reader of the concrete class. Otherwise,
+ * events are decoded in chunks on worker threads.
+ */
+void MCTruthViewerInterface::load(std::vector<int> const& ids,
+                                  bool single_event)
+{
+    if (single_event)
+    {
+        // The event may already be cached by the event selection
+        auto& cache = selection_->cache();
+        auto event = cache.find(ids.front());
+        if (!event)
+        {
+            event = std::make_shared<EventData const>(
+                this->decode(this->reader(), ids.front()));
+            cache.insert(ids.front(), event);
+        }
+        if (load_observer_)
+        {
+            load_observer_(*event, 0);
+        }
+        std::vector<EventData> events;
+        events.push_back(*event);
+        loader_->count_decoded(1);
+        loader_->push(std::move(events));
+    }
+    else
+    {
+        loader_->decode_chunks(
+            ids,
+            num_threads_,
+            [this](std::vector<EventData> events) {
+                loader_->push(std::move(events));
+            },
+            load_observer_);
+    }
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Destroy all drawn tracks.
+ */
+void MCTruthViewerInterface::clear_events()
+{
+    if (auto* event = gEve->GetCurrentEvent())
+    {
+        event->DestroyElements();
+    }
+    elements_.clear();
+    lines_.clear();
+    run_segments_.clear();
+    drawn_events_.clear();
+    visible_.clear();
+    total_points_ = drawn_points_ = 0;
+    ++events_revision_;
+    ++tracks_revision_;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Keep a drawn event for later redraws or queries.
+ */
+void MCTruthViewerInterface::keep_event(EventData event)
+{
+    visible_.emplace_back();
+    drawn_events_.push_back(std::move(event));
+    ++events_revision_;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Draw a decoded event and keep it if it may be drawn again.
+ */
+void MCTruthViewerInterface::add_decoded_event(EventData event)
+{
+    ScopedTimer timer("Track construction");
+    auto const start = Clock::now();
+    this->draw_event(event);
+    stats_.draw_time += Seconds(Clock::now() - start).count();
+
+    ++stats_.num_events;
+    stats_.num_tracks += event.num_tracks();
+    for (std::size_t i = 0; i < event.num_tracks(); i++)
+    {
+        auto const num_points = event.offsets[i + 1] - event.offsets[i];
+        stats_.num_steps += num_points == 0 ? 0 : num_points - 1;
+    }
+    if (this->keeps_events())
+    {
+        this->keep_event(std::move(event));
+    }
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Points of a track at the current detail level.
+ *
+ * Without simplification the track is returned directly; otherwise the kept
+ * points are copied into \c buffer and the returned view points to it.
+ */
+TrackView MCTruthViewerInterface::simplified(EventData const& event,
+                                             TrackView track,
+                                             std::vector<Point>* buffer)
+{
+    total_points_ += track.num_points;
+    if (!simplifier_)
+    {
+        drawn_points_ += track.num_points;
+        return track;
+    }
+
+    double const tolerance = simplifier_->tolerance(detail_level_);
+    buffer->clear();
+    for (std::size_t i = 0; i < track.num_points; i++)
+    {
+        if (TrackSimplifier::keep(event, track.first + i, tolerance))
+        {
+            buffer->push_back(track.points[i]);
+        }
+    }
+    drawn_points_ += buffer->size();
+    track.points = buffer->data();
+    track.num_points = buffer->size();
+    return track;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Report how many points were removed by track simplification.
+ */
+void MCTruthViewerInterface::print_simplification() const
+{
+    if (!simplifier_)
+    {
+        return;
+    }
+    std::cout << "Track simplification: removed "
+              << total_points_ - drawn_points_ << " of " << total_points_
+              << " points (detail level " << detail_level_ << ", tolerance "
+              << simplifier_->tolerance(detail_level_) << " cm)" << std::endl;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Report input reads of the readers used to load all events.
+ */
+void MCTruthViewerInterface::print_cache_stats() const
+{
+    auto const stats = loader_->cache_stats();
+    if (stats.cached_bytes + stats.uncached_bytes == 0)
+    {
+        return;
+    }
+    auto megabytes = [](Long64_t bytes) { return bytes / double(1 << 20); };
+    std::cout << std::fixed << std::setprecision(1)
+              << "Tree cache: read " << megabytes(stats.cached_bytes)
+              << " MB in " << stats.cached_reads << " cache fills and "
+              << megabytes(stats.uncached_bytes) << " MB in "
+              << stats.uncached_reads << " uncached reads ("
+              << 100 * stats.hit_fraction() << "% from cache)"
+              << std::defaultfloat << std::endl;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Track color for each species.
+ */
+Color_t MCTruthViewerInterface::color(PDG pdg)
+{
+    switch (pdg)
+    {
+        case PDG::gamma:
+            return kGreen + 2;
+        case PDG::e_minus:
+            return kAzure + 1;
+        case PDG::e_plus:
+            return kRed + 2;
+        case PDG::mu_minus:
+            return kOrange + 1;
+        default:
+            return kGray;
+    }
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Fill the points of a track line in one pass.
+ *
+ * The point buffer of the line is allocated once with the final size, instead
+ * of growing it point by point with \c SetNextPoint . Single precision points
+ * have the same layout as the buffer and are copied in bulk.
+ */
+void MCTruthViewerInterface::set_points(TEveLine* line,
+                                        Point const* points,
+                                        std::size_t num_points)
+{
+    line->Reset(num_points);
+    if (num_points == 0)
+    {
+        return;
+    }
+    if (std::is_same<real_type, Float_t>::value)
+    {
+        static_assert(sizeof(Point) == 3 * sizeof(real_type),
+                      "points must be packed");
+        std::memcpy(line->GetP(), points, num_points * sizeof(Point));
+    }
+    else
+    {
+        for (std::size_t i = 0; i + 1 < num_points; i++)
+        {
+            line->SetPoint(i, points[i][0], points[i][1], points[i][2]);
+        }
+    }
+    // Setting the last point marks the whole buffer as filled
+    auto const& last = points[num_points - 1];
+    line->SetPoint(num_points - 1, last[0], last[1], last[2]);
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Track name, \c [event_id]_[track_id]_[particle_name_or_pdg] .
+ */
+std::string
+MCTruthViewerInterface::track_name(int event_id, TrackView const& track)
+{
+    return std::to_string(event_id) + "_" + std::to_string(track.id) + "_"
+           + this->to_string(static_cast<PDG>(track.pdg));
+}
@@ -7,13 +7,56 @@
 //---------------------------------------------------------------------------//
 #pragma once
 
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
 #include <string>
+#include <vector>
 #include <TEveTrack.h>
 
+#include "EventCache.hh"
+#include "EventData.hh"
+#include "TrackFilter.hh"
+#include "TrackSegmentSet.hh"
+#include "TrackSimplifier.hh"
+#include "TreeCache.hh"
+
+class EventLoader;
+class EventSelection;
+
 //---------------------------------------------------------------------------//
 /*!
  * Interface to read any MCtruth data and add it to the Evd.
  *
+ * Concrete implementations provide the list of available events and readers
+ * that decode a single event into \c EventData . Readers are expected to
+ * apply the track selection of \c filter() before decoding step data. Its
+ * selection expressions are evaluated on decoded events, on the worker
+ * threads that decode them, so that tracks and events failing them are
+ * never drawn.
+ * Drawing is common to all implementations. When all events are requested,
+ * events are decoded by independent readers on worker threads, while only the
+ * insertion of the resulting elements into Eve happens on the calling thread.
+ *
+ * Events can also be loaded in the background with \c start_loading , by an
+ * \c EventLoader . Decoded events are then queued until the GUI thread adds
+ * them to Eve by calling \c draw_loaded , e.g. from a timer. Loading options
+ * must not be changed while a background load is in progress.
+ *
+ * When a single event is shown, \c show_event and \c step_event replace it
+ * with another one, found and prefetched by an \c EventSelection .
+ * \c stop_workers must be called before a concrete implementation is
+ * destroyed.
+ *
+ * With \c set_keep_events , drawn events are kept in memory so that GUI
+ * controls can index them once loading finishes, e.g. \c SegmentQuery , and
+ * replace the drawn tracks: \c events_revision and \c tracks_revision tell
+ * them when their indices or track elements are out of date, e.g. for the
+ * time window of \c TimeSlider . Tracks can also be hidden with
+ * \c set_visible , e.g. by \c ShowerNavigator .
+ *
  * Concrete implementations of this class are expected to be constructed
  * *after* \c MainViewer is initialized, since they would use ROOT's \c gEve
  * singleton to add any track/point to the viewer.
@@ -32,25 +75,334 @@ class MCTruthViewerInterface
         gamma = 22
     };
 
-    // Default destructor
-    virtual ~MCTruthViewerInterface() = default;
+    //! How tracks are represented in Eve
+    enum class TrackDisplay
+    {
+        line,  //!< One TEveLine per track
+        batch_event,  //!< One segment set per species and event
+        batch_run  //!< One segment set per species for all events
+    };
+
+    //! Decode single events from the input, using its own file handles
+    class EventReader
+    {
+      public:
+        virtual ~EventReader() = default;
+        virtual EventData operator()(int event_id) = 0;
+
+        //! Input statistics of the reader's read-ahead cache
+        virtual TreeCacheStats cache_stats() const { return {}; }
+    };
+
+    //! Progress of a background load
+    struct LoadProgress
+    {
+        std::size_t num_events{0};  //!< Events selected for loading
+        std::size_t num_decoded{0};  //!< Events decoded so far
+        std::size_t num_drawn{0};  //!< Events added to Eve so far
+        bool cancelled{false};  //!< Loading was cancelled
+        bool done{true};  //!< No more events will be drawn
+    };
+
+    //! Cumulative statistics of drawn events
+    struct LoadStats
+    {
+        std::size_t num_events{0};
+        std::size_t num_tracks{0};
+        std::size_t num_steps{0};
+        double decode_time{0};  //!< Decoding, summed over threads [s]
+        double draw_time{0};  //!< Track construction [s]
+        TreeCacheStats cache;  //!< Input reads when loading all events
+    };
+
+    // Check that no background work is running
+    virtual ~MCTruthViewerInterface();
+
+    // Add tracks from a given event to Eve; if negative, add all events
+    void add_event(int event_id);
+
+    // Start decoding a given event, or all events, in the background
+    void start_loading(int event_id);
+
+    // Add decoded events to Eve for at most the given time [ms]
+    std::size_t draw_loaded(double max_time);
+
+    // Stop the background load and wait for it to finish
+    void cancel_loading();
+
+    // Progress of the background load
+    LoadProgress load_progress() const;
 
-    // Mandatory function to add tracks from a given event to Eve
-    virtual void add_event(int event_id) = 0;
+    // Statistics of drawn events
+    LoadStats load_stats() const;
+
+    // Set decoded event cache size [bytes] and number of prefetched events
+    void set_event_cache(std::size_t max_bytes, unsigned int num_prefetch);
+
+    // Set maximum read-ahead cache size of each reader [bytes]
+    void set_tree_cache_size(Long64_t max_bytes);
+
+    // Decode track attributes and interaction flags of every track
+    void set_decode_attributes(bool value);
+
+    // Decode energy deposits along the steps of every track
+    void set_decode_energy_deposition(bool value);
+
+    // Decode the parent id of every track
+    void set_decode_parents(bool value);
+
+    // Decode the global time of every step point
+    void set_decode_times(bool value);
+
+    // Pass each event decoded by background loads to a function
+    void set_load_observer(
+        std::function<void(EventData const&, unsigned int)> func);
+
+    // Decode all selected events and pass them, in order, to a function
+    void for_each_event(std::function<void(EventData const&)> const& func);
+
+    // Decode all selected events and pass them to a function on worker threads
+    void scan_events(
+        std::function<void(EventData const&, unsigned int)> const& func);
+
+    // Replace drawn tracks with those of another event
+    bool show_event(int event_id);
+
+    // Show the next (positive) or previous (negative) selected event
+    bool step_event(int offset);
+
+    // Event currently shown; negative if all events are drawn
+    int current_event() const;
+
+    // Stop background loading and prefetching
+    void stop_workers();
 
     // Draw step points along the track
     void show_step_points(bool value);
 
+    // Set number of threads used to load all events
+    void set_num_threads(unsigned int value);
+
+    //! Number of threads used to load all events
+    unsigned int num_threads() const { return num_threads_; }
+
+    // Set track representation
+    void set_track_display(TrackDisplay value);
+
+    // Set event and track selection applied while reading
+    void set_filter(TrackFilter const& filter);
+
+    // Enable track simplification
+    void set_simplification(double tolerance, int num_levels);
+
+    // Redraw loaded tracks at a given detail level
+    void set_detail_level(int level);
+
+    // Number of available detail levels
+    int num_detail_levels() const;
+
+    // Keep drawn events in memory for later redraws or queries
+    void set_keep_events(bool value);
+
+    //! Drawn events, if kept
+    std::vector<EventData> const& drawn_events() const
+    {
+        return drawn_events_;
+    }
+
+    //! Changes whenever drawn events are added or cleared
+    std::size_t events_revision() const { return events_revision_; }
+
+    //! Changes whenever drawn track elements are destroyed
+    std::size_t tracks_revision() const { return tracks_revision_; }
+
+    // Destroy drawn tracks and draw the visible tracks of the kept events
+    void redraw();
+
+    // Destroy drawn track elements, keeping the drawn events
+    void destroy_tracks();
+
+    // Show tracks selected by a mask for each kept event
+    void set_visible(std::vector<std::vector<char>> visible);
+
+    // Add an empty segment set for the tracks of a species to Eve
+    TrackSegmentSet* add_segment_set(PDG species, std::string const& name);
+
+    //! Whether step points are drawn along tracks
+    bool step_points() const { return step_points_; }
+
+    // Track name
+    std::string track_name(int event_id, TrackView const& track);
+
     // Convert PDG to string
     std::string to_string(PDG id);
 
     // Set up track attributes
     void set_track_attributes(TEveLine* track, PDG pdg);
 
+    // Name of the species used to group batched tracks
+    std::string species_name(int pdg);
+
+    // Species used to group batched tracks
+    static PDG species(int pdg);
+
+    //! Whether the input provides per-point energy deposits
+    virtual bool has_energy_deposition() const { return true; }
+
+    //! Whether the input provides per-point global times
+    virtual bool has_times() const { return true; }
+
   protected:
     // Allow construction only from concrete implementations
-    MCTruthViewerInterface() = default;
+    MCTruthViewerInterface();
+
+    // Sorted list of event ids available in the input
+    virtual std::vector<int> event_ids() = 0;
+
+    // Whether an event is available in the input
+    virtual bool has_event(int event_id);
+
+    // Available events following (positive count) or preceding an event
+    virtual std::vector<int> neighbor_ids(int event_id, int count);
+
+    // Reader using the file handles owned by the concrete class
+    virtual EventReader& reader() = 0;
+
+    // Create a reader with its own file handles, for use on a worker thread
+    virtual std::unique_ptr<EventReader> make_reader() const = 0;
+
+    //! Event and track selection that readers must apply
+    TrackFilter const& filter() const
+    {
+        return parent_ ? parent_->filter() : filter_;
+    }
+
+    //! Whether readers must flag interaction points
+    bool needs_interactions() const
+    {
+        return parent_ ? parent_->needs_interactions()
+                       : simplifier_ != nullptr || decode_attributes_;
+    }
+
+    //! Whether readers must fill the track attributes
+    bool needs_attributes() const
+    {
+        using Variable = Expression::Variable;
+        return parent_ ? parent_->needs_attributes()
+                       : decode_attributes_
+                             || filter_.uses(Variable::vertex_energy)
+                             || filter_.uses(Variable::length);
+    }
+
+    //! Whether readers must fill the parent ids, possibly without attributes
+    bool needs_parents() const
+    {
+        using Variable = Expression::Variable;
+        return parent_ ? parent_->needs_parents()
+                       : decode_attributes_ || decode_parents_
+                             || filter_.uses(Variable::parent_id)
+                             || filter_.uses(Variable::primary);
+    }
+
+    //! Whether readers must fill the per-point energy deposits
+    bool needs_energy_deposition() const
+    {
+        return parent_ ? parent_->needs_energy_deposition()
+                       : decode_attributes_ || decode_energy_deposition_
+                             || filter_.uses(Expression::Variable::energy_dep);
+    }
+
+    //! Whether readers must fill the per-point global times
+    bool needs_times() const
+    {
+        return parent_ ? parent_->needs_times()
+                       : decode_attributes_ || decode_times_;
+    }
+
+    //! Maximum read-ahead cache size of each reader [bytes]
+    Long64_t tree_cache_size() const
+    {
+        return parent_ ? parent_->tree_cache_size() : tree_cache_size_;
+    }
 
   private:
+    friend class EventSelection;
+    friend class MultiFileViewer;
+
+    MCTruthViewerInterface const* parent_{nullptr};  //!< Reader options
     bool step_points_{false};
+    bool decode_attributes_{false};
+    bool decode_energy_deposition_{false};
+    bool decode_parents_{false};
+    bool decode_times_{false};
+    unsigned int num_threads_{1};
+    TrackDisplay track_display_{TrackDisplay::line};
+    TrackFilter filter_;
+    std::map<int, TrackSegmentSet*> run_segments_;
+
+    std::unique_ptr<TrackSimplifier> simplifier_;
+    int detail_level_{0};
+    bool keep_events_{false};
+    std::vector<EventData> drawn_events_;
+    std::vector<std::vector<char>> visible_;  //!< Empty if all are shown
+    std::vector<TEveElement*> elements_;
+    std::vector<std::vector<TEveLine*>> lines_;  //!< Per kept event
+    std::size_t total_points_{0};
+    std::size_t drawn_points_{0};
+    std::size_t events_revision_{0};
+    std::size_t tracks_revision_{0};
+
+    std::unique_ptr<EventLoader> loader_;
+    std::function<void(EventData const&, unsigned int)> load_observer_;
+    std::size_t num_drawn_{0};
+    std::unique_ptr<EventSelection> selection_;
+
+    LoadStats stats_;
+    mutable std::atomic<std::int64_t> decode_ns_{0};
+    Long64_t tree_cache_size_{64 << 20};
+
+    // Decode events on the loader thread
+    void load(std::vector<int> const& ids, bool single_event);
+
+    // Destroy all drawn tracks
+    void clear_events();
+
+    //! Whether drawn events are kept for later redraws or queries
+    bool keeps_events() const
+    {
+        return simplifier_ || keep_events_;
+    }
+
+    // Keep a drawn event for later redraws or queries
+    void keep_event(EventData event);
+
+    // Decode an event and simplify its tracks
+    EventData decode(EventReader& reader, int event_id) const;
+
+    // Draw a decoded event, keeping it for later redraws if needed
+    void add_decoded_event(EventData event);
+
+    // Create track lines of a decoded event and add them to Eve
+    void draw_event(EventData const& event,
+                    std::vector<char> const* visible = nullptr);
+
+    // Points of a track at the current detail level
+    TrackView simplified(EventData const& event,
+                         TrackView track,
+                         std::vector<Point>* buffer);
+
+    // Print number of points removed by simplification
+    void print_simplification() const;
+    void print_cache_stats() const;
+
+    // Add all tracks of a decoded event to per-species segment sets
+    void draw_event_segments(EventData const& event,
+                             std::vector<char> const* visible);
+
+    // Track color
+    static Color_t color(PDG pdg);
+
+    // Copy points into a track line
+    static void
+    set_points(TEveLine* line, Point const* points, std::size_t num_points);
 };
@@ -7,30 +7,51 @@
 //---------------------------------------------------------------------------//
 #include "MainViewer.hh"
 
+#include <iomanip>
 #include <iostream>
 #include <vector>
 #include <TEveBrowser.h>
+#include <TEveDigitSet.h>
 #include <TEveGeoNode.h>
+#include <TEveRGBAPaletteOverlay.h>
+#include <TEveScene.h>
 #include <TEveViewer.h>
 #include <TGeoManager.h>
 #include <TGeoNode.h>
+#include <TMD5.h>
 #include <TObjArray.h>
 #include <TObject.h>
+#include <TROOT.h>
+#include <TSystem.h>
 #include <assert.h>
 
+#include "Profiler.hh"
+#include "RootUniquePtr.hh"
+
+namespace
+{
+//---------------------------------------------------------------------------//
+// Name of the geometry cache key object
+char const geometry_key_name[] = "evd_geometry_key";
+//---------------------------------------------------------------------------//
+}  // namespace
+
 //---------------------------------------------------------------------------//
 /*!
  * Construct with gdml geometry input.
  */
-MainViewer::MainViewer(std::string gdml_input)
+MainViewer::MainViewer(std::string gdml_input, bool use_geometry_cache)
+    : start_time_(Clock::now()), last_time_(start_time_)
 {
     root_app_.reset(new TRint("evd", nullptr, nullptr, nullptr, 0, true));
     root_app_->SetPrompt("evd [%d] ");
 
     // TEveManager creates a gEve pointer owned by ROOT
     TEveManager::Create();
+    this->record_time("ROOT and Eve initialization");
+
     TGeoManager::SetVerboseLevel(0);
-    TGeoManager::Import(gdml_input.c_str());
+    this->load_geometry(gdml_input, use_geometry_cache);
     std::cout << "Geometry input: " << gdml_input << std::endl;
 }
 
@@ -94,6 +115,39 @@ void MainViewer::add_cms_volume()
     gEve->AddGlobalElement(cmse_top_node);
 }
 
+//---------------------------------------------------------------------------//
+/*!
+ * Give the projection viewers their own, initially empty, scenes instead of
+ * the event scene, so that projections computed once the GUI is running can
+ * be shown with \c set_projection . Must be called before \c start_viewer .
+ */
+void MainViewer::enable_projections()
+{
+    projections_enabled_ = true;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Show an element instead of the event scene in a projection viewer.
+ *
+ * Precomputed projections keep the tab responsive with many loaded tracks,
+ * since the orthographic viewers no longer redraw the event scene. The
+ * element is added to its own scene, and a palette overlay is shown if it is
+ * a digit set. Before \c start_viewer , this happens when the GUI starts;
+ * afterwards, projections must be enabled with \c enable_projections , and
+ * the element is added from the calling thread, which must own Eve. The
+ * viewers are redrawn by the next \c gEve->Redraw3D .
+ */
+void MainViewer::set_projection(Projection projection, TEveElement* element)
+{
+    assert(projection != Projection::size_);
+    projections_[static_cast<int>(projection)] = element;
+    if (projection_scenes_[static_cast<int>(projection)])
+    {
+        this->show_projection(projection);
+    }
+}
+
 //---------------------------------------------------------------------------//
 /*!
  * Set the visualization option:
@@ -117,7 +171,7 @@ void MainViewer::set_vis_level(int vis_level)
 
 //---------------------------------------------------------------------------//
 /*!
- * Start MainViewer GUI.
+ * Start MainViewer GUI and return when it is closed.
  */
 void MainViewer::start_viewer()
 {
@@ -127,8 +181,14 @@ void MainViewer::start_viewer()
     gEve->GetDefaultGLViewer()->GetClipSet()->SetClipType(TGLClip::EType(0));
 
     // Build 2nd tab with orthogonal viewers
+    this->record_time("Event input setup");
     this->init_projections_tab();
-    gEve->FullRedraw3D(true);
+    {
+        ScopedTimer timer("Eve full redraw");
+        gEve->FullRedraw3D(true);
+    }
+    this->record_time("GUI setup");
+    this->print_startup_times();
 
     // Return focus to the main viewer
     gEve->GetDefaultGLViewer();
@@ -137,14 +197,155 @@ void MainViewer::start_viewer()
     // gEve->GetDefaultGLViewer()->SetCurrentCamera(TGLViewer::kCameraPerspXOY);
 
     std::cout << std::endl;
-    root_app_->Run();
-    root_app_->Terminate(EXIT_SUCCESS);
+    // Return from the event loop on exit, so that background work started
+    // before the GUI can be stopped by the caller
+    root_app_->Run(/* retrn = */ kTRUE);
 }
 
 //---------------------------------------------------------------------------//
 // PRIVATE
 //---------------------------------------------------------------------------//
 
+//---------------------------------------------------------------------------//
+/*!
+ * Import the geometry from the binary cache if it is up to date, or from the
+ * GDML file, saving the cache for later runs.
+ */
+void MainViewer::load_geometry(std::string const& gdml_input, bool use_cache)
+{
+    if (!use_cache)
+    {
+        TGeoManager::Import(gdml_input.c_str());
+        this->record_time("GDML import");
+        return;
+    }
+
+    auto const key = MainViewer::geometry_key(gdml_input);
+    auto const cache_file = gdml_input + ".evdgeo.root";
+    this->record_time("GDML checksum");
+
+    if (MainViewer::import_geometry_cache(cache_file, key))
+    {
+        this->record_time("Geometry cache import");
+        std::cout << "Geometry cache: " << cache_file << std::endl;
+        return;
+    }
+
+    TGeoManager::Import(gdml_input.c_str());
+    this->record_time("GDML import");
+
+    if (MainViewer::write_geometry_cache(cache_file, key))
+    {
+        this->record_time("Geometry cache write");
+        std::cout << "Geometry cache: saved to " << cache_file << std::endl;
+    }
+    else
+    {
+        std::cout << "[WARNING] Could not write geometry cache to "
+                  << cache_file << std::endl;
+    }
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Cache key: MD5 checksum of the GDML file and ROOT version. Empty if the
+ * GDML file cannot be read.
+ */
+std::string MainViewer::geometry_key(std::string const& gdml_input)
+{
+    std::unique_ptr<TMD5> md5(TMD5::FileChecksum(gdml_input.c_str()));
+    if (!md5)
+    {
+        return {};
+    }
+    return std::string(md5->AsString()) + " ROOT " + gROOT->GetVersion();
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Import geometry cache, returning false if it is missing or stale.
+ */
+bool MainViewer::import_geometry_cache(std::string const& filename,
+                                       std::string const& key)
+{
+    if (key.empty() || gSystem->AccessPathName(filename.c_str()))
+    {
+        // No checksum or no cache file
+        return false;
+    }
+
+    {
+        UPRootExtern<TFile> tfile(TFile::Open(filename.c_str(), "read"));
+        if (!tfile || tfile->IsZombie())
+        {
+            return false;
+        }
+        auto const* stored = tfile->Get<TNamed>(geometry_key_name);
+        if (!stored || key != stored->GetTitle())
+        {
+            // Cache belongs to a different or modified GDML file
+            return false;
+        }
+    }
+
+    return TGeoManager::Import(filename.c_str()) != nullptr;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Export the closed geometry along with its cache key.
+ */
+bool MainViewer::write_geometry_cache(std::string const& filename,
+                                      std::string const& key)
+{
+    if (key.empty() || !gGeoManager->Export(filename.c_str()))
+    {
+        return false;
+    }
+
+    UPRootExtern<TFile> tfile(TFile::Open(filename.c_str(), "update"));
+    if (!tfile || tfile->IsZombie())
+    {
+        return false;
+    }
+    TNamed stored(geometry_key_name, key.c_str());
+    return tfile->WriteTObject(&stored) > 0;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Store the time elapsed since the previous startup stage, also recording it
+ * as a profiler phase.
+ */
+void MainViewer::record_time(std::string label)
+{
+    auto const now = Clock::now();
+    Profiler::instance().record(label, last_time_, now);
+    startup_times_.emplace_back(
+        std::move(label),
+        std::chrono::duration<double>(now - last_time_).count());
+    last_time_ = now;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Print the time spent in each startup stage.
+ */
+void MainViewer::print_startup_times() const
+{
+    std::cout << "Startup time [s]:" << std::endl;
+    for (auto const& label_time : startup_times_)
+    {
+        std::cout << "  " << std::left << std::setw(30) << label_time.first
+                  << std::right << std::fixed << std::setprecision(3)
+                  << label_time.second << std::endl;
+    }
+    auto const total = last_time_ - start_time_;
+    std::cout << "  " << std::left << std::setw(30) << "Total" << std::right
+              << std::chrono::duration<double>(total).count()
+              << std::defaultfloat << std::endl;
+}
+
 //---------------------------------------------------------------------------//
 /*!
  * Return the top volume of the geometry file.
@@ -183,26 +384,70 @@ void MainViewer::init_projections_tab()
     pack_right->SetShowTitleBar(false);
 
     // Setup content of the 4 window slots
-    this->spawn_viewer(*slot_left_top, "XY View", TGLViewer::kCameraOrthoXOY);
-    this->spawn_viewer(*slot_right_top, "ZY View", TGLViewer::kCameraOrthoZOY);
-    this->spawn_viewer(
-        *slot_left_bottom, "XZ View", TGLViewer::kCameraOrthoXOZ);
+    this->spawn_viewer(*slot_left_top,
+                       "XY View",
+                       TGLViewer::kCameraOrthoXOY,
+                       Projection::xy);
+    this->spawn_viewer(*slot_right_top,
+                       "ZY View",
+                       TGLViewer::kCameraOrthoZOY,
+                       Projection::zy);
+    this->spawn_viewer(*slot_left_bottom,
+                       "XZ View",
+                       TGLViewer::kCameraOrthoXOZ,
+                       Projection::xz);
     this->spawn_viewer(
         *slot_right_bottom, "3D View", TGLViewer::kCameraPerspXOZ);
 }
 
 //---------------------------------------------------------------------------//
 /*!
- * Setup projection tab viewer.
+ * Setup projection tab viewer, showing the event scene or a scene for the
+ * precomputed projection of a plane, if any is set or enabled.
  */
 void MainViewer::spawn_viewer(TEveWindowSlot& slot,
                               std::string title,
-                              TGLViewer::ECameraType camera)
+                              TGLViewer::ECameraType camera,
+                              Projection projection)
 {
     slot.MakeCurrent();
     auto eve_view = gEve->SpawnNewViewer(title.c_str(), "");
     eve_view->GetGLViewer()->SetCurrentCamera(camera);
     eve_view->GetGLViewer()->SetStyle(TGLRnrCtx::kWireFrame);
     eve_view->AddScene(gEve->GetGlobalScene());
-    eve_view->AddScene(gEve->GetEventScene());
+    int const p = static_cast<int>(projection);
+    if (projection == Projection::size_
+        || !(projections_[p] || projections_enabled_))
+    {
+        eve_view->AddScene(gEve->GetEventScene());
+        return;
+    }
+
+    auto* scene = gEve->SpawnNewScene((title + " projection").c_str());
+    eve_view->AddScene(scene);
+    projection_scenes_[p] = scene;
+    projection_viewers_[p] = eve_view;
+    if (projections_[p])
+    {
+        this->show_projection(projection);
+    }
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Add the element of a projection to its scene, with a palette overlay if it
+ * is a digit set.
+ */
+void MainViewer::show_projection(Projection projection)
+{
+    int const p = static_cast<int>(projection);
+    auto* element = projections_[p];
+    assert(element && projection_scenes_[p]);
+    projection_scenes_[p]->AddElement(element);
+    if (auto* digits = dynamic_cast<TEveDigitSet*>(element))
+    {
+        projection_viewers_[p]->GetGLViewer()->AddOverlayElement(
+            new TEveRGBAPaletteOverlay(
+                digits->GetPalette(), 0.55, 0.1, 0.4, 0.05));
+    }
 }
@@ -8,14 +8,21 @@
 //---------------------------------------------------------------------------//
 #pragma once
 
+#include <array>
+#include <chrono>
 #include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 #include <TEveManager.h>
 #include <TEveWindow.h>
 #include <TGLViewer.h>
 #include <TGeoVolume.h>
 #include <TRint.h>
 
+class TEveScene;
+class TEveViewer;
+
 //---------------------------------------------------------------------------//
 /*!
  * Evd is built using the Eve Environment [J. Phys.: Conf. Ser. 219 042055].
@@ -23,6 +30,12 @@
  * The level of details is defined by \c set_vis_level(...) and should be
  * invoked before starting the viewer.
  *
+ * The imported geometry is saved to a binary cache next to the GDML file
+ * (\c [input].evdgeo.root ), which is imported instead of the GDML on later
+ * runs as long as the MD5 checksum of the GDML and the ROOT version match the
+ * ones stored in the cache. A breakdown of the startup time is printed when
+ * the GUI starts.
+ *
  * \code
  *  MainViewer evd("geometry.gdml");
  *  evd.set_vis_level(3);
@@ -33,8 +46,17 @@
 class MainViewer
 {
   public:
-    // Construct with gdml
-    MainViewer(std::string gdml_input);
+    //! Orthographic viewers of the projections tab
+    enum class Projection
+    {
+        xy,
+        zy,
+        xz,
+        size_
+    };
+
+    // Construct with gdml, optionally using the binary geometry cache
+    MainViewer(std::string gdml_input, bool use_geometry_cache = true);
 
     // Add World volume
     void add_world_volume();
@@ -45,23 +67,52 @@ class MainViewer
     // Set the visualization level
     void set_vis_level(int vis_level);
 
-    // Start Evd GUI
+    // Start Evd GUI and run until it is closed
     void start_viewer();
 
     // Extra function tailored for the cms-2018 geometry
     void add_cms_volume();
 
+    // Show elements set later instead of the event scene in projection viewers
+    void enable_projections();
+
+    // Show an element instead of the event scene in a projection viewer
+    void set_projection(Projection projection, TEveElement* element);
+
   private:
+    //// TYPES ////
+    using Clock = std::chrono::steady_clock;
+
     //// DATA ////
     int vis_opt_{1};
     int vis_level_{1};
     std::unique_ptr<TRint> root_app_;
+    Clock::time_point start_time_;
+    Clock::time_point last_time_;
+    std::vector<std::pair<std::string, double>> startup_times_;
+    std::array<TEveElement*, static_cast<int>(Projection::size_)>
+        projections_{};
+    bool projections_enabled_{false};
+    std::array<TEveScene*, static_cast<int>(Projection::size_)>
+        projection_scenes_{};
+    std::array<TEveViewer*, static_cast<int>(Projection::size_)>
+        projection_viewers_{};
 
     //// HELPER FUNCTIONS ////
 
+    void load_geometry(std::string const& gdml_input, bool use_cache);
+    static std::string geometry_key(std::string const& gdml_input);
+    static bool import_geometry_cache(std::string const& filename,
+                                      std::string const& key);
+    static bool write_geometry_cache(std::string const& filename,
+                                     std::string const& key);
+    void record_time(std::string label);
+    void print_startup_times() const;
     TGeoVolume* top_volume();
     void init_projections_tab();
     void spawn_viewer(TEveWindowSlot& slot,
                       std::string title,
-                      TGLViewer::ECameraType camera);
+                      TGLViewer::ECameraType camera,
+                      Projection projection = Projection::size_);
+    void show_projection(Projection projection);
 };
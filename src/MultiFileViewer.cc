@@ -0,0 +1,316 @@
+//----------------------------------*-C++-*----------------------------------//
+// Copyright 2023 UT-Battelle, LLC, and other Celeritas developers.
+// See the top-level COPYRIGHT file for details.
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+//---------------------------------------------------------------------------//
+//! \file src/MultiFileViewer.cc
+//---------------------------------------------------------------------------//
+#include "MultiFileViewer.hh"
+
+#include <algorithm>
+#include <iostream>
+#include <assert.h>
+#include <stdlib.h>
+
+#include "ParallelFor.hh"
+#include "Profiler.hh"
+
+//---------------------------------------------------------------------------//
+/*!
+ * Decode single events of any file, keeping a reader of the last file used.
+ */
+class MultiFileViewer::Reader final
+    : public MCTruthViewerInterface::EventReader
+{
+  public:
+    // Construct with the viewer owning the files
+    explicit Reader(MultiFileViewer const& viewer);
+
+    // Decode all selected tracks of an event
+    EventData operator()(int event_id) final;
+
+    // Input statistics of all files read so far
+    TreeCacheStats cache_stats() const final;
+
+  private:
+    MultiFileViewer const& viewer_;
+    std::size_t file_{0};
+    std::unique_ptr<EventReader> file_reader_;
+    TreeCacheStats closed_stats_;
+};
+
+//---------------------------------------------------------------------------//
+/*!
+ * Construct with input filenames, without opening them.
+ *
+ * \c make_viewer creates the concrete viewer of a single file.
+ */
+MultiFileViewer::MultiFileViewer(std::vector<std::string> filenames,
+                                 ViewerFactory make_viewer)
+    : make_viewer_(std::move(make_viewer)), files_(filenames.size())
+{
+    assert(!files_.empty());
+    for (std::size_t i = 0; i < files_.size(); i++)
+    {
+        files_[i].filename = std::move(filenames[i]);
+    }
+    reader_ = std::make_unique<Reader>(*this);
+}
+
+//---------------------------------------------------------------------------//
+//! Default destructor
+MultiFileViewer::~MultiFileViewer() = default;
+
+//---------------------------------------------------------------------------//
+/*!
+ * Sorted list of event ids of all files, indexing all of them.
+ */
+std::vector<int> MultiFileViewer::event_ids()
+{
+    this->index_files(files_.size());
+
+    std::vector<int> result;
+    for (auto const& file : files_)
+    {
+        for (std::size_t i = 0; i < file.event_ids.size(); i++)
+        {
+            result.push_back(file.first_id + static_cast<int>(i));
+        }
+    }
+    return result;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Whether an event is available, indexing files only up to the one holding
+ * it.
+ */
+bool MultiFileViewer::has_event(int event_id)
+{
+    if (event_id < 0)
+    {
+        return false;
+    }
+    this->index_event(event_id);
+
+    auto const& last = files_[num_indexed_ - 1];
+    return event_id - last.first_id
+           < static_cast<std::ptrdiff_t>(last.event_ids.size());
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Available events following or preceding an event, nearest first.
+ *
+ * Merged ids are consecutive from zero, so neighbors are found by checking
+ * the ids next to the event, which only indexes the files up to the ones
+ * holding them.
+ */
+std::vector<int> MultiFileViewer::neighbor_ids(int event_id, int count)
+{
+    std::vector<int> result;
+    if (count > 0)
+    {
+        for (int id = std::max(event_id + 1, 0);
+             static_cast<int>(result.size()) < count && this->has_event(id);
+             id++)
+        {
+            result.push_back(id);
+        }
+    }
+    else
+    {
+        int id = event_id - 1;
+        if (id >= 0 && !this->has_event(id))
+        {
+            // Past the last event, once all files are indexed
+            auto const& back = files_.back();
+            id = back.first_id + static_cast<int>(back.event_ids.size()) - 1;
+        }
+        for (; id >= 0 && static_cast<int>(result.size()) < -count; id--)
+        {
+            result.push_back(id);
+        }
+    }
+    return result;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Reader switching between files.
+ */
+auto MultiFileViewer::reader() -> EventReader&
+{
+    return *reader_;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Create a reader with its own file handles.
+ */
+auto MultiFileViewer::make_reader() const -> std::unique_ptr<EventReader>
+{
+    return std::make_unique<Reader>(*this);
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Open and index the first \c num_files files of the list in parallel.
+ *
+ * Files read by a reader are never modified again: ids of newly indexed files
+ * are published only once all of them are complete.
+ */
+void MultiFileViewer::index_files(std::size_t num_files)
+{
+    std::lock_guard<std::mutex> lock(index_mutex_);
+    std::size_t const first = num_indexed_;
+    std::size_t const last = std::min(num_files, files_.size());
+    if (first >= last)
+    {
+        return;
+    }
+
+    {
+        ScopedTimer timer("Input files indexing");
+        parallel_for(last - first,
+                     this->num_threads(),
+                     [this, first](std::size_t i, unsigned int) {
+                         auto& file = files_[first + i];
+                         file.viewer = make_viewer_(file.filename);
+                         file.viewer->parent_ = this;
+                         file.event_ids = file.viewer->event_ids();
+                     });
+    }
+
+    for (auto i = first; i < last; i++)
+    {
+        auto& file = files_[i];
+        if (i > 0)
+        {
+            auto const& prev = files_[i - 1];
+            file.first_id = prev.first_id
+                            + static_cast<int>(prev.event_ids.size());
+        }
+        if (file.event_ids.empty())
+        {
+            std::cout << "[WARNING] " << file.filename << " has no events"
+                      << std::endl;
+        }
+    }
+    num_indexed_ = last;
+
+    if (last == files_.size())
+    {
+        auto const& back = files_.back();
+        std::cout << "Indexed " << files_.size() << " files with "
+                  << back.first_id + back.event_ids.size() << " events"
+                  << std::endl;
+    }
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Index batches of one file per thread until an event id is covered, or all
+ * files are indexed.
+ */
+void MultiFileViewer::index_event(int event_id)
+{
+    auto covered = [this, event_id] {
+        if (num_indexed_ == 0)
+        {
+            return false;
+        }
+        auto const& last = files_[num_indexed_ - 1];
+        return event_id - last.first_id
+               < static_cast<std::ptrdiff_t>(last.event_ids.size());
+    };
+    while (num_indexed_ < files_.size() && !covered())
+    {
+        this->index_files(num_indexed_ + this->num_threads());
+    }
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * File index and original id of an event in an indexed file.
+ */
+std::pair<std::size_t, int> MultiFileViewer::locate(int event_id) const
+{
+    auto const num_indexed = num_indexed_.load();
+    auto const end = files_.begin() + num_indexed;
+    auto iter = std::upper_bound(
+        files_.begin(), end, event_id, [](int id, File const& file) {
+            return id < file.first_id;
+        });
+    // Empty files share the first id of the next file and are skipped
+    assert(iter != files_.begin());
+    --iter;
+    auto const index = static_cast<std::size_t>(event_id - iter->first_id);
+    assert(index < iter->event_ids.size());
+    return {static_cast<std::size_t>(iter - files_.begin()),
+            iter->event_ids[index]};
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Create a reader of a single indexed file.
+ */
+auto MultiFileViewer::make_file_reader(std::size_t file) const
+    -> std::unique_ptr<EventReader>
+{
+    assert(file < num_indexed_);
+    return files_[file].viewer->make_reader();
+}
+
+//---------------------------------------------------------------------------//
+// READER
+//---------------------------------------------------------------------------//
+
+//---------------------------------------------------------------------------//
+/*!
+ * Construct with the viewer owning the files.
+ */
+MultiFileViewer::Reader::Reader(MultiFileViewer const& viewer)
+    : viewer_(viewer)
+{
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Decode an event with the reader of its file.
+ *
+ * The reader of the previous file is closed when an event of another file is
+ * requested, so that at most one file per reader is kept open.
+ */
+EventData MultiFileViewer::Reader::operator()(int event_id)
+{
+    auto const location = viewer_.locate(event_id);
+    if (!file_reader_ || location.first != file_)
+    {
+        if (file_reader_)
+        {
+            closed_stats_ += file_reader_->cache_stats();
+        }
+        file_reader_.reset();
+        file_reader_ = viewer_.make_file_reader(location.first);
+        file_ = location.first;
+    }
+
+    auto result = (*file_reader_)(location.second);
+    result.id = event_id;
+    return result;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Input statistics of all files read so far.
+ */
+TreeCacheStats MultiFileViewer::Reader::cache_stats() const
+{
+    auto result = closed_stats_;
+    if (file_reader_)
+    {
+        result += file_reader_->cache_stats();
+    }
+    return result;
+}
@@ -0,0 +1,107 @@
+//----------------------------------*-C++-*----------------------------------//
+// Copyright 2023 UT-Battelle, LLC, and other Celeritas developers.
+// See the top-level COPYRIGHT file for details.
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+//---------------------------------------------------------------------------//
+//! \file src/MultiFileViewer.hh
+//---------------------------------------------------------------------------//
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "MCTruthViewerInterface.hh"
+
+//---------------------------------------------------------------------------//
+/*!
+ * Draw event MC truth data split over many input files, e.g. one file per
+ * MPI rank or job.
+ *
+ * Each file is read by its own concrete viewer. Events are given consecutive
+ * ids across files, in the order of the file list and, within each file, in
+ * increasing order of their original id: the first event of a file follows
+ * the last event of the previous one.
+ *
+ * Files are opened and indexed in parallel, in batches of one file per
+ * thread, and only when an event id beyond the indexed ones is requested.
+ * Showing a single event and moving to its neighbors therefore only opens
+ * the files up to the one holding them, while listing all events indexes
+ * every file.
+ *
+ * This is a secondary class meant to be used along with \c MainViewer , which
+ * *MUST* be initialized before this class is constructed.
+ */
+class MultiFileViewer final : public MCTruthViewerInterface
+{
+  public:
+    //!@{
+    //! \name Type aliases
+    using UPViewer = std::unique_ptr<MCTruthViewerInterface>;
+    using ViewerFactory = std::function<UPViewer(std::string const&)>;
+    //!@}
+
+    // Construct with input filenames, without opening them
+    MultiFileViewer(std::vector<std::string> filenames,
+                    ViewerFactory make_viewer);
+
+    // Default destructor
+    ~MultiFileViewer();
+
+    //! Number of input files
+    std::size_t num_files() const { return files_.size(); }
+
+  protected:
+    // Sorted list of event ids of all files
+    std::vector<int> event_ids() override;
+
+    // Whether an event is available, indexing files only as needed
+    bool has_event(int event_id) override;
+
+    // Available events around an event, indexing files only as needed
+    std::vector<int> neighbor_ids(int event_id, int count) override;
+
+    // Reader switching between files
+    EventReader& reader() override;
+
+    // Create a reader with its own file handles
+    std::unique_ptr<EventReader> make_reader() const override;
+
+  private:
+    class Reader;
+
+    //! Input file and its event ids
+    struct File
+    {
+        std::string filename;
+        UPViewer viewer;
+        std::vector<int> event_ids;  //!< Original ids in the file
+        int first_id{0};  //!< Id of its first event in the merged list
+    };
+
+    //// DATA ////
+
+    ViewerFactory make_viewer_;
+    std::vector<File> files_;
+    std::atomic<std::size_t> num_indexed_{0};
+    std::mutex index_mutex_;
+    std::unique_ptr<Reader> reader_;
+
+    //// HELPER FUNCTIONS ////
+
+    // Open and index the first files of the list
+    void index_files(std::size_t num_files);
+
+    // Index files until an event id is covered, or all files are indexed
+    void index_event(int event_id);
+
+    // File index and original id of an event in an indexed file
+    std::pair<std::size_t, int> locate(int event_id) const;
+
+    // Create a reader of a single indexed file
+    std::unique_ptr<EventReader> make_file_reader(std::size_t file) const;
+};
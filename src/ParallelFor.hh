@@ -0,0 +1,130 @@
+//----------------------------------*-C++-*----------------------------------//
+// Copyright 2023 UT-Battelle, LLC, and other Celeritas developers.
+// See the top-level COPYRIGHT file for details.
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+//---------------------------------------------------------------------------//
+//! \file src/ParallelFor.hh
+//---------------------------------------------------------------------------//
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+//---------------------------------------------------------------------------//
+/*!
+ * Call \c func(index, thread_id) for every index in [0, size), distributing
+ * indices dynamically over \c num_threads threads.
+ *
+ * The calling thread takes part in the loop as thread 0. Thread ids are
+ * always smaller than \c num_threads , so they can be used to address
+ * per-thread state.
+ */
+template<class F>
+void parallel_for(std::size_t size, unsigned int num_threads, F&& func)
+{
+    num_threads = static_cast<unsigned int>(
+        std::max<std::size_t>(1, std::min<std::size_t>(num_threads, size)));
+
+    std::atomic<std::size_t> next{0};
+    auto worker = [&](unsigned int thread_id) {
+        for (auto i = next++; i < size; i = next++)
+        {
+            func(i, thread_id);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (unsigned int t = 1; t < num_threads; t++)
+    {
+        threads.emplace_back(worker, t);
+    }
+    worker(0);
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Element-wise sum of per-thread arrays of \c size elements.
+ *
+ * Empty arrays, e.g. of threads that were never used, are skipped. The sum is
+ * computed in parallel over ranges of elements.
+ */
+template<class T>
+std::vector<T> parallel_sum(std::vector<std::vector<T>> const& arrays,
+                            std::size_t size,
+                            unsigned int num_threads)
+{
+    std::vector<T> result(size, T(0));
+    std::size_t const chunk_size = 1 << 16;
+    parallel_for((size + chunk_size - 1) / chunk_size,
+                 num_threads,
+                 [&](std::size_t chunk, unsigned int) {
+                     auto const first = chunk * chunk_size;
+                     auto const last = std::min(first + chunk_size, size);
+                     for (auto const& array : arrays)
+                     {
+                         if (array.empty())
+                         {
+                             continue;
+                         }
+                         for (auto i = first; i < last; i++)
+                         {
+                             result[i] += array[i];
+                         }
+                     }
+                 });
+    return result;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Sort values on up to \c num_threads threads.
+ *
+ * Sub-ranges of at least \c 2^14 values are sorted in parallel, then pairs
+ * of sorted ranges are merged in parallel.
+ */
+template<class T>
+void parallel_sort(std::vector<T>* values, unsigned int num_threads)
+{
+    std::size_t const min_size = 1 << 14;
+    auto const size = values->size();
+    std::size_t const num_ranges = std::max<std::size_t>(
+        1, std::min<std::size_t>(num_threads, size / min_size));
+    auto bound = [&](std::size_t range) {
+        return values->begin() + size * range / num_ranges;
+    };
+
+    parallel_for(num_ranges, num_threads, [&](std::size_t r, unsigned int) {
+        std::sort(bound(r), bound(r + 1));
+    });
+    for (std::size_t width = 1; width < num_ranges; width *= 2)
+    {
+        parallel_for((num_ranges + 2 * width - 1) / (2 * width),
+                     num_threads,
+                     [&](std::size_t pair, unsigned int) {
+                         auto const first = 2 * width * pair;
+                         auto const middle = first + width;
+                         if (middle < num_ranges)
+                         {
+                             std::inplace_merge(
+                                 bound(first),
+                                 bound(middle),
+                                 bound(std::min(middle + width, num_ranges)));
+                         }
+                     });
+    }
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Default number of worker threads.
+ */
+inline unsigned int default_num_threads()
+{
+    return std::max(1u, std::thread::hardware_concurrency());
+}
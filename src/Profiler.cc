@@ -0,0 +1,172 @@
+//----------------------------------*-C++-*----------------------------------//
+// Copyright 2023 UT-Battelle, LLC, and other Celeritas developers.
+// See the top-level COPYRIGHT file for details.
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+//---------------------------------------------------------------------------//
+//! \file src/Profiler.cc
+//---------------------------------------------------------------------------//
+#include "Profiler.hh"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+
+namespace
+{
+//---------------------------------------------------------------------------//
+using Seconds = std::chrono::duration<double>;
+using Microseconds = std::chrono::duration<double, std::micro>;
+
+//---------------------------------------------------------------------------//
+// Counter labels, in enum order
+char const* const counter_labels[] = {"Bytes read (uncompressed)",
+                                      "Entries decoded",
+                                      "Points created",
+                                      "Eve elements added"};
+
+//---------------------------------------------------------------------------//
+}  // namespace
+
+//---------------------------------------------------------------------------//
+/*!
+ * Access the process-wide instance.
+ */
+Profiler& Profiler::instance()
+{
+    static Profiler profiler;
+    return profiler;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Start recording phases and counters.
+ */
+void Profiler::enable()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    start_time_ = Clock::now();
+    enabled_ = true;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Record a completed phase on the calling thread.
+ */
+void Profiler::record(std::string name,
+                      Clock::time_point start,
+                      Clock::time_point stop)
+{
+    if (!Profiler::enabled())
+    {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    int const thread = this->thread_index(std::this_thread::get_id());
+    phases_.push_back({std::move(name), start, stop - start, thread});
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Print number of calls and time per phase, and counter values.
+ *
+ * Phase times are summed over threads, so phases run on worker threads may
+ * add up to more than the wall-clock time.
+ */
+void Profiler::print_summary() const
+{
+    struct Total
+    {
+        std::size_t count{0};
+        Clock::duration time{0};
+        Clock::duration max{0};
+    };
+
+    std::map<std::string, Total> totals;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto const& phase : phases_)
+        {
+            auto& total = totals[phase.name];
+            total.count++;
+            total.time += phase.duration;
+            total.max = std::max(total.max, phase.duration);
+        }
+    }
+
+    std::cout << std::endl
+              << "Profile:" << std::endl
+              << "  " << std::left << std::setw(30) << "Phase" << std::right
+              << std::setw(10) << "Calls" << std::setw(12) << "Total [s]"
+              << std::setw(12) << "Mean [ms]" << std::setw(12) << "Max [ms]"
+              << std::endl
+              << std::fixed << std::setprecision(3);
+    for (auto const& name_total : totals)
+    {
+        auto const& total = name_total.second;
+        double const time = Seconds(total.time).count();
+        std::cout << "  " << std::left << std::setw(30) << name_total.first
+                  << std::right << std::setw(10) << total.count
+                  << std::setw(12) << time << std::setw(12)
+                  << 1e3 * time / total.count << std::setw(12)
+                  << 1e3 * Seconds(total.max).count() << std::endl;
+    }
+    std::cout << std::defaultfloat;
+
+    for (int i = 0; i < static_cast<int>(Counter::size_); i++)
+    {
+        std::cout << "  " << std::left << std::setw(30) << counter_labels[i]
+                  << std::right << std::setw(10) << counters_[i].load()
+                  << std::endl;
+    }
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Write recorded phases as complete ("X") events of the Chrome trace-event
+ * format, one trace row per thread.
+ */
+void Profiler::write_trace(std::string const& filename) const
+{
+    std::ofstream out(filename);
+    if (!out)
+    {
+        std::cout << "[WARNING] Could not write profile trace to " << filename
+                  << std::endl;
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    out << "{\"traceEvents\": [\n" << std::fixed << std::setprecision(3);
+    for (std::size_t i = 0; i < phases_.size(); i++)
+    {
+        auto const& phase = phases_[i];
+        out << "  {\"name\": \"" << phase.name
+            << "\", \"ph\": \"X\", \"pid\": 0, \"tid\": " << phase.thread
+            << ", \"ts\": " << Microseconds(phase.start - start_time_).count()
+            << ", \"dur\": " << Microseconds(phase.duration).count() << "}"
+            << (i + 1 < phases_.size() ? ",\n" : "\n");
+    }
+    out << "]}\n";
+    std::cout << "Profile trace: " << filename << std::endl;
+}
+
+//---------------------------------------------------------------------------//
+// PRIVATE
+//---------------------------------------------------------------------------//
+
+//---------------------------------------------------------------------------//
+/*!
+ * Small index of a thread, in order of first use. The mutex must be held.
+ */
+int Profiler::thread_index(std::thread::id id)
+{
+    auto iter = std::find(threads_.begin(), threads_.end(), id);
+    if (iter == threads_.end())
+    {
+        threads_.push_back(id);
+        return threads_.size() - 1;
+    }
+    return iter - threads_.begin();
+}
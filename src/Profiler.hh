@@ -0,0 +1,149 @@
+//----------------------------------*-C++-*----------------------------------//
+// Copyright 2023 UT-Battelle, LLC, and other Celeritas developers.
+// See the top-level COPYRIGHT file for details.
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+//---------------------------------------------------------------------------//
+//! \file src/Profiler.hh
+//---------------------------------------------------------------------------//
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+//---------------------------------------------------------------------------//
+/*!
+ * Process-wide phase timers and counters, enabled with the \c -profile flag.
+ *
+ * Timed phases are recorded with their start time and thread, so that they
+ * can be summarized per phase name and written as a Chrome trace-event file
+ * (viewable in \c chrome://tracing or Perfetto). When profiling is disabled,
+ * timers and counters only cost a relaxed atomic load.
+ *
+ * \code
+ *  Profiler::instance().enable();
+ *  {
+ *      ScopedTimer timer("GetEntry");
+ *      Profiler::add(Profiler::Counter::bytes_read, tree->GetEntry(i));
+ *  }
+ *  Profiler::instance().print_summary();
+ * \endcode
+ */
+class Profiler
+{
+  public:
+    //!@{
+    //! \name Type aliases
+    using Clock = std::chrono::steady_clock;
+    //!@}
+
+    //! Accumulated quantities
+    enum class Counter
+    {
+        bytes_read,  //!< Uncompressed bytes returned by GetEntry
+        entries_decoded,  //!< Tree entries (or events) decoded
+        points_created,  //!< Track points passed to Eve
+        elements_added,  //!< Eve elements added to the event scene
+        size_
+    };
+
+    // Access the process-wide instance
+    static Profiler& instance();
+
+    //! Whether phases and counters are recorded
+    static bool enabled()
+    {
+        return instance().enabled_.load(std::memory_order_relaxed);
+    }
+
+    //! Increment a counter
+    static void add(Counter counter, std::uint64_t value)
+    {
+        if (enabled())
+        {
+            instance().counters_[static_cast<int>(counter)].fetch_add(
+                value, std::memory_order_relaxed);
+        }
+    }
+
+    // Start recording
+    void enable();
+
+    // Record a completed phase
+    void record(std::string name,
+                Clock::time_point start,
+                Clock::time_point stop);
+
+    // Print time per phase and counter values
+    void print_summary() const;
+
+    // Write recorded phases as a Chrome trace-event JSON file
+    void write_trace(std::string const& filename) const;
+
+  private:
+    //// TYPES ////
+
+    struct Phase
+    {
+        std::string name;
+        Clock::time_point start;
+        Clock::duration duration;
+        int thread;
+    };
+
+    //// DATA ////
+
+    std::atomic<bool> enabled_{false};
+    std::array<std::atomic<std::uint64_t>, static_cast<int>(Counter::size_)>
+        counters_{};
+    Clock::time_point start_time_;
+    mutable std::mutex mutex_;
+    std::vector<Phase> phases_;
+    std::vector<std::thread::id> threads_;
+
+    //// HELPER FUNCTIONS ////
+
+    Profiler() = default;
+    int thread_index(std::thread::id id);
+};
+
+//---------------------------------------------------------------------------//
+/*!
+ * Record the lifetime of a scope as a profiler phase.
+ */
+class ScopedTimer
+{
+  public:
+    //! Start timing if profiling is enabled
+    explicit ScopedTimer(char const* name)
+        : name_(name)
+        , start_(Profiler::enabled() ? Profiler::Clock::now()
+                                     : Profiler::Clock::time_point{})
+    {
+    }
+
+    //! Record the phase
+    ~ScopedTimer()
+    {
+        if (start_ != Profiler::Clock::time_point{})
+        {
+            Profiler::instance().record(
+                name_, start_, Profiler::Clock::now());
+        }
+    }
+
+    //!@{
+    //! Prevent copying and moving
+    ScopedTimer(ScopedTimer const&) = delete;
+    ScopedTimer& operator=(ScopedTimer const&) = delete;
+    //!@}
+
+  private:
+    char const* name_;
+    Profiler::Clock::time_point start_;
+};
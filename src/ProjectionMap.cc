@@ -0,0 +1,374 @@
+//----------------------------------*-C++-*----------------------------------//
+// Copyright 2023 UT-Battelle, LLC, and other Celeritas developers.
+// See the top-level COPYRIGHT file for details.
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+//---------------------------------------------------------------------------//
+//! \file src/ProjectionMap.cc
+//---------------------------------------------------------------------------//
+#include "ProjectionMap.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <TEveQuadSet.h>
+#include <TEveRGBAPalette.h>
+#include <assert.h>
+#include <stdlib.h>
+
+#include "MCTruthViewerInterface.hh"
+#include "ParallelFor.hh"
+#include "Profiler.hh"
+
+namespace
+{
+//---------------------------------------------------------------------------//
+// Number of planes
+constexpr int num_planes = static_cast<int>(MainViewer::Projection::size_);
+
+//---------------------------------------------------------------------------//
+}  // namespace
+
+//---------------------------------------------------------------------------//
+/*!
+ * Construct with the binned region [cm], number of bins along each axis of a
+ * plane, and histogrammed quantity.
+ */
+ProjectionMap::ProjectionMap(BoundingBox const& box,
+                             unsigned int num_bins,
+                             Quantity quantity)
+    : box_(box), num_bins_(num_bins), quantity_(quantity)
+{
+    if (num_bins_ == 0 || !box_)
+    {
+        std::cout << "[ERROR] Projection histograms must have a positive "
+                     "size along each axis"
+                  << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < 3; i++)
+    {
+        inv_width_[i] = num_bins_ / (box_.upper[i] - box_.lower[i]);
+    }
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Histogram the steps of all selected events.
+ *
+ * Events are decoded and histogrammed on the viewer's worker threads. Each
+ * thread allocates its histograms when it adds its first event, and the
+ * histograms are summed in parallel, one range of bins per thread.
+ */
+void ProjectionMap::fill(MCTruthViewerInterface& viewer)
+{
+    ScopedTimer timer("Projection histograms");
+    this->begin(viewer);
+    viewer.scan_events([this](EventData const& event, unsigned int thread_id) {
+        this->add(event, thread_id);
+    });
+    this->finish(viewer);
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Prepare one tally per thread of the viewer, and decode the energy
+ * deposited along the steps if it is histogrammed.
+ */
+void ProjectionMap::begin(MCTruthViewerInterface& viewer)
+{
+    start_ = std::chrono::steady_clock::now();
+    viewer.set_decode_energy_deposition(quantity_ == Quantity::energy);
+    tallies_.assign(viewer.num_threads(), {});
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Histogram the steps of an event in the tally of the thread that decoded
+ * it, allocating the tally's histograms on its first event.
+ *
+ * Thread ids must be smaller than the number of threads of the viewer passed
+ * to \c begin , and each id must be used by a single thread at a time.
+ */
+void ProjectionMap::add(EventData const& event, unsigned int thread_id)
+{
+    assert(thread_id < tallies_.size());
+    auto& tally = tallies_[thread_id];
+    if (tally.histograms[0].empty())
+    {
+        std::size_t const size = std::size_t(num_bins_) * num_bins_;
+        for (auto& histogram : tally.histograms)
+        {
+            histogram.assign(size, 0);
+        }
+    }
+    this->add(event, &tally);
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Sum per-thread histograms and release them.
+ *
+ * Tracks drawn afterwards do not need energy deposits, so they are no longer
+ * decoded.
+ */
+void ProjectionMap::finish(MCTruthViewerInterface& viewer)
+{
+    bool const energy = quantity_ == Quantity::energy;
+    viewer.set_decode_energy_deposition(false);
+
+    std::size_t const size = std::size_t(num_bins_) * num_bins_;
+    std::size_t num_steps = 0;
+    for (int plane = 0; plane < num_planes; plane++)
+    {
+        std::vector<std::vector<double>> partial;
+        for (auto& tally : tallies_)
+        {
+            partial.push_back(std::move(tally.histograms[plane]));
+        }
+        histograms_[plane] = parallel_sum(partial, size, viewer.num_threads());
+    }
+    for (auto const& tally : tallies_)
+    {
+        num_steps += tally.num_steps;
+    }
+    tallies_.clear();
+
+    std::chrono::duration<double> const time
+        = std::chrono::steady_clock::now() - start_;
+    std::cout << "Projection histograms: " << num_steps << " steps in "
+              << num_bins_ << "x" << num_bins_ << " bins, in " << time.count()
+              << " s" << std::endl;
+    if (num_steps == 0)
+    {
+        std::cout << "[WARNING] No " << (energy ? "energy deposition" : "step")
+                  << " found inside the projected region" << std::endl;
+    }
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Create a quad set with the non-empty bins of a plane.
+ *
+ * Bin values are stored in mm of track length or keV of deposited energy,
+ * and colored with a palette spanning the smallest and largest non-empty
+ * bins; its limits can be changed in the element editor. Quads lie on the
+ * face of the region closest to the origin along the projected axis.
+ */
+TEveQuadSet* ProjectionMap::make_quads(Plane plane) const
+{
+    bool const energy = quantity_ == Quantity::energy;
+    int const p = static_cast<int>(plane);
+    assert(p < num_planes);
+    auto const ax = ProjectionMap::axes(p);
+    int const fixed_axis = 3 - ax[0] - ax[1];
+
+    int min_value = std::numeric_limits<int>::max();
+    int max_value = 0;
+    // Convert MeV to keV or cm to mm
+    double const scale = energy ? 1e3 : 1e1;
+    auto to_digit = [scale](double value) {
+        double const rounded = std::round(scale * value);
+        return static_cast<int>(
+            std::min<double>(rounded, std::numeric_limits<int>::max()));
+    };
+
+    static TEveQuadSet::EQuadType_e const quad_types[]
+        = {TEveQuadSet::kQT_RectangleXYFixedDimZ,
+           TEveQuadSet::kQT_RectangleYZFixedDimX,
+           TEveQuadSet::kQT_RectangleXZFixedDimY};
+    static char const* const names[] = {"XY", "ZY", "XZ"};
+
+    auto* quads = new TEveQuadSet(
+        (std::string(names[p]) + (energy ? " energy" : " track length"))
+            .c_str(),
+        energy ? "Deposited energy per bin [keV]"
+               : "Track length per bin [mm]");
+    quads->Reset(quad_types[p], kFALSE, 4096);
+    quads->SetDefWidth(1 / inv_width_[ax[0]]);
+    quads->SetDefHeight(1 / inv_width_[ax[1]]);
+    quads->SetDefCoord(box_.lower[fixed_axis]);
+
+    auto const& histogram = histograms_[p];
+    std::size_t index = 0;
+    for (unsigned int j = 0; j < num_bins_; j++)
+    {
+        for (unsigned int i = 0; i < num_bins_; i++, index++)
+        {
+            int const value = to_digit(histogram[index]);
+            if (value <= 0)
+            {
+                continue;
+            }
+            quads->AddQuad(box_.lower[ax[0]] + i / inv_width_[ax[0]],
+                           box_.lower[ax[1]] + j / inv_width_[ax[1]]);
+            quads->QuadValue(value);
+            min_value = std::min(min_value, value);
+            max_value = std::max(max_value, value);
+        }
+    }
+    quads->RefitPlex();
+    Profiler::add(Profiler::Counter::elements_added, 1);
+
+    if (max_value == 0)
+    {
+        // Empty histogram: keep a valid palette range
+        min_value = 0;
+        max_value = 1;
+    }
+    quads->SetPalette(new TEveRGBAPalette(min_value, max_value));
+    return quads;
+}
+
+//---------------------------------------------------------------------------//
+// PRIVATE
+//---------------------------------------------------------------------------//
+
+//---------------------------------------------------------------------------//
+/*!
+ * Binned axes of a plane, in the order of the quad coordinates.
+ *
+ * Quads of the ZY plane are given as (y, z), matching
+ * \c TEveQuadSet::kQT_RectangleYZFixedDimX .
+ */
+std::array<int, 2> ProjectionMap::axes(int plane)
+{
+    static std::array<int, 2> const result[] = {{0, 1}, {1, 2}, {0, 2}};
+    return result[plane];
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Add the steps of an event to a thread's tally.
+ *
+ * Steps are clipped to the binned region. Track length is split into samples
+ * no longer than a bin along any axis, each added at its midpoint, so that
+ * every bin crossed by a step gets its share of the length.
+ */
+void ProjectionMap::add(EventData const& event, Tally* tally) const
+{
+    bool const energy = quantity_ == Quantity::energy;
+    auto const& deposits = event.energy_deposits;
+    if (energy && deposits.empty())
+    {
+        return;
+    }
+    assert(!energy || deposits.size() == event.points.size());
+
+    for (std::size_t t = 0; t < event.num_tracks(); t++)
+    {
+        for (auto p = event.offsets[t] + 1; p < event.offsets[t + 1]; p++)
+        {
+            auto const& pre = event.points[p - 1];
+            auto const& post = event.points[p];
+            double start[3];
+            double dir[3];
+            for (int i = 0; i < 3; i++)
+            {
+                start[i] = pre[i];
+                dir[i] = double(post[i]) - double(pre[i]);
+            }
+
+            if (energy)
+            {
+                if (!(deposits[p] > 0))
+                {
+                    continue;
+                }
+                double mid[3];
+                for (int i = 0; i < 3; i++)
+                {
+                    mid[i] = start[i] + dir[i] / 2;
+                }
+                this->add(mid, deposits[p], tally);
+                continue;
+            }
+
+            // Clip the step to the region
+            double t_min = 0;
+            double t_max = 1;
+            for (int i = 0; i < 3 && t_min < t_max; i++)
+            {
+                if (dir[i] == 0)
+                {
+                    if (start[i] < box_.lower[i] || start[i] >= box_.upper[i])
+                    {
+                        t_max = 0;
+                    }
+                    continue;
+                }
+                double t_lower = (box_.lower[i] - start[i]) / dir[i];
+                double t_upper = (box_.upper[i] - start[i]) / dir[i];
+                if (t_lower > t_upper)
+                {
+                    std::swap(t_lower, t_upper);
+                }
+                t_min = std::max(t_min, t_lower);
+                t_max = std::min(t_max, t_upper);
+            }
+            if (!(t_min < t_max))
+            {
+                continue;
+            }
+
+            // Sample the clipped step once per bin crossed
+            double num_samples = 1;
+            for (int i = 0; i < 3; i++)
+            {
+                num_samples = std::max(
+                    num_samples,
+                    std::ceil(std::fabs(dir[i]) * (t_max - t_min)
+                              * inv_width_[i]));
+            }
+            double const length
+                = std::sqrt(dir[0] * dir[0] + dir[1] * dir[1]
+                            + dir[2] * dir[2])
+                  * (t_max - t_min);
+            double const dt = (t_max - t_min) / num_samples;
+            for (double s = 0; s < num_samples; s++)
+            {
+                double const u = t_min + (s + 0.5) * dt;
+                double pos[3];
+                for (int i = 0; i < 3; i++)
+                {
+                    pos[i] = start[i] + u * dir[i];
+                }
+                this->add(pos, length / num_samples, tally);
+            }
+            ++tally->num_steps;
+        }
+    }
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Add a value at a position to all planes, if it is inside the region.
+ */
+void ProjectionMap::add(double const* pos, double value, Tally* tally) const
+{
+    unsigned int bins[3];
+    for (int i = 0; i < 3; i++)
+    {
+        double const bin
+            = std::floor((pos[i] - box_.lower[i]) * inv_width_[i]);
+        if (!(bin >= 0 && bin < num_bins_))
+        {
+            return;
+        }
+        bins[i] = static_cast<unsigned int>(bin);
+    }
+    if (quantity_ == Quantity::energy)
+    {
+        ++tally->num_steps;
+    }
+
+    for (int p = 0; p < num_planes; p++)
+    {
+        auto const ax = ProjectionMap::axes(p);
+        tally->histograms[p][std::size_t(bins[ax[1]]) * num_bins_
+                             + bins[ax[0]]]
+            += value;
+    }
+}
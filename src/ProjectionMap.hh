@@ -0,0 +1,119 @@
+//----------------------------------*-C++-*----------------------------------//
+// Copyright 2023 UT-Battelle, LLC, and other Celeritas developers.
+// See the top-level COPYRIGHT file for details.
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+//---------------------------------------------------------------------------//
+//! \file src/ProjectionMap.hh
+//---------------------------------------------------------------------------//
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <vector>
+
+#include "BoundingBox.hh"
+#include "EventData.hh"
+#include "MainViewer.hh"
+
+class MCTruthViewerInterface;
+class TEveQuadSet;
+
+//---------------------------------------------------------------------------//
+/*!
+ * 2D histograms of track length or deposited energy, projected on the planes
+ * of the orthographic viewers.
+ *
+ * Only steps inside the binned box contribute. Track length is sampled along
+ * each step at least once per bin, so that long steps are spread over all the
+ * bins they cross; deposited energy is assigned to the bin of the step
+ * midpoint. Histograms are filled on worker threads, each with its own copy,
+ * and summed once all events are scanned.
+ *
+ * Histograms can also be filled from the events decoded by a background load:
+ * \c begin prepares the per-thread copies, \c add is called on the thread
+ * that decoded each event, and \c finish sums them once loading is done.
+ *
+ * Each histogram is drawn as a single quad set, which replaces the event
+ * scene of its projection viewer: the cost of rendering the projections
+ * depends on the number of bins only, not on the number of tracks.
+ *
+ * \code
+ *  ProjectionMap map(geometry_bbox(), 512, ProjectionMap::Quantity::length);
+ *  map.fill(viewer);
+ *  evd.set_projection(Plane::xy, map.make_quads(Plane::xy));
+ * \endcode
+ */
+class ProjectionMap
+{
+  public:
+    //!@{
+    //! \name Type aliases
+    using Plane = MainViewer::Projection;
+    //!@}
+
+    //! Histogrammed quantity
+    enum class Quantity
+    {
+        length,  //!< Track length [cm]
+        energy  //!< Deposited energy [MeV]
+    };
+
+    // Construct with binned region, bins per axis, and quantity
+    ProjectionMap(BoundingBox const& box,
+                  unsigned int num_bins,
+                  Quantity quantity);
+
+    // Histogram the steps of all selected events on worker threads
+    void fill(MCTruthViewerInterface& viewer);
+
+    // Prepare per-thread histograms for the events decoded by a viewer
+    void begin(MCTruthViewerInterface& viewer);
+
+    // Histogram the steps of an event on the thread that decoded it
+    void add(EventData const& event, unsigned int thread_id);
+
+    // Sum per-thread histograms
+    void finish(MCTruthViewerInterface& viewer);
+
+    // Create a quad set with the non-empty bins of a plane
+    TEveQuadSet* make_quads(Plane plane) const;
+
+    //! Histogram of a plane, first axis of the plane varying fastest
+    std::vector<double> const& histogram(Plane plane) const
+    {
+        return histograms_[static_cast<int>(plane)];
+    }
+
+  private:
+    //// TYPES ////
+
+    using Histograms = std::array<std::vector<double>, 3>;
+
+    //! Partial results of a single thread
+    struct Tally
+    {
+        Histograms histograms;
+        std::size_t num_steps{0};
+    };
+
+    //// DATA ////
+
+    BoundingBox box_;
+    unsigned int num_bins_;
+    Quantity quantity_;
+    std::array<double, 3> inv_width_;  //!< Bins per cm along each axis
+    Histograms histograms_;
+    std::vector<Tally> tallies_;  //!< Per thread, between begin and finish
+    std::chrono::steady_clock::time_point start_;
+
+    //// HELPER FUNCTIONS ////
+
+    // Binned axes of a plane, in the order used by its quads
+    static std::array<int, 2> axes(int plane);
+
+    // Add the steps of an event to a thread's tally
+    void add(EventData const& event, Tally* tally) const;
+
+    // Add a value at a position to all planes
+    void add(double const* pos, double value, Tally* tally) const;
+};
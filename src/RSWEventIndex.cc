@@ -0,0 +1,606 @@
+//----------------------------------*-C++-*----------------------------------//
+// Copyright 2023 UT-Battelle, LLC, and other Celeritas developers.
+// See the top-level COPYRIGHT file for details.
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+//---------------------------------------------------------------------------//
+//! \file src/RSWEventIndex.cc
+//---------------------------------------------------------------------------//
+#include "RSWEventIndex.hh"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <TSystem.h>
+#include <assert.h>
+
+#include "Profiler.hh"
+
+namespace
+{
+//---------------------------------------------------------------------------//
+// Sidecar file magic string, including format version
+char const sidecar_magic[8] = {'E', 'V', 'D', 'I', 'D', 'X', '0', '3'};
+
+//---------------------------------------------------------------------------//
+// Number of entries whose event and track ids are decoded at once
+constexpr Long64_t build_chunk_size = Long64_t(1) << 20;
+
+//---------------------------------------------------------------------------//
+// Pack event and track ids into a key that sorts like the (event, track) pair
+std::uint64_t pack_track(std::int32_t event_id, std::int32_t track_id)
+{
+    auto biased = [](std::int32_t id) {
+        return static_cast<std::uint64_t>(static_cast<std::uint32_t>(id)
+                                          ^ 0x80000000u);
+    };
+    return (biased(event_id) << 32) | biased(track_id);
+}
+
+std::int32_t unpack_event(std::uint64_t key)
+{
+    return static_cast<std::int32_t>(static_cast<std::uint32_t>(key >> 32)
+                                     ^ 0x80000000u);
+}
+
+std::int32_t unpack_track(std::uint64_t key)
+{
+    return static_cast<std::int32_t>(static_cast<std::uint32_t>(key)
+                                     ^ 0x80000000u);
+}
+
+//---------------------------------------------------------------------------//
+template<class T>
+void write_pod(std::ostream& os, T const& value)
+{
+    os.write(reinterpret_cast<char const*>(&value), sizeof(T));
+}
+
+template<class T>
+bool read_pod(std::istream& is, T* value)
+{
+    is.read(reinterpret_cast<char*>(value), sizeof(T));
+    return static_cast<bool>(is);
+}
+
+template<class T>
+void write_vector(std::ostream& os, std::vector<T> const& vec)
+{
+    write_pod(os, static_cast<std::uint64_t>(vec.size()));
+    os.write(reinterpret_cast<char const*>(vec.data()),
+             vec.size() * sizeof(T));
+}
+
+// Number of bytes left in a file stream
+std::uint64_t remaining_bytes(std::istream& is)
+{
+    auto const pos = is.tellg();
+    is.seekg(0, std::ios::end);
+    auto const end = is.tellg();
+    is.seekg(pos);
+    if (pos < 0 || end < pos)
+    {
+        return 0;
+    }
+    return static_cast<std::uint64_t>(end - pos);
+}
+
+// Read a vector, rejecting sizes larger than the rest of the file
+template<class T>
+bool read_vector(std::istream& is, std::vector<T>* vec)
+{
+    std::uint64_t size{0};
+    if (!read_pod(is, &size) || size > remaining_bytes(is) / sizeof(T))
+    {
+        return false;
+    }
+    vec->resize(size);
+    is.read(reinterpret_cast<char*>(vec->data()), size * sizeof(T));
+    return static_cast<bool>(is);
+}
+
+//---------------------------------------------------------------------------//
+// Copy a field to or from a serialized record
+template<class T>
+char* put_field(T const& value, char* out)
+{
+    std::memcpy(out, &value, sizeof(T));
+    return out + sizeof(T);
+}
+
+template<class T>
+char const* get_field(char const* in, T* value)
+{
+    std::memcpy(value, in, sizeof(T));
+    return in + sizeof(T);
+}
+
+//---------------------------------------------------------------------------//
+// Field by field layout of the stored ranges, independent of struct padding
+template<class T>
+struct Record;
+
+template<>
+struct Record<RSWEventIndex::TrackRange>
+{
+    using size_type = RSWEventIndex::size_type;
+    static constexpr std::size_t size = sizeof(std::int32_t)
+                                        + 2 * sizeof(size_type);
+
+    static char* encode(RSWEventIndex::TrackRange const& track, char* out)
+    {
+        out = put_field(track.track_id, out);
+        out = put_field(track.begin, out);
+        return put_field(track.end, out);
+    }
+
+    static char const* decode(char const* in, RSWEventIndex::TrackRange* track)
+    {
+        in = get_field(in, &track->track_id);
+        in = get_field(in, &track->begin);
+        return get_field(in, &track->end);
+    }
+};
+
+template<>
+struct Record<RSWEventIndex::EventRange>
+{
+    using size_type = RSWEventIndex::size_type;
+    static constexpr std::size_t size = sizeof(std::int32_t)
+                                        + 4 * sizeof(size_type);
+
+    static char* encode(RSWEventIndex::EventRange const& event, char* out)
+    {
+        out = put_field(event.event_id, out);
+        out = put_field(event.begin, out);
+        out = put_field(event.end, out);
+        out = put_field(event.track_begin, out);
+        return put_field(event.track_end, out);
+    }
+
+    static char const* decode(char const* in, RSWEventIndex::EventRange* event)
+    {
+        in = get_field(in, &event->event_id);
+        in = get_field(in, &event->begin);
+        in = get_field(in, &event->end);
+        in = get_field(in, &event->track_begin);
+        return get_field(in, &event->track_end);
+    }
+};
+
+// Write a vector of ranges field by field
+template<class T>
+void write_records(std::ostream& os, std::vector<T> const& vec)
+{
+    std::vector<char> buffer(vec.size() * Record<T>::size);
+    char* out = buffer.data();
+    for (auto const& value : vec)
+    {
+        out = Record<T>::encode(value, out);
+    }
+    write_pod(os, static_cast<std::uint64_t>(vec.size()));
+    os.write(buffer.data(), buffer.size());
+}
+
+// Read a vector of ranges, rejecting sizes larger than the rest of the file
+template<class T>
+bool read_records(std::istream& is, std::vector<T>* vec)
+{
+    std::uint64_t size{0};
+    if (!read_pod(is, &size) || size > remaining_bytes(is) / Record<T>::size)
+    {
+        return false;
+    }
+    std::vector<char> buffer(size * Record<T>::size);
+    if (!is.read(buffer.data(), buffer.size()))
+    {
+        return false;
+    }
+    vec->resize(size);
+    char const* in = buffer.data();
+    for (auto& value : *vec)
+    {
+        in = Record<T>::decode(in, &value);
+    }
+    return true;
+}
+
+//---------------------------------------------------------------------------//
+}  // namespace
+
+//---------------------------------------------------------------------------//
+/*!
+ * Load the index from its sidecar file if it is up to date. Otherwise build
+ * it from the steps tree and save it for later runs.
+ */
+RSWEventIndex
+RSWEventIndex::load_or_build(TFile& tfile, TTree& ttree, RSWStepReader& reader)
+{
+    RSWEventIndex result;
+    auto const key = RSWEventIndex::make_key(tfile, ttree);
+    auto const filename = RSWEventIndex::sidecar_filename(tfile);
+
+    bool loaded;
+    {
+        ScopedTimer timer("Event index read");
+        loaded = result.read(filename, key);
+    }
+    if (loaded)
+    {
+        std::cout << "Event index: " << filename << " ("
+                  << result.events_.size() << " events)" << std::endl;
+        return result;
+    }
+
+    {
+        ScopedTimer timer("Event index build");
+        result.build(key.num_entries, reader);
+    }
+    if (result.write(filename, key))
+    {
+        std::cout << "Event index: built and saved to " << filename << " ("
+                  << result.events_.size() << " events)" << std::endl;
+    }
+    else
+    {
+        std::cout << "[WARNING] Could not write event index to " << filename
+                  << std::endl;
+    }
+    return result;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Find the entry range of an event by binary search.
+ */
+auto RSWEventIndex::find(int event_id) const -> EventRange const*
+{
+    auto iter = std::lower_bound(
+        events_.begin(),
+        events_.end(),
+        event_id,
+        [](EventRange const& lhs, int id) { return lhs.event_id < id; });
+
+    if (iter == events_.end() || iter->event_id != event_id)
+    {
+        return nullptr;
+    }
+    return &*iter;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Number of tree entries of a track.
+ */
+auto RSWEventIndex::num_entries(TrackRange const& track) const -> size_type
+{
+    if (!entries_.empty())
+    {
+        return track.end - track.begin;
+    }
+    size_type result = 0;
+    for (auto r = track.begin; r < track.end; r++)
+    {
+        result += runs_[r].end - runs_[r].begin;
+    }
+    return result;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Append the tree entries of a track, in increasing order.
+ */
+void RSWEventIndex::append_entries(TrackRange const& track,
+                                   std::vector<Long64_t>* entries) const
+{
+    this->append_range(track.begin, track.end, entries);
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Tree entries of an event, grouped by track in the order of \c tracks() .
+ */
+std::vector<Long64_t> RSWEventIndex::entries(EventRange const& event) const
+{
+    std::vector<Long64_t> result;
+    this->append_range(event.begin, event.end, &result);
+    return result;
+}
+
+//---------------------------------------------------------------------------//
+// PRIVATE
+//---------------------------------------------------------------------------//
+
+//---------------------------------------------------------------------------//
+/*!
+ * Collect the properties used to validate a sidecar file.
+ */
+auto RSWEventIndex::make_key(TFile& tfile, TTree& ttree) -> FileKey
+{
+    FileKey key;
+    key.uuid = tfile.GetUUID().AsString();
+    key.num_entries = ttree.GetEntries();
+
+    FileStat_t stat;
+    if (gSystem->GetPathInfo(tfile.GetName(), stat) == 0)
+    {
+        key.mtime = stat.fMtime;
+        key.size = stat.fSize;
+    }
+    return key;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Sidecar filename, stored next to the ROOT file.
+ */
+std::string RSWEventIndex::sidecar_filename(TFile const& tfile)
+{
+    return std::string(tfile.GetName()) + ".evdidx";
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Build the index in a single streaming pass over the event and track ids.
+ *
+ * Ids are decoded in chunks, and consecutive entries of the same track are
+ * merged into runs as they are read. As soon as runs outnumber half of the
+ * entries read so far, e.g. for interleaved input, the runs are expanded
+ * into (packed event and track id, entry) pairs of 16 bytes, and later
+ * entries are appended as such pairs. Either list is then sorted in place,
+ * which is a no-op for input written one track at a time.
+ */
+void RSWEventIndex::build(Long64_t num_entries, RSWStepReader& reader)
+{
+    //! Run of consecutive entries of a track
+    struct TrackRun
+    {
+        std::uint64_t key;
+        EntryRun entries;
+    };
+
+    //! Single entry of a track
+    struct TrackEntry
+    {
+        std::uint64_t key;
+        Long64_t entry;
+    };
+
+    std::vector<TrackRun> runs;
+    std::vector<TrackEntry> keyed;
+    bool keep_runs = true;
+    RSWStepColumns columns;
+    for (Long64_t first = 0; first < num_entries; first += build_chunk_size)
+    {
+        auto const last = std::min(first + build_chunk_size, num_entries);
+        reader.read(first,
+                    last,
+                    RSWStepReader::event_id | RSWStepReader::track_id,
+                    &columns);
+        for (std::size_t i = 0; i < columns.num_rows; i++)
+        {
+            auto const key
+                = pack_track(columns.event_id[i], columns.track_id[i]);
+            Long64_t const entry = first + i;
+            if (!keep_runs)
+            {
+                keyed.push_back({key, entry});
+            }
+            else if (!runs.empty() && runs.back().key == key)
+            {
+                runs.back().entries.end = entry + 1;
+            }
+            else
+            {
+                runs.push_back({key, {entry, entry + 1}});
+            }
+        }
+
+        // Runs take twice the space of entries: only keep them if they pay off
+        if (keep_runs && runs.size() > static_cast<std::size_t>(last / 2))
+        {
+            keep_runs = false;
+            keyed.reserve(num_entries);
+            for (auto const& run : runs)
+            {
+                for (auto e = run.entries.begin; e < run.entries.end; e++)
+                {
+                    keyed.push_back({run.key, e});
+                }
+            }
+            runs.clear();
+            runs.shrink_to_fit();
+        }
+    }
+
+    events_.clear();
+    tracks_.clear();
+    runs_.clear();
+    entries_.clear();
+
+    // Extend the last track with [begin, end), starting a new track or event
+    auto extend = [this](std::uint64_t key, size_type begin, size_type end) {
+        auto const event_id = unpack_event(key);
+        auto const track_id = unpack_track(key);
+        if (events_.empty() || events_.back().event_id != event_id)
+        {
+            events_.push_back(
+                {event_id, begin, begin, tracks_.size(), tracks_.size()});
+            tracks_.push_back({track_id, begin, begin});
+        }
+        else if (tracks_.back().track_id != track_id)
+        {
+            tracks_.push_back({track_id, begin, begin});
+        }
+        events_.back().end = end;
+        events_.back().track_end = tracks_.size();
+        tracks_.back().end = end;
+    };
+
+    if (keep_runs)
+    {
+        // Runs of a track never overlap: sorting by first entry is stable
+        auto by_track = [](TrackRun const& lhs, TrackRun const& rhs) {
+            return std::make_pair(lhs.key, lhs.entries.begin)
+                   < std::make_pair(rhs.key, rhs.entries.begin);
+        };
+        if (!std::is_sorted(runs.begin(), runs.end(), by_track))
+        {
+            std::sort(runs.begin(), runs.end(), by_track);
+        }
+        runs_.reserve(runs.size());
+        for (auto const& run : runs)
+        {
+            runs_.push_back(run.entries);
+            extend(run.key, runs_.size() - 1, runs_.size());
+        }
+        return;
+    }
+
+    auto by_track = [](TrackEntry const& lhs, TrackEntry const& rhs) {
+        return std::make_pair(lhs.key, lhs.entry)
+               < std::make_pair(rhs.key, rhs.entry);
+    };
+    if (!std::is_sorted(keyed.begin(), keyed.end(), by_track))
+    {
+        std::sort(keyed.begin(), keyed.end(), by_track);
+    }
+    entries_.reserve(keyed.size());
+    for (auto const& entry : keyed)
+    {
+        entries_.push_back(entry.entry);
+        extend(entry.key, entries_.size() - 1, entries_.size());
+    }
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Read sidecar file, returning false if it is missing or stale.
+ */
+bool RSWEventIndex::read(std::string const& filename, FileKey const& key)
+{
+    std::ifstream input(filename, std::ios::binary);
+    if (!input)
+    {
+        return false;
+    }
+
+    char magic[sizeof(sidecar_magic)];
+    input.read(magic, sizeof(magic));
+    if (!input || std::memcmp(magic, sidecar_magic, sizeof(magic)) != 0)
+    {
+        return false;
+    }
+
+    std::vector<char> uuid;
+    FileKey stored;
+    if (!read_vector(input, &uuid) || !read_pod(input, &stored.mtime)
+        || !read_pod(input, &stored.size)
+        || !read_pod(input, &stored.num_entries))
+    {
+        return false;
+    }
+    stored.uuid.assign(uuid.begin(), uuid.end());
+
+    if (stored.uuid != key.uuid || stored.mtime != key.mtime
+        || stored.size != key.size || stored.num_entries != key.num_entries)
+    {
+        // Sidecar belongs to a different or modified file
+        return false;
+    }
+
+    return read_records(input, &events_) && read_records(input, &tracks_)
+           && read_vector(input, &runs_) && read_vector(input, &entries_)
+           && this->consistent(key.num_entries);
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Write sidecar file.
+ */
+bool RSWEventIndex::write(std::string const& filename,
+                          FileKey const& key) const
+{
+    std::ofstream output(filename, std::ios::binary | std::ios::trunc);
+    if (!output)
+    {
+        return false;
+    }
+
+    output.write(sidecar_magic, sizeof(sidecar_magic));
+    write_vector(output, std::vector<char>(key.uuid.begin(), key.uuid.end()));
+    write_pod(output, key.mtime);
+    write_pod(output, key.size);
+    write_pod(output, key.num_entries);
+    write_records(output, events_);
+    write_records(output, tracks_);
+    write_vector(output, runs_);
+    write_vector(output, entries_);
+
+    return static_cast<bool>(output);
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Whether the ranges of a sidecar file only refer to stored runs or entries,
+ * and to entries of the tree.
+ */
+bool RSWEventIndex::consistent(Long64_t num_entries) const
+{
+    if (!runs_.empty() && !entries_.empty())
+    {
+        return false;
+    }
+    size_type const size = entries_.empty() ? runs_.size() : entries_.size();
+    for (auto const& event : events_)
+    {
+        if (event.begin > event.end || event.end > size
+            || event.track_begin > event.track_end
+            || event.track_end > tracks_.size())
+        {
+            return false;
+        }
+    }
+    for (auto const& track : tracks_)
+    {
+        if (track.begin > track.end || track.end > size)
+        {
+            return false;
+        }
+    }
+    for (auto const& run : runs_)
+    {
+        if (run.begin < 0 || run.begin > run.end || run.end > num_entries)
+        {
+            return false;
+        }
+    }
+    return std::all_of(entries_.begin(), entries_.end(), [=](Long64_t e) {
+        return e >= 0 && e < num_entries;
+    });
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Append the entries of a range of runs or, for unsorted input, of sorted
+ * entries.
+ */
+void RSWEventIndex::append_range(size_type begin,
+                                 size_type end,
+                                 std::vector<Long64_t>* entries) const
+{
+    if (!entries_.empty())
+    {
+        entries->insert(entries->end(),
+                        entries_.begin() + begin,
+                        entries_.begin() + end);
+        return;
+    }
+    for (auto r = begin; r < end; r++)
+    {
+        for (auto e = runs_[r].begin; e < runs_[r].end; e++)
+        {
+            entries->push_back(e);
+        }
+    }
+}
@@ -0,0 +1,124 @@
+//----------------------------------*-C++-*----------------------------------//
+// Copyright 2023 UT-Battelle, LLC, and other Celeritas developers.
+// See the top-level COPYRIGHT file for details.
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+//---------------------------------------------------------------------------//
+//! \file src/RSWEventIndex.hh
+//---------------------------------------------------------------------------//
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <TFile.h>
+
+#include "RSWStepReader.hh"
+
+//---------------------------------------------------------------------------//
+/*!
+ * Event and track index of a \c celeritas::RootStepWriter steps tree.
+ *
+ * Entries of the steps tree are stored in the order they were written, which
+ * interleaves events and tracks when Celeritas runs on multiple threads. Each
+ * track is written as a few runs of consecutive entries, so this index stores
+ * the runs of each track, sorted by (event id, track id, entry), along with
+ * the range of runs spanned by each event and by each track. If most runs
+ * are single entries, e.g. for unsorted input, the sorted entry numbers are
+ * stored instead, and ranges refer to them.
+ *
+ * The index is built in a single streaming pass over the \c event_id and
+ * \c track_id columns and persisted to a sidecar file (\c [input].evdidx ).
+ * The sidecar is reused as long as the UUID, modification time, size, and
+ * number of entries of the ROOT file match the ones stored in its header.
+ */
+class RSWEventIndex
+{
+  public:
+    //!@{
+    //! \name Type aliases
+    using size_type = std::uint64_t;
+    //!@}
+
+    //! Range of runs, or of sorted entries, belonging to a single track
+    struct TrackRange
+    {
+        std::int32_t track_id;
+        size_type begin;
+        size_type end;
+    };
+
+    //! Range of runs, or of sorted entries, and tracks of a single event
+    struct EventRange
+    {
+        std::int32_t event_id;
+        size_type begin;
+        size_type end;
+        size_type track_begin;
+        size_type track_end;
+    };
+
+    //! Consecutive tree entries [begin, end) of a single track
+    struct EntryRun
+    {
+        Long64_t begin;
+        Long64_t end;
+    };
+
+    // Load index from sidecar file or build it from the steps tree
+    static RSWEventIndex
+    load_or_build(TFile& tfile, TTree& ttree, RSWStepReader& reader);
+
+    // Find event by id; null if not present
+    EventRange const* find(int event_id) const;
+
+    //! Events sorted by event id
+    std::vector<EventRange> const& events() const { return events_; }
+
+    //! Tracks sorted by (event id, track id)
+    std::vector<TrackRange> const& tracks() const { return tracks_; }
+
+    // Number of tree entries of a track
+    size_type num_entries(TrackRange const& track) const;
+
+    // Append the tree entries of a track, in increasing order
+    void append_entries(TrackRange const& track,
+                        std::vector<Long64_t>* entries) const;
+
+    // Tree entries of an event, grouped by track
+    std::vector<Long64_t> entries(EventRange const& event) const;
+
+  private:
+    //// TYPES ////
+
+    struct FileKey
+    {
+        std::string uuid;
+        std::int64_t mtime{0};
+        std::int64_t size{0};
+        std::int64_t num_entries{0};
+    };
+
+    //// DATA ////
+
+    std::vector<EventRange> events_;
+    std::vector<TrackRange> tracks_;
+    std::vector<EntryRun> runs_;  //!< Runs of sorted tracks
+    std::vector<Long64_t> entries_;  //!< Sorted entries, if not in runs
+
+    //// HELPER FUNCTIONS ////
+
+    static FileKey make_key(TFile& tfile, TTree& ttree);
+    static std::string sidecar_filename(TFile const& tfile);
+
+    void build(Long64_t num_entries, RSWStepReader& reader);
+    bool read(std::string const& filename, FileKey const& key);
+    bool write(std::string const& filename, FileKey const& key) const;
+
+    // Whether ranges loaded from a sidecar file are consistent
+    bool consistent(Long64_t num_entries) const;
+
+    // Append the entries of a range of runs, or of sorted entries
+    void append_range(size_type begin,
+                      size_type end,
+                      std::vector<Long64_t>* entries) const;
+};
@@ -0,0 +1,477 @@
+//----------------------------------*-C++-*----------------------------------//
+// Copyright 2023 UT-Battelle, LLC, and other Celeritas developers.
+// See the top-level COPYRIGHT file for details.
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+//---------------------------------------------------------------------------//
+//! \file src/RSWStepReader.cc
+//---------------------------------------------------------------------------//
+#include "RSWStepReader.hh"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <numeric>
+#include <Bytes.h>
+#include <TBufferFile.h>
+#include <assert.h>
+#include <stdlib.h>
+
+#include "Profiler.hh"
+
+namespace
+{
+//---------------------------------------------------------------------------//
+// ROOT type name of the leaves decoded into values of type T
+template<class T>
+char const* leaf_type_name();
+
+template<>
+char const* leaf_type_name<int>()
+{
+    return "Int_t";
+}
+
+template<>
+char const* leaf_type_name<double>()
+{
+    return "Double_t";
+}
+
+//---------------------------------------------------------------------------//
+// Initial size of the buffer holding a serialized basket [bytes]
+constexpr Int_t basket_buffer_size = 32 * 1024;
+
+//---------------------------------------------------------------------------//
+}  // namespace
+
+//---------------------------------------------------------------------------//
+/*!
+ * Construct by binding all branches needed to draw tracks.
+ */
+RSWStepReader::RSWStepReader(TTree* ttree) : ttree_(ttree)
+{
+    assert(ttree_);
+    event_id_ = this->bind("event_id");
+    track_id_ = this->bind("track_id");
+    particle_ = this->bind("particle");
+    track_step_count_ = this->bind("track_step_count");
+    pre_pos_ = this->bind("pre_pos");
+    post_pos_ = this->bind("post_pos");
+    parent_id_ = this->bind("parent_id", false);
+    pre_energy_ = this->bind("pre_energy", false);
+    step_length_ = this->bind("step_length", false);
+    energy_deposition_ = this->bind("energy_deposition", false);
+    pre_time_ = this->bind("pre_time", false);
+    post_time_ = this->bind("post_time", false);
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Whether a column is present in the steps tree.
+ */
+bool RSWStepReader::has(Column column) const
+{
+    return this->bound(column).branch != nullptr;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Branches of the selected columns that are present in the tree.
+ */
+std::vector<TBranch*> RSWStepReader::branches(unsigned int columns) const
+{
+    std::vector<TBranch*> result;
+    for (unsigned int column = 1; column <= Column::last; column <<= 1)
+    {
+        auto* branch = this->bound(static_cast<Column>(column)).branch;
+        if ((columns & column) && branch)
+        {
+            result.push_back(branch);
+        }
+    }
+    return result;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Read selected columns for all entries in [first, last).
+ *
+ * The range is processed one cluster at a time: every selected column is
+ * decoded for the whole cluster before moving to the next column.
+ */
+void RSWStepReader::read(Long64_t first,
+                         Long64_t last,
+                         unsigned int columns,
+                         RSWStepColumns* output)
+{
+    assert(output);
+    assert(first <= last && last <= ttree_->GetEntries());
+
+    std::vector<Long64_t> entries(last - first);
+    std::iota(entries.begin(), entries.end(), first);
+    std::vector<std::size_t> rows(entries.size());
+    std::iota(rows.begin(), rows.end(), 0);
+    this->resize(entries.size(), columns, output);
+
+    auto cluster = ttree_->GetClusterIterator(first);
+    for (Long64_t start = cluster(); start < last; start = cluster())
+    {
+        auto const begin = std::max(start, first) - first;
+        auto const end = std::min(cluster.GetNextEntry(), last) - first;
+        this->read_rows(
+            entries, rows.data() + begin, rows.data() + end, columns, output);
+    }
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Read selected columns for a list of entries.
+ *
+ * Row \c i of the output corresponds to \c entries[i] . Entries are decoded
+ * in increasing order to avoid reloading baskets, regardless of the order in
+ * which they are requested.
+ */
+void RSWStepReader::read(std::vector<Long64_t> const& entries,
+                         unsigned int columns,
+                         RSWStepColumns* output)
+{
+    assert(output);
+
+    // Visit rows sorted by entry number
+    std::vector<std::size_t> rows(entries.size());
+    std::iota(rows.begin(), rows.end(), 0);
+    if (!std::is_sorted(entries.begin(), entries.end()))
+    {
+        std::sort(rows.begin(), rows.end(), [&entries](auto lhs, auto rhs) {
+            return entries[lhs] < entries[rhs];
+        });
+    }
+
+    this->resize(entries.size(), columns, output);
+    this->read_rows(
+        entries, rows.data(), rows.data() + rows.size(), columns, output);
+}
+
+//---------------------------------------------------------------------------//
+// PRIVATE
+//---------------------------------------------------------------------------//
+
+//---------------------------------------------------------------------------//
+/*!
+ * Look up a branch and its first leaf by name.
+ */
+auto RSWStepReader::bind(char const* name, bool required) -> BoundLeaf
+{
+    BoundLeaf result;
+    result.name = name;
+    result.branch = ttree_->GetBranch(name);
+    if (!result.branch && !required)
+    {
+        return result;
+    }
+    if (!result.branch)
+    {
+        std::cout << "[ERROR] RootStepWriter branch " << name
+                  << " not found in steps tree" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    result.leaf = ttree_->GetLeaf(name);
+    assert(result.leaf);
+    result.bulk = result.branch->GetBulkRead().SupportsBulkRead()
+                  && !result.leaf->GetLeafCount();
+    return result;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Bound branch of a single column.
+ */
+auto RSWStepReader::bound(Column column) const -> BoundLeaf const&
+{
+    switch (column)
+    {
+        case Column::event_id:
+            return event_id_;
+        case Column::track_id:
+            return track_id_;
+        case Column::particle:
+            return particle_;
+        case Column::track_step_count:
+            return track_step_count_;
+        case Column::pre_pos:
+            return pre_pos_;
+        case Column::post_pos:
+            return post_pos_;
+        case Column::parent_id:
+            return parent_id_;
+        case Column::pre_energy:
+            return pre_energy_;
+        case Column::step_length:
+            return step_length_;
+        case Column::energy_deposition:
+            return energy_deposition_;
+        case Column::pre_time:
+            return pre_time_;
+        case Column::post_time:
+            return post_time_;
+    }
+    __builtin_unreachable();
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Allocate the selected output columns.
+ */
+void RSWStepReader::resize(std::size_t num_rows,
+                           unsigned int columns,
+                           RSWStepColumns* output)
+{
+    output->num_rows = num_rows;
+    if (columns & Column::event_id)
+    {
+        output->event_id.resize(num_rows);
+    }
+    if (columns & Column::track_id)
+    {
+        output->track_id.resize(num_rows);
+    }
+    if (columns & Column::particle)
+    {
+        output->particle.resize(num_rows);
+    }
+    if (columns & Column::track_step_count)
+    {
+        output->track_step_count.resize(num_rows);
+    }
+    if (columns & Column::pre_pos)
+    {
+        output->pre_pos.resize(3 * num_rows);
+    }
+    if (columns & Column::post_pos)
+    {
+        output->post_pos.resize(3 * num_rows);
+    }
+    if (columns & Column::parent_id)
+    {
+        output->parent_id.resize(num_rows);
+    }
+    if (columns & Column::pre_energy)
+    {
+        output->pre_energy.resize(num_rows);
+    }
+    if (columns & Column::step_length)
+    {
+        output->step_length.resize(num_rows);
+    }
+    if (columns & Column::energy_deposition)
+    {
+        output->energy_deposition.resize(num_rows);
+    }
+    if (columns & Column::pre_time)
+    {
+        output->pre_time.resize(num_rows);
+    }
+    if (columns & Column::post_time)
+    {
+        output->post_time.resize(num_rows);
+    }
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Decode the selected columns, one branch at a time, for a subset of rows.
+ */
+void RSWStepReader::read_rows(std::vector<Long64_t> const& entries,
+                              std::size_t const* first_row,
+                              std::size_t const* last_row,
+                              unsigned int columns,
+                              RSWStepColumns* output)
+{
+    ScopedTimer timer("GetEntry");
+    Profiler::add(Profiler::Counter::entries_decoded, last_row - first_row);
+    if (columns & Column::event_id)
+    {
+        this->read_column<int, 1>(
+            event_id_, entries, first_row, last_row, &output->event_id);
+    }
+    if (columns & Column::track_id)
+    {
+        this->read_column<int, 1>(
+            track_id_, entries, first_row, last_row, &output->track_id);
+    }
+    if (columns & Column::particle)
+    {
+        this->read_column<int, 1>(
+            particle_, entries, first_row, last_row, &output->particle);
+    }
+    if (columns & Column::track_step_count)
+    {
+        this->read_column<int, 1>(track_step_count_,
+                                  entries,
+                                  first_row,
+                                  last_row,
+                                  &output->track_step_count);
+    }
+    if (columns & Column::pre_pos)
+    {
+        this->read_column<double, 3>(
+            pre_pos_, entries, first_row, last_row, &output->pre_pos);
+    }
+    if (columns & Column::post_pos)
+    {
+        this->read_column<double, 3>(
+            post_pos_, entries, first_row, last_row, &output->post_pos);
+    }
+    if (columns & Column::parent_id)
+    {
+        this->read_column<int, 1>(
+            parent_id_, entries, first_row, last_row, &output->parent_id);
+    }
+    if (columns & Column::pre_energy)
+    {
+        this->read_column<double, 1>(
+            pre_energy_, entries, first_row, last_row, &output->pre_energy);
+    }
+    if (columns & Column::step_length)
+    {
+        this->read_column<double, 1>(
+            step_length_, entries, first_row, last_row, &output->step_length);
+    }
+    if (columns & Column::energy_deposition)
+    {
+        this->read_column<double, 1>(energy_deposition_,
+                                     entries,
+                                     first_row,
+                                     last_row,
+                                     &output->energy_deposition);
+    }
+    if (columns & Column::pre_time)
+    {
+        this->read_column<double, 1>(
+            pre_time_, entries, first_row, last_row, &output->pre_time);
+    }
+    if (columns & Column::post_time)
+    {
+        this->read_column<double, 1>(
+            post_time_, entries, first_row, last_row, &output->post_time);
+    }
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Decode a single branch into a contiguous array of \c N values per row.
+ *
+ * Rows must be sorted by entry number. Leaves of \c N values of type \c T are
+ * decoded by basket; others, e.g. leaves stored with another type, are
+ * converted entry by entry.
+ */
+template<class T, std::size_t N>
+void RSWStepReader::read_column(BoundLeaf const& bound,
+                                std::vector<Long64_t> const& entries,
+                                std::size_t const* first_row,
+                                std::size_t const* last_row,
+                                std::vector<T>* output)
+{
+    if (!bound.branch)
+    {
+        std::cout << "[ERROR] Requested RootStepWriter column " << bound.name
+                  << " is not available in the steps tree" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    bool const bulk
+        = bound.bulk && bound.leaf->GetLenStatic() == static_cast<Int_t>(N)
+          && std::strcmp(bound.leaf->GetTypeName(), leaf_type_name<T>()) == 0;
+    std::uint64_t num_bytes;
+    if (bulk)
+    {
+        num_bytes = this->read_baskets<T, N>(
+            bound, entries, first_row, last_row, output->data());
+    }
+    else
+    {
+        num_bytes = this->read_entries<T, N>(
+            bound, entries, first_row, last_row, output->data());
+    }
+    Profiler::add(Profiler::Counter::bytes_read, num_bytes);
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Decode a fixed-size leaf one basket at a time.
+ *
+ * Each basket holding a requested entry is unzipped once into a serialized
+ * buffer, from which the values of all requested entries it holds are
+ * byte-swapped into the output without going through \c TLeaf . Returns the
+ * number of bytes decoded.
+ */
+template<class T, std::size_t N>
+std::uint64_t RSWStepReader::read_baskets(BoundLeaf const& bound,
+                                          std::vector<Long64_t> const& entries,
+                                          std::size_t const* first_row,
+                                          std::size_t const* last_row,
+                                          T* data)
+{
+    constexpr std::size_t entry_size = N * sizeof(T);
+    auto* branch = bound.branch;
+    TBufferFile buffer(TBuffer::kWrite, basket_buffer_size);
+    Long64_t basket_first = 0;
+    Long64_t basket_last = 0;
+    std::uint64_t result = 0;
+
+    for (auto row = first_row; row != last_row; ++row)
+    {
+        auto const entry = entries[*row];
+        if (entry < basket_first || entry >= basket_last)
+        {
+            // Unzip the basket holding the entry, from its first entry
+            auto const count
+                = branch->GetBulkRead().GetEntriesSerialized(entry, buffer);
+            if (count <= 0)
+            {
+                std::cout << "[ERROR] Could not read basket of RootStepWriter "
+                             "branch "
+                          << branch->GetName() << " at entry " << entry
+                          << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            basket_first = branch->GetBasketEntry()[branch->GetReadBasket()];
+            basket_last = basket_first + count;
+            assert(entry >= basket_first && entry < basket_last);
+            result += count * entry_size;
+        }
+
+        char* values = buffer.GetCurrent()
+                       + (entry - basket_first) * entry_size;
+        for (std::size_t j = 0; j < N; j++)
+        {
+            frombuf(values, data + *row * N + j);
+        }
+    }
+    return result;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Decode any leaf entry by entry, converting its values through \c TLeaf .
+ *
+ * Returns the number of bytes decoded.
+ */
+template<class T, std::size_t N>
+std::uint64_t RSWStepReader::read_entries(BoundLeaf const& bound,
+                                          std::vector<Long64_t> const& entries,
+                                          std::size_t const* first_row,
+                                          std::size_t const* last_row,
+                                          T* data)
+{
+    std::uint64_t result = 0;
+    for (auto row = first_row; row != last_row; ++row)
+    {
+        result += bound.branch->GetEntry(entries[*row]);
+        for (std::size_t j = 0; j < N; j++)
+        {
+            data[*row * N + j] = static_cast<T>(bound.leaf->GetValue(j));
+        }
+    }
+    return result;
+}
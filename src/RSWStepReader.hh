@@ -0,0 +1,165 @@
+//----------------------------------*-C++-*----------------------------------//
+// Copyright 2023 UT-Battelle, LLC, and other Celeritas developers.
+// See the top-level COPYRIGHT file for details.
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+//---------------------------------------------------------------------------//
+//! \file src/RSWStepReader.hh
+//---------------------------------------------------------------------------//
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+#include <TBranch.h>
+#include <TLeaf.h>
+#include <TTree.h>
+
+//---------------------------------------------------------------------------//
+/*!
+ * Contiguous per-column storage of \c celeritas::RootStepWriter step data.
+ *
+ * Each row corresponds to one requested tree entry. Positions are stored as
+ * flattened \c [x, y, z] triplets.
+ */
+struct RSWStepColumns
+{
+    std::vector<int> event_id;
+    std::vector<int> track_id;
+    std::vector<int> particle;
+    std::vector<int> track_step_count;
+    std::vector<double> pre_pos;
+    std::vector<double> post_pos;
+    std::vector<int> parent_id;
+    std::vector<double> pre_energy;
+    std::vector<double> step_length;
+    std::vector<double> energy_deposition;
+    std::vector<double> pre_time;
+    std::vector<double> post_time;
+
+    std::size_t num_rows{0};  //!< Number of entries read
+};
+
+//---------------------------------------------------------------------------//
+/*!
+ * Columnar reader for the \c steps TTree written by
+ * \c celeritas::RootStepWriter .
+ *
+ * Branches and leaves are looked up once at construction. The columns needed
+ * to draw tracks are mandatory; the ones only used for filtering are optional,
+ * since \c RootStepWriter may be configured to skip them. Each column is then
+ * decoded independently, so that only the needed branches are unzipped.
+ * Branches with a single fixed-size leaf are decoded a whole basket at a time
+ * through \c TBranch::GetBulkRead , and values are copied straight out of the
+ * serialized basket; other branches fall back to \c TBranch::GetEntry and
+ * \c TLeaf::GetValue for each entry.
+ *
+ * \code
+ *  RSWStepReader reader(ttree);
+ *  RSWStepColumns columns;
+ *  reader.read(0, ttree->GetEntries(), RSWStepReader::event_id, &columns);
+ * \endcode
+ */
+class RSWStepReader
+{
+  public:
+    //! Available columns, combined as a bit mask
+    enum Column : unsigned int
+    {
+        event_id = 1u << 0,
+        track_id = 1u << 1,
+        particle = 1u << 2,
+        track_step_count = 1u << 3,
+        pre_pos = 1u << 4,
+        post_pos = 1u << 5,
+        parent_id = 1u << 6,
+        pre_energy = 1u << 7,
+        step_length = 1u << 8,
+        energy_deposition = 1u << 9,
+        pre_time = 1u << 10,
+        post_time = 1u << 11,
+        last = post_time  //!< Highest column bit, to loop over the mask
+    };
+
+    // Construct by binding the needed branches of the steps tree
+    explicit RSWStepReader(TTree* ttree);
+
+    // Whether an optional column is present in the tree
+    bool has(Column column) const;
+
+    // Branches of the selected columns that are present in the tree
+    std::vector<TBranch*> branches(unsigned int columns) const;
+
+    // Read selected columns for entries in [first, last)
+    void read(Long64_t first,
+              Long64_t last,
+              unsigned int columns,
+              RSWStepColumns* output);
+
+    // Read selected columns for an arbitrary list of entries
+    void read(std::vector<Long64_t> const& entries,
+              unsigned int columns,
+              RSWStepColumns* output);
+
+  private:
+    //// TYPES ////
+
+    struct BoundLeaf
+    {
+        char const* name{nullptr};  //!< Branch name, even if not found
+        TBranch* branch{nullptr};
+        TLeaf* leaf{nullptr};
+        bool bulk{false};  //!< Single fixed-size leaf, readable by basket
+    };
+
+    //// DATA ////
+
+    TTree* ttree_;
+    BoundLeaf event_id_;
+    BoundLeaf track_id_;
+    BoundLeaf particle_;
+    BoundLeaf track_step_count_;
+    BoundLeaf pre_pos_;
+    BoundLeaf post_pos_;
+    BoundLeaf parent_id_;
+    BoundLeaf pre_energy_;
+    BoundLeaf step_length_;
+    BoundLeaf energy_deposition_;
+    BoundLeaf pre_time_;
+    BoundLeaf post_time_;
+
+    //// HELPER FUNCTIONS ////
+
+    BoundLeaf bind(char const* name, bool required = true);
+    BoundLeaf const& bound(Column column) const;
+
+    void resize(std::size_t num_rows,
+                unsigned int columns,
+                RSWStepColumns* output);
+
+    void read_rows(std::vector<Long64_t> const& entries,
+                   std::size_t const* first_row,
+                   std::size_t const* last_row,
+                   unsigned int columns,
+                   RSWStepColumns* output);
+
+    template<class T, std::size_t N>
+    void read_column(BoundLeaf const& bound,
+                     std::vector<Long64_t> const& entries,
+                     std::size_t const* first_row,
+                     std::size_t const* last_row,
+                     std::vector<T>* output);
+
+    template<class T, std::size_t N>
+    std::uint64_t read_baskets(BoundLeaf const& bound,
+                               std::vector<Long64_t> const& entries,
+                               std::size_t const* first_row,
+                               std::size_t const* last_row,
+                               T* data);
+
+    template<class T, std::size_t N>
+    std::uint64_t read_entries(BoundLeaf const& bound,
+                               std::vector<Long64_t> const& entries,
+                               std::size_t const* first_row,
+                               std::size_t const* last_row,
+                               T* data);
+};
@@ -3,158 +3,533 @@
 // See the top-level COPYRIGHT file for details.
 // SPDX-License-Identifier: (Apache-2.0 OR MIT)
 //---------------------------------------------------------------------------//
-//! \file src/RSWViewer.hh
+//! \file src/RSWViewer.cc
 //---------------------------------------------------------------------------//
 #include "RSWViewer.hh"
 
-#include <TEveManager.h>
-#include <TLeaf.h>
-#include <TTreeIndex.h>
+#include <algorithm>
+#include <iostream>
+#include <numeric>
 #include <assert.h>
-#include <stdlib.h>
+
+#include "TreeCache.hh"
+
+//---------------------------------------------------------------------------//
+/*!
+ * Decode single events from a steps tree, using the shared event index.
+ */
+class RSWViewer::Reader final : public MCTruthViewerInterface::EventReader
+{
+  public:
+    //!@{
+    //! \name Type aliases
+    using TrackRange = RSWEventIndex::TrackRange;
+    using EventRange = RSWEventIndex::EventRange;
+    //!@}
+
+    // Construct with an open file and the viewer index and options
+    Reader(UPTFile tfile, RSWViewer const& viewer);
+
+    // Decode all tracks of an event
+    EventData operator()(int event_id) final;
+
+    // Cache the given columns
+    void cache_columns(unsigned int columns);
+
+    //! Input statistics of the read-ahead cache
+    TreeCacheStats cache_stats() const final
+    {
+        return tree_cache_stats(*ttree_, *tfile_);
+    }
+
+    //!@{
+    //! Access file handles
+    TFile& tfile() { return *tfile_; }
+    TTree& ttree() { return *ttree_; }
+    RSWStepReader& step_reader() { return *step_reader_; }
+    //!@}
+
+  private:
+    UPTFile tfile_;
+    UPTTree ttree_;
+    std::unique_ptr<RSWStepReader> step_reader_;
+    RSWViewer const& viewer_;
+    RSWEventIndex const& index_;
+    TrackFilter const& filter_;
+    unsigned int cached_columns_{0};
+    Long64_t cache_size_{0};
+
+    // Columns needed to draw tracks
+    static constexpr unsigned int draw_columns
+        = RSWStepReader::particle | RSWStepReader::track_step_count
+          | RSWStepReader::pre_pos | RSWStepReader::post_pos;
+
+    // Whether only primaries are selected, warning once if they cannot be
+    bool primaries_only() const;
+
+    // Whether the vertex energy cut is applied, warning once if it cannot be
+    bool energy_cut() const;
+
+    // Whether the track length cut is applied, warning once if it cannot be
+    bool length_cut() const;
+
+    // Whether a cut is applied, warning once if its column is missing
+    bool column_cut(bool requested,
+                    RSWStepReader::Column column,
+                    char const* flag,
+                    char const* message,
+                    std::once_flag& warning) const;
+
+    // Columns needed by the track filter
+    unsigned int filter_columns() const;
+
+    // Columns needed for track attributes
+    unsigned int attribute_columns() const;
+
+    // Columns needed for energy deposits
+    unsigned int deposit_columns() const;
+
+    // Columns needed for global times
+    unsigned int time_columns() const;
+
+    // Select tracks that pass the filter
+    std::vector<TrackRange const*> select_tracks(EventRange const& event);
+};
 
 //---------------------------------------------------------------------------//
 /*!
  * Construct with ROOT input filename.
  */
-RSWViewer::RSWViewer(UPTFile tfile) : tfile_(std::move(tfile))
+RSWViewer::RSWViewer(UPTFile tfile) : filename_(tfile->GetName())
+{
+    reader_ = std::make_unique<Reader>(std::move(tfile), *this);
+    reader_->cache_columns(RSWStepReader::event_id
+                           | RSWStepReader::track_id);
+    index_ = RSWEventIndex::load_or_build(
+        reader_->tfile(), reader_->ttree(), reader_->step_reader());
+
+    auto const& step_reader = reader_->step_reader();
+    has_deposits_ = step_reader.has(RSWStepReader::energy_deposition);
+    has_times_ = step_reader.has(RSWStepReader::pre_time)
+                 && step_reader.has(RSWStepReader::post_time);
+}
+
+//---------------------------------------------------------------------------//
+//! Default destructor
+RSWViewer::~RSWViewer() = default;
+
+//---------------------------------------------------------------------------//
+/*!
+ * Sorted list of event ids in the steps tree.
+ */
+std::vector<int> RSWViewer::event_ids()
+{
+    std::vector<int> result;
+    result.reserve(index_.events().size());
+    for (auto const& event : index_.events())
+    {
+        result.push_back(event.event_id);
+    }
+    return result;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Reader using the input file handle.
+ */
+auto RSWViewer::reader() -> EventReader&
+{
+    return *reader_;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Open the input file again and create a new reader for it.
+ */
+auto RSWViewer::make_reader() const -> std::unique_ptr<EventReader>
+{
+    UPTFile tfile(TFile::Open(filename_.c_str(), "read"));
+    assert(tfile && tfile->IsOpen());
+    return std::make_unique<Reader>(std::move(tfile), *this);
+}
+
+//---------------------------------------------------------------------------//
+// READER
+//---------------------------------------------------------------------------//
+
+//---------------------------------------------------------------------------//
+/*!
+ * Construct with an open file and the viewer index and options.
+ */
+RSWViewer::Reader::Reader(UPTFile tfile, RSWViewer const& viewer)
+    : tfile_(std::move(tfile))
+    , viewer_(viewer)
+    , index_(viewer.index_)
+    , filter_(viewer.filter())
 {
     assert(tfile_);
     ttree_.reset(tfile_->Get<TTree>("steps"));
     assert(ttree_);
+    step_reader_ = std::make_unique<RSWStepReader>(ttree_.get());
 }
 
 //---------------------------------------------------------------------------//
 /*!
- * Add event from Celeritas RootStepWriter.
+ * Decode the entries of a single event and assemble its tracks.
  *
- * If event id is negative, all events are drawn.
+ * Only the entries listed by the index for the selected tracks of this event
+ * are read. Steps of each track are sorted by step count; the track starts at
+ * the pre-step position of its first step, followed by the post-step position
+ * of every step. Track attributes, when requested, are taken from the first
+ * step (parent id and pre-step energy) and the sum of the step lengths;
+ * parents can be requested alone.
+ * Energy deposits are zero if the \c energy_deposition column was not
+ * written. Global times are those of the pre-step point of the first step
+ * and of the post-step point of every step, or zero if they were not
+ * written.
  */
-void RSWViewer::add_event(int const event_id)
+EventData RSWViewer::Reader::operator()(int event_id)
 {
-    assert(ttree_->GetEntries() > event_id);
+    auto const columns = draw_columns | this->attribute_columns()
+                         | this->deposit_columns() | this->time_columns();
+    this->cache_columns(columns | this->filter_columns());
+    auto const* event = index_.find(event_id);
+    assert(event);
+    auto const selected = this->select_tracks(*event);
 
-    // Sort tree first by event id, then by track id
-    ttree_->BuildIndex("event_id", "track_id");
-    auto tree_index = (TTreeIndex*)ttree_->GetTreeIndex();
-    sorted_tree_index_ = tree_index->GetIndex();
+    // Decode step data of selected tracks only
+    std::vector<Long64_t> entries;
+    std::vector<std::size_t> track_rows{0};
+    for (auto const* track : selected)
+    {
+        index_.append_entries(*track, &entries);
+        track_rows.push_back(entries.size());
+    }
+    RSWStepColumns data;
+    step_reader_->read(entries, columns, &data);
 
-    // Fetch last event id
-    auto const last_entry = sorted_tree_index_[ttree_->GetEntries() - 1];
-    ttree_->GetEntry(last_entry);
-    auto const last_evtid = ttree_->GetLeaf("event_id")->GetValue();
-    if (last_evtid < event_id)
+    EventData result;
+    result.id = event_id;
+    result.reserve(selected.size(), entries.size() + selected.size());
+    if (viewer_.needs_energy_deposition())
     {
-        std::cout << "[ERROR] event id " << event_id
-                  << " is not available. Last event id is " << last_evtid
-                  << std::endl;
-        exit(EXIT_FAILURE);
+        result.energy_deposits.reserve(entries.size() + selected.size());
     }
-    else
+    if (viewer_.needs_times())
     {
-        this->create_event_tracks(event_id);
+        result.times.reserve(entries.size() + selected.size());
     }
+
+    std::vector<std::size_t> rows;
+    for (std::size_t t = 0; t < selected.size(); t++)
+    {
+        auto const* track = selected[t];
+
+        // Sort track steps by step count
+        rows.resize(track_rows[t + 1] - track_rows[t]);
+        std::iota(rows.begin(), rows.end(), track_rows[t]);
+        std::sort(rows.begin(), rows.end(), [&data](auto lhs, auto rhs) {
+            return data.track_step_count[lhs] < data.track_step_count[rhs];
+        });
+
+        result.add_track(track->track_id, data.particle[rows.front()]);
+        if (viewer_.needs_attributes())
+        {
+            double length = 0;
+            for (auto row : rows)
+            {
+                if (!data.step_length.empty())
+                {
+                    length += data.step_length[row];
+                }
+            }
+            auto const first = rows.front();
+            result.add_attributes(
+                data.parent_id.empty() ? -1 : data.parent_id[first],
+                data.pre_energy.empty() ? 0 : data.pre_energy[first],
+                length);
+        }
+        else if (viewer_.needs_parents())
+        {
+            auto const first = rows.front();
+            result.add_parent(data.parent_id.empty() ? -1
+                                                     : data.parent_id[first]);
+        }
+
+        // Add vertex and the post-step point of every step
+        auto const* vtx = &data.pre_pos[3 * rows.front()];
+        result.add_point(vtx[0], vtx[1], vtx[2]);
+        for (auto row : rows)
+        {
+            auto const* pos = &data.post_pos[3 * row];
+            result.add_point(pos[0], pos[1], pos[2]);
+        }
+
+        if (viewer_.needs_energy_deposition())
+        {
+            auto& energy_deposits = result.energy_deposits;
+            energy_deposits.push_back(0);
+            for (auto row : rows)
+            {
+                energy_deposits.push_back(data.energy_deposition.empty()
+                                              ? 0
+                                              : data.energy_deposition[row]);
+            }
+        }
+
+        if (viewer_.needs_times())
+        {
+            // Convert from [s]
+            bool const has_times = !data.pre_time.empty();
+            auto time = [](double t) { return static_cast<float>(t * 1e9); };
+            auto& times = result.times;
+            times.push_back(has_times ? time(data.pre_time[rows.front()]) : 0);
+            for (auto row : rows)
+            {
+                times.push_back(has_times ? time(data.post_time[row]) : 0);
+            }
+        }
+    }
+    return result;
 }
 
 //---------------------------------------------------------------------------//
-// PRIVATE
+/*!
+ * Set up the read-ahead cache for the branches of the given columns.
+ *
+ * The cache is only rebuilt when the columns or the cache size change.
+ */
+void RSWViewer::Reader::cache_columns(unsigned int columns)
+{
+    auto const cache_size = viewer_.tree_cache_size();
+    if (columns == cached_columns_ && cache_size == cache_size_)
+    {
+        return;
+    }
+    setup_tree_cache(*ttree_, step_reader_->branches(columns), cache_size);
+    cached_columns_ = columns;
+    cache_size_ = cache_size;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Whether only primaries are selected.
+ *
+ * Primaries are told apart by their parent id: without a \c parent_id column,
+ * the cut is ignored with a warning, like energy deposits are zero without an
+ * \c energy_deposition column.
+ */
+bool RSWViewer::Reader::primaries_only() const
+{
+    return this->column_cut(filter_.primaries_only,
+                            RSWStepReader::parent_id,
+                            "-primaries",
+                            "a parent_id column",
+                            viewer_.primaries_warning_);
+}
+
 //---------------------------------------------------------------------------//
+/*!
+ * Whether the vertex energy cut is applied, i.e. set and with a
+ * \c pre_energy column to apply it to.
+ */
+bool RSWViewer::Reader::energy_cut() const
+{
+    return this->column_cut(filter_.needs_energy(),
+                            RSWStepReader::pre_energy,
+                            "-min-energy",
+                            "a pre_energy column",
+                            viewer_.energy_warning_);
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Whether the track length cut is applied, i.e. set and with a
+ * \c step_length column to apply it to.
+ */
+bool RSWViewer::Reader::length_cut() const
+{
+    return this->column_cut(filter_.needs_length(),
+                            RSWStepReader::step_length,
+                            "-min-length",
+                            "a step_length column",
+                            viewer_.length_warning_);
+}
 
 //---------------------------------------------------------------------------//
 /*!
- * Loop over steps tree, generate a TEveLine for each track id, and add it to
- * the viewer.
+ * Whether a requested cut is applied, warning once per input file that it is
+ * ignored if the steps tree lacks its optional column.
  */
-void RSWViewer::create_event_tracks(int const event_id)
+bool RSWViewer::Reader::column_cut(bool requested,
+                                   RSWStepReader::Column column,
+                                   char const* flag,
+                                   char const* message,
+                                   std::once_flag& warning) const
 {
-    struct TrackPoint
+    if (!requested || step_reader_->has(column))
     {
-        int step_count;
-        std::array<double, 3> pos;
-    };
-    using TrackPoints = std::vector<TrackPoint>;
+        return requested;
+    }
+    std::call_once(warning, [this, flag, message] {
+        std::cout << "[WARNING] " << flag << " requires " << message << " in "
+                  << viewer_.filename_ << ": showing all tracks" << std::endl;
+    });
+    return false;
+}
 
-    // Initialize data
-    auto track_line = new TEveLine(TEveLine::ETreeVarType_e::kTVT_XYZ);
-    TrackPoints track_points;
-    int current_trk_id{-1};
+//---------------------------------------------------------------------------//
+/*!
+ * Columns needed by the track filter, if any.
+ */
+unsigned int RSWViewer::Reader::filter_columns() const
+{
+    if (!filter_.has_track_cuts())
+    {
+        return 0;
+    }
 
-    // Loop over entries
-    for (int i = 0; i < ttree_->GetEntries(); i++)
+    unsigned int result = RSWStepReader::particle
+                          | RSWStepReader::track_step_count;
+    if (this->primaries_only())
     {
-        ttree_->GetEntry(sorted_tree_index_[i]);
+        result |= RSWStepReader::parent_id;
+    }
+    if (this->energy_cut())
+    {
+        result |= RSWStepReader::pre_energy;
+    }
+    if (this->length_cut())
+    {
+        result |= RSWStepReader::step_length;
+    }
+    return result;
+}
 
-        int const entry_evt_id = ttree_->GetLeaf("event_id")->GetValue();
-        if (event_id >= 0)
-        {
-            // Only draw a single event
+//---------------------------------------------------------------------------//
+/*!
+ * Columns needed for track attributes, or for parents alone, if requested
+ * and present in the tree.
+ */
+unsigned int RSWViewer::Reader::attribute_columns() const
+{
+    if (!viewer_.needs_attributes())
+    {
+        return viewer_.needs_parents()
+                       && step_reader_->has(RSWStepReader::parent_id)
+                   ? RSWStepReader::parent_id
+                   : 0;
+    }
 
-            if (entry_evt_id < event_id)
-            {
-                // Did not reach event yet
-                continue;
-            }
-            if (entry_evt_id > event_id)
-            {
-                // Surpassed event id; stop
-                break;
-            }
+    unsigned int result = 0;
+    for (auto column : {RSWStepReader::parent_id,
+                        RSWStepReader::pre_energy,
+                        RSWStepReader::step_length})
+    {
+        if (step_reader_->has(column))
+        {
+            result |= column;
         }
+    }
+    return result;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Columns needed for energy deposits, if requested and present in the tree.
+ */
+unsigned int RSWViewer::Reader::deposit_columns() const
+{
+    if (!viewer_.needs_energy_deposition()
+        || !step_reader_->has(RSWStepReader::energy_deposition))
+    {
+        return 0;
+    }
+    return RSWStepReader::energy_deposition;
+}
 
-        int entry_trk_id = ttree_->GetLeaf("track_id")->GetValue();
-        if (entry_trk_id != current_trk_id)
+//---------------------------------------------------------------------------//
+/*!
+ * Columns needed for global times, if requested and both present in the tree.
+ */
+unsigned int RSWViewer::Reader::time_columns() const
+{
+    if (!viewer_.needs_times() || !step_reader_->has(RSWStepReader::pre_time)
+        || !step_reader_->has(RSWStepReader::post_time))
+    {
+        return 0;
+    }
+    return RSWStepReader::pre_time | RSWStepReader::post_time;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Select the tracks of an event that pass the filter.
+ *
+ * Only the columns needed by the filter are decoded. Track-level quantities
+ * are taken from the first step of each track: particle type, parent id
+ * (negative for primaries), and pre-step energy. The track length is the sum
+ * of its step lengths.
+ */
+auto RSWViewer::Reader::select_tracks(EventRange const& event)
+    -> std::vector<TrackRange const*>
+{
+    auto const& tracks = index_.tracks();
+    std::vector<TrackRange const*> result;
+    result.reserve(event.track_end - event.track_begin);
+
+    if (!filter_.has_track_cuts())
+    {
+        for (auto t = event.track_begin; t < event.track_end; t++)
         {
-            //// New track found ////
+            result.push_back(&tracks[t]);
+        }
+        return result;
+    }
 
-            if (i > 0)
-            {
-                // Set attributes, add full track to Eve
-                auto pdg = ttree_->GetLeaf("particle")->GetValue();
-                std::string track_name = std::to_string(entry_evt_id) + "_"
-                                         + std::to_string(current_trk_id) + "_"
-                                         + this->to_string((PDG)pdg);
-                track_line->SetName(track_name.c_str());
-                this->set_track_attributes(track_line, (PDG)pdg);
-
-                // Sort track by step count
-                std::sort(track_points.begin(),
-                          track_points.end(),
-                          [](TrackPoint const& lhs, TrackPoint const& rhs) {
-                              return lhs.step_count < rhs.step_count;
-                          });
-
-                // Add sorted points to TEveLine
-                for (auto p : track_points)
-                {
-                    track_line->SetNextPoint(p.pos[0], p.pos[1], p.pos[2]);
-                }
+    auto const entries = index_.entries(event);
+    RSWStepColumns data;
+    step_reader_->read(entries, this->filter_columns(), &data);
+    bool const primaries_only = this->primaries_only();
+    bool const energy_cut = this->energy_cut();
+    bool const length_cut = this->length_cut();
 
-                // Add line to Eve
-                gEve->AddElement(track_line);
-            }
+    // Rows of the event entries are grouped by track
+    std::size_t end = 0;
+    for (auto t = event.track_begin; t < event.track_end; t++)
+    {
+        auto const& track = tracks[t];
+        auto const begin = end;
+        end += index_.num_entries(track);
 
-            // Reset everything, add new track vertex
+        // Find first step and accumulate length
+        auto first = begin;
+        double length = 0;
+        for (auto row = begin; row < end; row++)
+        {
+            if (data.track_step_count[row] < data.track_step_count[first])
+            {
+                first = row;
+            }
+            if (length_cut)
             {
-                track_line = new TEveLine(TEveLine::ETreeVarType_e::kTVT_XYZ);
-                track_points.clear();
-                auto const& pos = ttree_->GetLeaf("pre_pos");
-                TrackPoint p;
-                p.step_count = ttree_->GetLeaf("track_step_count")->GetValue();
-                p.pos = {pos->GetValue(0), pos->GetValue(1), pos->GetValue(2)};
-                track_points.push_back(std::move(p));
-
-                current_trk_id = entry_trk_id;
+                length += data.step_length[row];
             }
         }
 
-        else
+        // Without an applied cut, every track passes it
+        bool const is_primary = !primaries_only || data.parent_id[first] < 0;
+        double const energy = energy_cut ? data.pre_energy[first]
+                                         : filter_.min_vertex_energy;
+        if (!length_cut)
+        {
+            length = filter_.min_length;
+        }
+        if (filter_.pass_track(
+                data.particle[first], energy, length, is_primary))
         {
-            // Add next step point
-            auto const& pos = ttree_->GetLeaf("post_pos");
-            TrackPoint p;
-            p.step_count = ttree_->GetLeaf("track_step_count")->GetValue();
-            p.pos = {pos->GetValue(0), pos->GetValue(1), pos->GetValue(2)};
-            track_points.push_back(std::move(p));
+            result.push_back(&track);
         }
     }
+    return result;
 }
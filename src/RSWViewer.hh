@@ -8,9 +8,12 @@
 #pragma once
 
 #include <memory>
+#include <mutex>
 #include <string>
 
 #include "MCTruthViewerInterface.hh"
+#include "RSWEventIndex.hh"
+#include "RSWStepReader.hh"
 #include "RootUniquePtr.hh"
 
 //---------------------------------------------------------------------------//
@@ -32,18 +35,36 @@ class RSWViewer final : public MCTruthViewerInterface
     // Construct with ROOT input file
     RSWViewer(UPTFile tfile);
 
-    // Add tracks for given event
-    void add_event(int event_id) override;
+    // Default destructor
+    ~RSWViewer();
 
-  private:
-    //// DATA ////
+    //! Whether the steps tree has an energy_deposition column
+    bool has_energy_deposition() const final { return has_deposits_; }
+
+    //! Whether the steps tree has pre_time and post_time columns
+    bool has_times() const final { return has_times_; }
+
+  protected:
+    // Sorted list of event ids available in the input
+    std::vector<int> event_ids() override;
 
-    UPTFile tfile_;
-    UPTTree ttree_;
-    long long* sorted_tree_index_;
+    // Reader using the input file handle
+    EventReader& reader() override;
 
-    //// HELPER FUNCTIONS ////
+    // Create a reader with its own file handle
+    std::unique_ptr<EventReader> make_reader() const override;
+
+  private:
+    class Reader;
+
+    //// DATA ////
 
-    // Loop over tracks and add track lines to Eve
-    void create_event_tracks(int const event_id);
+    std::string filename_;
+    RSWEventIndex index_;
+    std::unique_ptr<Reader> reader_;
+    bool has_deposits_{false};
+    bool has_times_{false};
+    mutable std::once_flag primaries_warning_;
+    mutable std::once_flag energy_warning_;
+    mutable std::once_flag length_warning_;
 };
@@ -3,96 +3,530 @@
 // See the top-level COPYRIGHT file for details.
 // SPDX-License-Identifier: (Apache-2.0 OR MIT)
 //---------------------------------------------------------------------------//
-//! \file src/RootDataViewer.hh
+//! \file src/RootDataViewer.cc
 //---------------------------------------------------------------------------//
 #include "RootDataViewer.hh"
 
-#include <TEveManager.h>
+#include <algorithm>
+#include <numeric>
+#include <set>
+#include <TObjArray.h>
 #include <assert.h>
 
+#include "Profiler.hh"
+#include "TreeCache.hh"
+
+//---------------------------------------------------------------------------//
+/*!
+ * Decode single events from the \c events tree.
+ */
+class RootDataViewer::Reader final : public MCTruthViewerInterface::EventReader
+{
+  public:
+    // Construct with an open file and the viewer options to apply
+    Reader(UPTFile tfile, RootDataViewer const& viewer);
+
+    // Delete event object allocated by ROOT
+    ~Reader();
+
+    // Decode all tracks of an event
+    EventData operator()(int event_id) final;
+
+    //! Number of events in the tree
+    Long64_t num_entries() const { return ttree_->GetEntries(); }
+
+    //! Input statistics of the read-ahead cache
+    TreeCacheStats cache_stats() const final
+    {
+        return tree_cache_stats(*ttree_, *tfile_);
+    }
+
+  private:
+    //// TYPES ////
+
+    //! Sub-branches read and cached, depending on viewer options
+    struct Selection
+    {
+        bool defer_steps{false};
+        bool energy{false};
+        bool length{false};
+        bool interactions{false};
+        bool attributes{false};
+        bool parents{false};
+        bool energy_deposition{false};
+        bool times{false};
+        Long64_t cache_size{0};
+
+        bool operator==(Selection const& other) const
+        {
+            return defer_steps == other.defer_steps && energy == other.energy
+                   && length == other.length
+                   && interactions == other.interactions
+                   && attributes == other.attributes
+                   && parents == other.parents
+                   && energy_deposition == other.energy_deposition
+                   && times == other.times
+                   && cache_size == other.cache_size;
+        }
+    };
+
+    //// DATA ////
+
+    UPTFile tfile_;
+    UPTTree ttree_;
+    rootdata::Event* event_{nullptr};
+    RootDataViewer const& viewer_;
+    std::vector<TBranch*> branches_;  //!< All branches of a split event
+    bool split_steps_{false};
+    bool selected_{false};
+    Selection selection_;
+    std::vector<TBranch*> deferred_steps_[2];  //!< Primaries, secondaries
+
+    //// HELPER FUNCTIONS ////
+
+    // Sub-branches needed with the current viewer options
+    Selection make_selection() const;
+
+    // Enable and cache only the needed sub-branches
+    void select_branches(Selection const& selection);
+
+    // Select tracks that pass the filter
+    std::vector<bool> select_tracks(std::vector<rootdata::Track> const& tracks,
+                                    bool is_primary) const;
+
+    // Append selected primaries or secondaries
+    void add_tracks(std::vector<rootdata::Track> const& vec_tracks,
+                    std::vector<bool> const& selected,
+                    bool is_primary,
+                    EventData* result) const;
+};
+
 //---------------------------------------------------------------------------//
 /*!
  * Construct with ROOT input filename.
  */
-RootDataViewer::RootDataViewer(UPTFile tfile) : tfile_(std::move(tfile))
+RootDataViewer::RootDataViewer(UPTFile tfile) : filename_(tfile->GetName())
+{
+    reader_ = std::make_unique<Reader>(std::move(tfile), *this);
+}
+
+//---------------------------------------------------------------------------//
+//! Default destructor
+RootDataViewer::~RootDataViewer() = default;
+
+//---------------------------------------------------------------------------//
+/*!
+ * Event ids are the entries of the events tree.
+ */
+std::vector<int> RootDataViewer::event_ids()
+{
+    std::vector<int> result(reader_->num_entries());
+    std::iota(result.begin(), result.end(), 0);
+    return result;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Reader using the input file handle.
+ */
+auto RootDataViewer::reader() -> EventReader&
+{
+    return *reader_;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Open the input file again and create a new reader for it.
+ */
+auto RootDataViewer::make_reader() const -> std::unique_ptr<EventReader>
+{
+    UPTFile tfile(TFile::Open(filename_.c_str(), "read"));
+    assert(tfile && tfile->IsOpen());
+    return std::make_unique<Reader>(std::move(tfile), *this);
+}
+
+//---------------------------------------------------------------------------//
+// READER
+//---------------------------------------------------------------------------//
+
+//---------------------------------------------------------------------------//
+/*!
+ * Construct with an open file and bind the event branch.
+ *
+ * If the event branch is split, all of its sub-branches are listed so that
+ * only the ones needed for drawing can be enabled.
+ */
+RootDataViewer::Reader::Reader(UPTFile tfile, RootDataViewer const& viewer)
+    : tfile_(std::move(tfile)), viewer_(viewer)
 {
     assert(tfile_);
     ttree_.reset(tfile_->Get<TTree>("events"));
     assert(ttree_);
+    ttree_->SetBranchAddress("event", &event_);
+
+    // Flatten the branch hierarchy
+    std::vector<TObjArray*> stack{ttree_->GetListOfBranches()};
+    while (!stack.empty())
+    {
+        auto* branches = stack.back();
+        stack.pop_back();
+        for (Int_t i = 0; i < branches->GetEntriesFast(); i++)
+        {
+            auto* branch = static_cast<TBranch*>(branches->UncheckedAt(i));
+            branches_.push_back(branch);
+            stack.push_back(branch->GetListOfBranches());
+        }
+    }
+    if (branches_.size() == 1)
+    {
+        // Event is not split
+        branches_.clear();
+    }
+    split_steps_ = ttree_->FindBranch("primaries.steps")
+                   && ttree_->FindBranch("secondaries.steps");
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Release the tree before the event object it points to.
+ */
+RootDataViewer::Reader::~Reader()
+{
+    ttree_.reset();
+    delete event_;
 }
 
 //---------------------------------------------------------------------------//
 /*!
- * Add event from benchmarks/geant4-validation-app.
+ * Decode an event from benchmarks/geant4-validation-app.
  *
- * If event id is negative, all events are drawn.
+ * Only the sub-branches needed to draw and filter tracks are read. When
+ * tracks are filtered and the step collections are split, the event is
+ * first read without steps. Steps of primaries and secondaries are then only
+ * decoded if at least one of the respective tracks is selected.
  */
-void RootDataViewer::add_event(int const event_id)
+EventData RootDataViewer::Reader::operator()(int event_id)
 {
-    assert(ttree_->GetEntries() > event_id);
+    assert(event_id >= 0 && event_id < ttree_->GetEntries());
 
-    rootdata::Event* event = nullptr;
-    ttree_->SetBranchAddress("event", &event);
+    auto const selection = this->make_selection();
+    if (!selected_ || !(selection == selection_))
+    {
+        this->select_branches(selection);
+    }
+    bool const defer = selection_.defer_steps;
 
-    // If negative, loop over all events; Otherwise, just draw selected event
-    int const first = (event_id < 0) ? 0 : event_id;
-    int const last = (event_id < 0) ? ttree_->GetEntries() : event_id + 1;
+    Int_t num_bytes;
+    {
+        ScopedTimer timer("GetEntry");
+        num_bytes = ttree_->GetEntry(event_id);
+    }
+
+    auto const primaries = this->select_tracks(event_->primaries, true);
+    auto const secondaries = this->select_tracks(event_->secondaries, false);
+    auto any = [](std::vector<bool> const& selected) {
+        return std::find(selected.begin(), selected.end(), true)
+               != selected.end();
+    };
+    std::vector<bool> const* selected[] = {&primaries, &secondaries};
+    for (int i : {0, 1})
+    {
+        if (defer && any(*selected[i]))
+        {
+            ScopedTimer timer("GetEntry");
+            for (auto* branch : deferred_steps_[i])
+            {
+                num_bytes += branch->GetEntry(event_id, /* getall = */ 1);
+            }
+        }
+    }
+    Profiler::add(Profiler::Counter::bytes_read, num_bytes);
+    Profiler::add(Profiler::Counter::entries_decoded, 1);
 
-    for (auto i = first; i < last; i++)
+    // Size the event arrays once for all selected tracks
+    std::size_t num_tracks = 0;
+    std::size_t num_points = 0;
+    auto count = [&](std::vector<rootdata::Track> const& tracks,
+                     std::vector<bool> const& selected) {
+        for (std::size_t i = 0; i < tracks.size(); i++)
+        {
+            if (selected[i])
+            {
+                ++num_tracks;
+                num_points += tracks[i].steps.size() + 1;
+            }
+        }
+    };
+    count(event_->primaries, primaries);
+    count(event_->secondaries, secondaries);
+
+    // Events are identified by tree entry, like in event_ids() and the cache
+    EventData result;
+    result.id = event_id;
+    result.reserve(num_tracks, num_points);
+    if (selection_.interactions)
+    {
+        result.interaction.reserve(num_points);
+    }
+    if (selection_.energy_deposition)
     {
-        ttree_->GetEntry(i);
-        this->create_event_tracks(event->primaries, event->id);
-        this->create_event_tracks(event->secondaries, event->id);
+        result.energy_deposits.reserve(num_points);
     }
+    if (selection_.times)
+    {
+        result.times.reserve(num_points);
+    }
+    this->add_tracks(event_->primaries, primaries, true, &result);
+    this->add_tracks(event_->secondaries, secondaries, false, &result);
+    return result;
 }
 
 //---------------------------------------------------------------------------//
-// PRIVATE
+/*!
+ * Sub-branches needed with the current filter and simplification options.
+ */
+auto RootDataViewer::Reader::make_selection() const -> Selection
+{
+    auto const& filter = viewer_.filter();
+    Selection result;
+    result.defer_steps = filter.has_track_cuts() && split_steps_;
+    result.attributes = viewer_.needs_attributes();
+    result.parents = viewer_.needs_parents();
+    result.energy = filter.needs_energy() || result.attributes;
+    result.length = filter.needs_length() || result.attributes;
+    result.interactions = viewer_.needs_interactions();
+    result.energy_deposition = viewer_.needs_energy_deposition();
+    result.times = viewer_.needs_times();
+    result.cache_size = viewer_.tree_cache_size();
+    return result;
+}
+
 //---------------------------------------------------------------------------//
+/*!
+ * Enable and cache only the sub-branches needed for drawing.
+ *
+ * Tracks need their id, pdg, vertex position and step positions; the vertex
+ * energy, length and step process are only read when used by the filter or
+ * the simplification, the parent id when track attributes or parents are
+ * decoded, the step energy loss when energy deposits are decoded, and the
+ * vertex and step global times when times are decoded. Direction and
+ * kinetic energy members and the sensitive detector scoring are never read.
+ *
+ * Branch bits are set directly instead of using \c TTree::SetBranchStatus ,
+ * whose pattern matching would also select unrelated branches containing the
+ * same name (e.g. \c id and \c parent_id ). Deferred step branches stay
+ * disabled and are read explicitly once tracks have been selected.
+ */
+void RootDataViewer::Reader::select_branches(Selection const& selection)
+{
+    selection_ = selection;
+    selected_ = true;
+    if (branches_.empty())
+    {
+        // Unsplit event is always read as a whole
+        setup_tree_cache(
+            *ttree_, {ttree_->GetBranch("event")}, selection.cache_size);
+        return;
+    }
+
+    // Branches needed without their sub-branches, and with all of them
+    std::set<std::string> nodes{"event", "id"};
+    std::vector<std::string> subtrees;
+    std::string const collections[] = {"primaries", "secondaries"};
+    for (auto const& c : collections)
+    {
+        nodes.insert({c, c + ".steps"});
+        subtrees.insert(subtrees.end(),
+                        {c + ".id",
+                         c + ".pdg",
+                         c + ".vertex_position",
+                         c + ".steps.position"});
+        if (selection.energy)
+        {
+            subtrees.push_back(c + ".vertex_energy");
+        }
+        if (selection.length)
+        {
+            subtrees.push_back(c + ".length");
+        }
+        if (selection.interactions)
+        {
+            subtrees.push_back(c + ".steps.process_id");
+        }
+        if (selection.parents)
+        {
+            subtrees.push_back(c + ".parent_id");
+        }
+        if (selection.energy_deposition)
+        {
+            subtrees.push_back(c + ".steps.energy_loss");
+        }
+        if (selection.times)
+        {
+            subtrees.push_back(c + ".vertex_global_time");
+            subtrees.push_back(c + ".steps.global_time");
+        }
+    }
+
+    auto in_subtree = [](std::string const& name, std::string const& top) {
+        return name.compare(0, top.size(), top) == 0
+               && (name.size() == top.size() || name[top.size()] == '.');
+    };
+
+    for (auto& steps : deferred_steps_)
+    {
+        steps.clear();
+    }
+    std::vector<TBranch*> cached;
+    for (auto* branch : branches_)
+    {
+        std::string name = branch->GetName();
+        if (in_subtree(name, "event") && name != "event")
+        {
+            // Sub-branches of an "event." branch carry its prefix
+            name.erase(0, 6);
+        }
+
+        bool needed = nodes.count(name) > 0;
+        for (auto const& top : subtrees)
+        {
+            needed = needed || in_subtree(name, top);
+        }
+
+        bool deferred = false;
+        for (int i : {0, 1})
+        {
+            if (needed && selection.defer_steps
+                && in_subtree(name, collections[i] + ".steps"))
+            {
+                deferred = true;
+                if (branch->GetListOfBranches()->GetEntriesFast() == 0)
+                {
+                    // Reading a leaf branch also reads its collection size
+                    deferred_steps_[i].push_back(branch);
+                }
+            }
+        }
+
+        if (needed && !deferred)
+        {
+            branch->ResetBit(TBranch::kDoNotProcess);
+        }
+        else
+        {
+            branch->SetBit(TBranch::kDoNotProcess);
+        }
+        if (needed)
+        {
+            cached.push_back(branch);
+        }
+    }
+    setup_tree_cache(*ttree_, cached, selection.cache_size);
+}
 
 //---------------------------------------------------------------------------//
 /*!
- * Loop over a vector of tracks (either primaries or secondaries), generate a
- * TEveLine for each, and add them to the viewer.
+ * Select tracks that pass the filter, using track-level data only.
  */
-void RootDataViewer::create_event_tracks(
-    std::vector<rootdata::Track> const& vec_tracks, int const event_id)
+std::vector<bool> RootDataViewer::Reader::select_tracks(
+    std::vector<rootdata::Track> const& tracks, bool is_primary) const
 {
-    for (auto const& track : vec_tracks)
+    std::vector<bool> result(tracks.size(), true);
+    auto const& filter = viewer_.filter();
+    if (filter.has_track_cuts())
     {
-        auto track_line = this->CreateTrackLine(track, event_id);
-        gEve->AddElement(track_line.release());
+        for (std::size_t i = 0; i < tracks.size(); i++)
+        {
+            // Energy and length are only read when used by the filter
+            auto const& track = tracks[i];
+            double const energy
+                = filter.needs_energy() ? track.vertex_energy : 0;
+            double const length = filter.needs_length() ? track.length : 0;
+            result[i]
+                = filter.pass_track(track.pdg, energy, length, is_primary);
+        }
     }
+    return result;
 }
 
 //---------------------------------------------------------------------------//
 /*!
- * Return a unique_ptr with a single TEveLine generated from the steps provided
- * by `rootdata::Track`.
+ * Loop over a vector of tracks (either primaries or secondaries) and store the
+ * vertex and step positions of each selected track. Interaction points are
+ * only flagged when the step processes are read, and track attributes (or
+ * parents alone), step energy losses and global times are only stored when
+ * requested.
  */
-std::unique_ptr<TEveLine>
-RootDataViewer::CreateTrackLine(rootdata::Track const& track,
-                                int const event_id)
+void RootDataViewer::Reader::add_tracks(
+    std::vector<rootdata::Track> const& vec_tracks,
+    std::vector<bool> const& selected,
+    bool is_primary,
+    EventData* result) const
 {
-    std::string track_name = std::to_string(event_id) + "_"
-                             + std::to_string(track.id) + "_"
-                             + this->to_string((PDG)track.pdg);
+    for (std::size_t i = 0; i < vec_tracks.size(); i++)
+    {
+        if (!selected[i])
+        {
+            continue;
+        }
 
-    auto track_line
-        = std::make_unique<TEveLine>((TEveLine::ETreeVarType_e::kTVT_XYZ));
-    track_line->SetName(track_name.c_str());
-    this->set_track_attributes(track_line.get(), (PDG)track.pdg);
+        auto const& track = vec_tracks[i];
+        result->add_track(track.id, track.pdg);
+        int const parent_id = is_primary ? -1
+                                         : static_cast<int>(track.parent_id);
+        if (selection_.attributes)
+        {
+            result->add_attributes(
+                parent_id, track.vertex_energy, track.length);
+        }
+        else if (selection_.parents)
+        {
+            result->add_parent(parent_id);
+        }
 
-    // Store vertex
-    auto const& vtx = track.vertex_position;
-    track_line->SetNextPoint(vtx.x, vtx.y, vtx.z);
+        // Store vertex and steps
+        auto const& vtx = track.vertex_position;
+        result->add_point(vtx.x, vtx.y, vtx.z);
+        for (auto const& step : track.steps)
+        {
+            auto const& pos = step.position;
+            result->add_point(pos.x, pos.y, pos.z);
+        }
 
-    for (auto const& step : track.steps)
-    {
-        // Store steps
-        auto const& pos = step.position;
-        track_line->SetNextPoint(pos.x, pos.y, pos.z);
-    }
+        if (selection_.interactions)
+        {
+            // Flag discrete interactions
+            auto& interaction = result->interaction;
+            interaction.push_back(false);
+            for (auto const& step : track.steps)
+            {
+                interaction.push_back(
+                    step.process_id != rootdata::ProcessId::transportation
+                    && step.process_id != rootdata::ProcessId::msc);
+            }
+        }
+
+        if (selection_.energy_deposition)
+        {
+            // Nothing is deposited at the vertex
+            auto& energy_deposits = result->energy_deposits;
+            energy_deposits.push_back(0);
+            for (auto const& step : track.steps)
+            {
+                energy_deposits.push_back(step.energy_loss);
+            }
+        }
 
-    return track_line;
+        if (selection_.times)
+        {
+            // Convert from [s]
+            auto& times = result->times;
+            times.push_back(
+                static_cast<float>(track.vertex_global_time * 1e9));
+            for (auto const& step : track.steps)
+            {
+                times.push_back(static_cast<float>(step.global_time * 1e9));
+            }
+        }
+    }
 }
@@ -18,6 +18,10 @@
 /*!
  * Draw event MC truth data from the benchmarks/geant4-validation-app.
  *
+ * Events are identified by their entry number in the \c events tree. If the
+ * \c event branch is split, only the sub-branches needed to draw and filter
+ * tracks (ids, pdg, vertex and step positions) are read.
+ *
  * This is a secondary class meant to be used along with \c MainViewer , which
  * *MUST* be initialized before this class is constructed.
  */
@@ -33,21 +37,24 @@ class RootDataViewer final : public MCTruthViewerInterface
     // Construct with ROOT input file
     RootDataViewer(UPTFile tfile);
 
-    // Add tracks for given event
-    void add_event(int event_id) override;
+    // Default destructor
+    ~RootDataViewer();
 
-  private:
-    //// DATA ////
+  protected:
+    // Sorted list of event ids available in the input
+    std::vector<int> event_ids() override;
+
+    // Reader using the input file handle
+    EventReader& reader() override;
 
-    UPTFile tfile_;
-    UPTTree ttree_;
+    // Create a reader with its own file handle
+    std::unique_ptr<EventReader> make_reader() const override;
 
-    //// HELPER FUNCTIONS ////
+  private:
+    class Reader;
+
+    //// DATA ////
 
-    // Create track line
-    std::unique_ptr<TEveLine>
-    CreateTrackLine(rootdata::Track const& track, int const event_id);
-    // Loop over event tracks and generate track lines
-    void create_event_tracks(std::vector<rootdata::Track> const& vec_tracks,
-                             int const event_id);
+    std::string filename_;
+    std::unique_ptr<Reader> reader_;
 };
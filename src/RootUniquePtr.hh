@@ -7,6 +7,7 @@
 //---------------------------------------------------------------------------//
 #pragma once
 
+#include <memory>
 #include <TFile.h>
 #include <TTree.h>
 #include <assert.h>
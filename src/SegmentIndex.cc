@@ -0,0 +1,536 @@
+//----------------------------------*-C++-*----------------------------------//
+// Copyright 2023 UT-Battelle, LLC, and other Celeritas developers.
+// See the top-level COPYRIGHT file for details.
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+//---------------------------------------------------------------------------//
+//! \file src/SegmentIndex.cc
+//---------------------------------------------------------------------------//
+#include "SegmentIndex.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <utility>
+#include <assert.h>
+
+#include "ParallelFor.hh"
+#include "Profiler.hh"
+
+namespace
+{
+//---------------------------------------------------------------------------//
+// Number of elements processed at once by a worker thread
+constexpr std::size_t chunk_size = 1 << 14;
+
+//---------------------------------------------------------------------------//
+// Bits of the segment position in a sort key
+constexpr int index_bits = 34;
+
+//---------------------------------------------------------------------------//
+// Call func(first, last) on consecutive ranges of [0, size) in parallel
+template<class F>
+void parallel_chunks(std::size_t size, unsigned int num_threads, F&& func)
+{
+    parallel_for((size + chunk_size - 1) / chunk_size,
+                 num_threads,
+                 [&](std::size_t chunk, unsigned int) {
+                     auto const first = chunk * chunk_size;
+                     func(first, std::min(first + chunk_size, size));
+                 });
+}
+
+//---------------------------------------------------------------------------//
+// Spread the lower 10 bits of a value to every third bit
+std::uint32_t spread_bits(std::uint32_t v)
+{
+    v = (v | (v << 16)) & 0x030000FF;
+    v = (v | (v << 8)) & 0x0300F00F;
+    v = (v | (v << 4)) & 0x030C30C3;
+    v = (v | (v << 2)) & 0x09249249;
+    return v;
+}
+
+//---------------------------------------------------------------------------//
+// Clip the ray start + t * dir to a box, narrowing [t_min, t_max]
+template<class T>
+bool clip(double const* start,
+          double const* dir,
+          T const& lower,
+          T const& upper,
+          double* t_min,
+          double* t_max)
+{
+    for (int i = 0; i < 3; i++)
+    {
+        if (dir[i] == 0)
+        {
+            if (start[i] < lower[i] || start[i] > upper[i])
+            {
+                return false;
+            }
+            continue;
+        }
+        double t_lower = (lower[i] - start[i]) / dir[i];
+        double t_upper = (upper[i] - start[i]) / dir[i];
+        if (t_lower > t_upper)
+        {
+            std::swap(t_lower, t_upper);
+        }
+        *t_min = std::max(*t_min, t_lower);
+        *t_max = std::min(*t_max, t_upper);
+        if (*t_min > *t_max)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+//---------------------------------------------------------------------------//
+// Dot product
+double dot(double const* a, double const* b)
+{
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+//---------------------------------------------------------------------------//
+// Squared distance from a point to a segment
+double distance_sq(double const* pos, Point const* seg)
+{
+    double dir[3];
+    double rel[3];
+    double len_sq = 0;
+    double proj = 0;
+    for (int i = 0; i < 3; i++)
+    {
+        dir[i] = double(seg[1][i]) - double(seg[0][i]);
+        rel[i] = pos[i] - double(seg[0][i]);
+        len_sq += dir[i] * dir[i];
+        proj += dir[i] * rel[i];
+    }
+    double const t = len_sq > 0 ? std::min(1.0, std::max(0.0, proj / len_sq))
+                                : 0.0;
+    double result = 0;
+    for (int i = 0; i < 3; i++)
+    {
+        double const d = rel[i] - t * dir[i];
+        result += d * d;
+    }
+    return result;
+}
+
+//---------------------------------------------------------------------------//
+}  // namespace
+
+//---------------------------------------------------------------------------//
+/*!
+ * Build over all segments of the given events, using \c num_threads threads.
+ */
+SegmentIndex::SegmentIndex(std::vector<EventData> const& events,
+                           unsigned int num_threads)
+    : events_(events)
+{
+    ScopedTimer timer("Segment index build");
+    assert(events.size() <= std::numeric_limits<std::uint32_t>::max());
+
+    // Count segments of each event
+    std::vector<std::size_t> offsets(events.size() + 1, 0);
+    parallel_for(events.size(), num_threads, [&](std::size_t e, unsigned int) {
+        auto const& event = events[e];
+        std::size_t count = 0;
+        for (std::size_t t = 0; t < event.num_tracks(); t++)
+        {
+            auto const num_points = event.offsets[t + 1] - event.offsets[t];
+            count += num_points > 0 ? num_points - 1 : 0;
+        }
+        offsets[e + 1] = count;
+    });
+    std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+    auto const size = offsets.back();
+    assert(size < (std::uint64_t(1) << index_bits));
+
+    // List segments in input order, along with the bounds of their points
+    Box const empty{{std::numeric_limits<real_type>::max(),
+                     std::numeric_limits<real_type>::max(),
+                     std::numeric_limits<real_type>::max()},
+                    {std::numeric_limits<real_type>::lowest(),
+                     std::numeric_limits<real_type>::lowest(),
+                     std::numeric_limits<real_type>::lowest()}};
+    auto expand = [](Box* box, Point const& p) {
+        for (int i = 0; i < 3; i++)
+        {
+            box->lower[i] = std::min(box->lower[i], p[i]);
+            box->upper[i] = std::max(box->upper[i], p[i]);
+        }
+    };
+    std::vector<Segment> unsorted(size);
+    std::vector<Box> thread_bounds(std::max(1u, num_threads), empty);
+    parallel_for(events.size(),
+                 num_threads,
+                 [&](std::size_t e, unsigned int thread_id) {
+                     auto const& event = events[e];
+                     auto& box = thread_bounds[thread_id];
+                     auto* out = unsorted.data() + offsets[e];
+                     for (std::size_t t = 0; t < event.num_tracks(); t++)
+                     {
+                         auto const first = event.offsets[t];
+                         auto const last = event.offsets[t + 1];
+                         for (auto p = first + 1; p < last; p++)
+                         {
+                             *out++ = {static_cast<std::uint32_t>(e), p};
+                             expand(&box, event.points[p - 1]);
+                         }
+                         if (last > first + 1)
+                         {
+                             expand(&box, event.points[last - 1]);
+                         }
+                     }
+                 });
+    Box bounds = empty;
+    for (auto const& b : thread_bounds)
+    {
+        expand(&bounds, b.lower);
+        expand(&bounds, b.upper);
+    }
+    if (size == 0)
+    {
+        return;
+    }
+
+    // Sort segments along the Morton curve through their midpoints
+    std::array<double, 3> scale;
+    for (int i = 0; i < 3; i++)
+    {
+        double const width = double(bounds.upper[i]) - bounds.lower[i];
+        scale[i] = width > 0 ? 1023.999 / width : 0;
+    }
+    std::vector<std::uint64_t> keys(size);
+    parallel_chunks(
+        size, num_threads, [&](std::size_t first, std::size_t last) {
+            for (auto i = first; i < last; i++)
+            {
+                auto const* p = this->points(unsorted[i]);
+                std::uint32_t code = 0;
+                for (int j = 0; j < 3; j++)
+                {
+                    double const mid = (double(p[0][j]) + p[1][j]) / 2;
+                    auto const cell = static_cast<std::uint32_t>(
+                        (mid - bounds.lower[j]) * scale[j]);
+                    code |= spread_bits(std::min(cell, 1023u)) << j;
+                }
+                keys[i] = (std::uint64_t(code) << index_bits) | i;
+            }
+        });
+    parallel_sort(&keys, num_threads);
+
+    segments_.resize(size);
+    std::uint64_t const index_mask = (std::uint64_t(1) << index_bits) - 1;
+    parallel_chunks(
+        size, num_threads, [&](std::size_t first, std::size_t last) {
+            for (auto i = first; i < last; i++)
+            {
+                segments_[i] = unsorted[keys[i] & index_mask];
+            }
+        });
+    std::vector<std::uint64_t>().swap(keys);
+    std::vector<Segment>().swap(unsorted);
+
+    // Allocate all levels, from leaves to the root
+    level_offsets_.push_back(0);
+    std::size_t level_size = (size + leaf_size - 1) / leaf_size;
+    while (true)
+    {
+        level_offsets_.push_back(level_offsets_.back() + level_size);
+        if (level_size == 1)
+        {
+            break;
+        }
+        level_size = (level_size + 1) / 2;
+    }
+    nodes_.resize(level_offsets_.back());
+    level_offsets_.pop_back();
+
+    // Bound leaves, then pairs of nodes of each level
+    parallel_chunks(level_offsets_.size() > 1 ? level_offsets_[1]
+                                              : nodes_.size(),
+                    num_threads,
+                    [&](std::size_t first, std::size_t last) {
+                        for (auto n = first; n < last; n++)
+                        {
+                            Box box = empty;
+                            auto const end
+                                = std::min((n + 1) * leaf_size, size);
+                            for (auto s = n * leaf_size; s < end; s++)
+                            {
+                                auto const* p = this->points(segments_[s]);
+                                expand(&box, p[0]);
+                                expand(&box, p[1]);
+                            }
+                            nodes_[n] = box;
+                        }
+                    });
+    for (std::size_t level = 1; level < level_offsets_.size(); level++)
+    {
+        auto const* children = nodes_.data() + level_offsets_[level - 1];
+        auto const num_children = level_offsets_[level]
+                                  - level_offsets_[level - 1];
+        auto* parents = nodes_.data() + level_offsets_[level];
+        auto const num_parents = (num_children + 1) / 2;
+        parallel_chunks(
+            num_parents,
+            num_threads,
+            [&](std::size_t first, std::size_t last) {
+                for (auto n = first; n < last; n++)
+                {
+                    Box box = children[2 * n];
+                    if (2 * n + 1 < num_children)
+                    {
+                        expand(&box, children[2 * n + 1].lower);
+                        expand(&box, children[2 * n + 1].upper);
+                    }
+                    parents[n] = box;
+                }
+            });
+    }
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Segments crossing a box, in index order.
+ */
+auto SegmentIndex::intersect(BoundingBox const& box) const
+    -> std::vector<Segment>
+{
+    std::vector<Segment> result;
+    this->traverse(
+        [&box](Box const& node) {
+            for (int i = 0; i < 3; i++)
+            {
+                if (node.upper[i] < box.lower[i]
+                    || node.lower[i] > box.upper[i])
+                {
+                    return false;
+                }
+            }
+            return true;
+        },
+        [this, &box, &result](Segment s) {
+            auto const* p = this->points(s);
+            double start[3];
+            double dir[3];
+            for (int i = 0; i < 3; i++)
+            {
+                start[i] = p[0][i];
+                dir[i] = double(p[1][i]) - double(p[0][i]);
+            }
+            double t_min = 0;
+            double t_max = 1;
+            if (clip(start, dir, box.lower, box.upper, &t_min, &t_max))
+            {
+                result.push_back(s);
+            }
+        });
+    return result;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Segments crossing a sphere, in index order.
+ */
+auto SegmentIndex::intersect(Vec3 const& center, double radius) const
+    -> std::vector<Segment>
+{
+    double const radius_sq = radius * radius;
+    std::vector<Segment> result;
+    this->traverse(
+        [&center, radius_sq](Box const& node) {
+            double dist_sq = 0;
+            for (int i = 0; i < 3; i++)
+            {
+                double const d
+                    = std::max({0.0,
+                                double(node.lower[i]) - center[i],
+                                center[i] - double(node.upper[i])});
+                dist_sq += d * d;
+            }
+            return dist_sq <= radius_sq;
+        },
+        [this, &center, radius_sq, &result](Segment s) {
+            if (distance_sq(center.data(), this->points(s)) <= radius_sq)
+            {
+                result.push_back(s);
+            }
+        });
+    return result;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Segment passing within \c tolerance [cm] of a ray, closest to its origin.
+ *
+ * The distance of a hit is measured along the ray to the point closest to
+ * the segment. Nodes farther along the ray than the best hit so far are not
+ * visited.
+ */
+auto SegmentIndex::pick(Vec3 const& origin,
+                        Vec3 const& direction,
+                        double tolerance) const -> Hit
+{
+    double norm = 0;
+    for (auto d : direction)
+    {
+        norm += d * d;
+    }
+    assert(norm > 0);
+    norm = std::sqrt(norm);
+    Vec3 const dir{
+        direction[0] / norm, direction[1] / norm, direction[2] / norm};
+    double const tolerance_sq = tolerance * tolerance;
+
+    Hit result;
+    double best = std::numeric_limits<double>::infinity();
+    this->traverse(
+        [&](Box const& node) {
+            Vec3 lower;
+            Vec3 upper;
+            for (int i = 0; i < 3; i++)
+            {
+                lower[i] = node.lower[i] - tolerance;
+                upper[i] = node.upper[i] + tolerance;
+            }
+            double t_min = 0;
+            double t_max = best;
+            return clip(
+                origin.data(), dir.data(), lower, upper, &t_min, &t_max);
+        },
+        [&](Segment s) {
+            // Closest points of the ray and the segment
+            auto const* p = this->points(s);
+            double seg[3];
+            double rel[3];
+            for (int i = 0; i < 3; i++)
+            {
+                seg[i] = double(p[1][i]) - double(p[0][i]);
+                rel[i] = origin[i] - double(p[0][i]);
+            }
+            double const b = dot(dir.data(), seg);
+            double const c = dot(dir.data(), rel);
+            double const e = dot(seg, seg);
+            double const f = dot(seg, rel);
+            double const denom = e - b * b;
+
+            double t = (e > 0 && denom > 1e-12 * e) ? (b * f - c * e) / denom
+                                                    : -c;
+            t = std::max(t, 0.0);
+            double u = e > 0 ? (b * t + f) / e : 0;
+            if (u < 0 || u > 1)
+            {
+                u = std::min(1.0, std::max(0.0, u));
+                t = std::max(0.0, b * u - c);
+            }
+            if (!(t < best))
+            {
+                return;
+            }
+            double dist_sq = 0;
+            for (int i = 0; i < 3; i++)
+            {
+                double const d = rel[i] + t * dir[i] - u * seg[i];
+                dist_sq += d * d;
+            }
+            if (dist_sq <= tolerance_sq)
+            {
+                best = t;
+                result.segment = s;
+                result.distance = t;
+            }
+        });
+    return result;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Index of the track of a segment in its event.
+ */
+std::size_t SegmentIndex::track_index(Segment s) const
+{
+    auto const& offsets = this->event(s).offsets;
+    auto iter = std::upper_bound(offsets.begin(), offsets.end(), s.point);
+    assert(iter != offsets.begin() && iter != offsets.end());
+    return iter - offsets.begin() - 1;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Bounds of all indexed segments; invalid if there are none.
+ */
+BoundingBox SegmentIndex::bounds() const
+{
+    BoundingBox result{{0, 0, 0}, {0, 0, 0}};
+    if (nodes_.empty())
+    {
+        return result;
+    }
+    auto const& root = nodes_.back();
+    for (int i = 0; i < 3; i++)
+    {
+        result.lower[i] = root.lower[i];
+        result.upper[i] = root.upper[i];
+    }
+    return result;
+}
+
+//---------------------------------------------------------------------------//
+// PRIVATE
+//---------------------------------------------------------------------------//
+
+//---------------------------------------------------------------------------//
+/*!
+ * Visit the segments of all leaves whose bounds, and the bounds of all their
+ * ancestors, are accepted by \c accept_node .
+ *
+ * The predicate may change while traversing, e.g. to prune nodes beyond the
+ * best result so far.
+ */
+template<class F, class G>
+void SegmentIndex::traverse(F&& accept_node, G&& visit) const
+{
+    if (nodes_.empty())
+    {
+        return;
+    }
+
+    // Level and index in the level of the nodes left to visit
+    std::vector<std::pair<std::size_t, std::size_t>> stack;
+    stack.emplace_back(level_offsets_.size() - 1, 0);
+    while (!stack.empty())
+    {
+        auto const level = stack.back().first;
+        auto const index = stack.back().second;
+        stack.pop_back();
+        if (!accept_node(nodes_[level_offsets_[level] + index]))
+        {
+            continue;
+        }
+
+        if (level == 0)
+        {
+            auto const end = std::min((index + 1) * leaf_size,
+                                      segments_.size());
+            for (auto s = index * leaf_size; s < end; s++)
+            {
+                visit(segments_[s]);
+            }
+            continue;
+        }
+
+        auto const num_children = level_offsets_[level]
+                                  - level_offsets_[level - 1];
+        if (2 * index + 1 < num_children)
+        {
+            stack.emplace_back(level - 1, 2 * index + 1);
+        }
+        stack.emplace_back(level - 1, 2 * index);
+    }
+}
@@ -0,0 +1,124 @@
+//----------------------------------*-C++-*----------------------------------//
+// Copyright 2023 UT-Battelle, LLC, and other Celeritas developers.
+// See the top-level COPYRIGHT file for details.
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+//---------------------------------------------------------------------------//
+//! \file src/SegmentIndex.hh
+//---------------------------------------------------------------------------//
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "BoundingBox.hh"
+#include "EventData.hh"
+
+//---------------------------------------------------------------------------//
+/*!
+ * Bounding volume hierarchy over the step segments of decoded events.
+ *
+ * Segments are sorted along a Morton curve through their midpoints and
+ * grouped into leaves of \c leaf_size consecutive segments. Each level of the
+ * tree bounds pairs of nodes of the level below, so that the tree needs no
+ * child links: it is stored as one array of boxes per level, leaves first.
+ * Every step of the construction runs in parallel over segments or nodes.
+ *
+ * The index refers to the points of the events it was built from, which
+ * must outlive it and must not be modified.
+ *
+ * \code
+ *  SegmentIndex index(events, num_threads);
+ *  for (auto segment : index.intersect(box))
+ *  {
+ *      auto const& event = index.event(segment);
+ *      ...
+ *  }
+ * \endcode
+ */
+class SegmentIndex
+{
+  public:
+    //!@{
+    //! \name Type aliases
+    using Vec3 = std::array<double, 3>;
+    //!@}
+
+    //! Step segment, ending at a given point of an indexed event
+    struct Segment
+    {
+        std::uint32_t event;  //!< Index in the indexed events
+        std::uint32_t point;  //!< Post-step point; the pre-step one precedes
+    };
+
+    //! Segment closest to the origin of a ray
+    struct Hit
+    {
+        Segment segment{0, 0};
+        double distance{-1};  //!< Along the ray [cm]; negative if missed
+
+        //! Whether a segment was hit
+        explicit operator bool() const { return distance >= 0; }
+    };
+
+    //! Number of segments per leaf
+    static constexpr std::size_t leaf_size = 16;
+
+    // Build over all segments of the given events
+    SegmentIndex(std::vector<EventData> const& events,
+                 unsigned int num_threads);
+
+    // Segments crossing a box
+    std::vector<Segment> intersect(BoundingBox const& box) const;
+
+    // Segments crossing a sphere
+    std::vector<Segment> intersect(Vec3 const& center, double radius) const;
+
+    // First segment passing within a distance of a ray
+    Hit
+    pick(Vec3 const& origin, Vec3 const& direction, double tolerance) const;
+
+    //! Event of a segment
+    EventData const& event(Segment s) const { return events_[s.event]; }
+
+    // Index of the track of a segment in its event
+    std::size_t track_index(Segment s) const;
+
+    //! Number of indexed segments
+    std::size_t num_segments() const { return segments_.size(); }
+
+    //! Number of tree nodes, leaves included
+    std::size_t num_nodes() const { return nodes_.size(); }
+
+    //! Bounds of all segments; invalid if there are none
+    BoundingBox bounds() const;
+
+  private:
+    //// TYPES ////
+
+    //! Bounds of a node, in the precision of the points
+    struct Box
+    {
+        Point lower;
+        Point upper;
+    };
+
+    //// DATA ////
+
+    std::vector<EventData> const& events_;
+    std::vector<Segment> segments_;  //!< Sorted along the Morton curve
+    std::vector<Box> nodes_;  //!< All levels, leaves first
+    std::vector<std::size_t> level_offsets_;  //!< First node of each level
+
+    //// HELPER FUNCTIONS ////
+
+    // Endpoints of a segment
+    Point const* points(Segment s) const
+    {
+        return events_[s.event].points.data() + s.point - 1;
+    }
+
+    // Visit the segments of leaves accepted by a node predicate
+    template<class F, class G>
+    void traverse(F&& accept_node, G&& visit) const;
+};
@@ -0,0 +1,462 @@
+//----------------------------------*-C++-*----------------------------------//
+// Copyright 2023 UT-Battelle, LLC, and other Celeritas developers.
+// See the top-level COPYRIGHT file for details.
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+//---------------------------------------------------------------------------//
+//! \file src/SegmentQuery.cc
+//---------------------------------------------------------------------------//
+#include "SegmentQuery.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+#include <TEveBrowser.h>
+#include <TEveManager.h>
+#include <TGButton.h>
+#include <TGClient.h>
+#include <TGFrame.h>
+#include <TGLClip.h>
+#include <TGLViewer.h>
+#include <TGLayout.h>
+#include <TGTextEntry.h>
+#include <WidgetMessageTypes.h>
+
+#include "Profiler.hh"
+
+namespace
+{
+//---------------------------------------------------------------------------//
+using Clock = std::chrono::steady_clock;
+using Milliseconds = std::chrono::duration<double, std::milli>;
+using Seconds = std::chrono::duration<double>;
+
+//---------------------------------------------------------------------------//
+// Maximum number of track names printed by a query
+constexpr std::size_t max_printed = 10;
+
+//---------------------------------------------------------------------------//
+// Parse a comma-separated list of numbers; empty if it is invalid
+std::vector<double> parse_values(std::string const& list)
+{
+    std::vector<double> result;
+    std::stringstream ss(list);
+    for (std::string value; std::getline(ss, value, ',');)
+    {
+        try
+        {
+            result.push_back(std::stod(value));
+        }
+        catch (std::exception const&)
+        {
+            return {};
+        }
+    }
+    return result;
+}
+
+//---------------------------------------------------------------------------//
+}  // namespace
+
+//---------------------------------------------------------------------------//
+/*!
+ * Query entry and culling buttons, embedded in the browser.
+ */
+class SegmentQuery::Frame final : public TGMainFrame
+{
+  public:
+    // Construct in the window currently being embedded
+    explicit Frame(SegmentQuery* query);
+
+    //! Stop forwarding button clicks
+    void detach() { query_ = nullptr; }
+
+    // Handle buttons and query entry
+    Bool_t ProcessMessage(Longptr_t msg, Longptr_t parm1, Longptr_t) final;
+
+  private:
+    enum
+    {
+        query_id = 1,
+        cull_id,
+        show_all_id
+    };
+
+    SegmentQuery* query_;
+    TGTextEntry* entry_;
+};
+
+//---------------------------------------------------------------------------//
+/*!
+ * Construct and add the query frame to the browser.
+ */
+SegmentQuery::SegmentQuery(MCTruthViewerInterface& viewer) : viewer_(viewer)
+{
+    auto* browser = gEve->GetBrowser();
+    browser->StartEmbedding(TRootBrowser::kLeft);
+    frame_ = new Frame(this);
+    browser->StopEmbedding("Segments");
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * The frame is owned by the browser and may outlive the query controls.
+ */
+SegmentQuery::~SegmentQuery()
+{
+    frame_->detach();
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Run a box, sphere, or ray query and print its result.
+ */
+void SegmentQuery::run(std::string const& query)
+{
+    auto const* index = this->index();
+    if (!index)
+    {
+        return;
+    }
+
+    std::stringstream ss(query);
+    std::string shape;
+    std::string list;
+    ss >> shape >> list;
+    auto const v = parse_values(list);
+    auto const start = Clock::now();
+
+    if (shape == "box" && v.size() == 6)
+    {
+        BoundingBox const box{{v[0], v[1], v[2]}, {v[3], v[4], v[5]}};
+        if (!box)
+        {
+            std::cout << "[WARNING] Box query must have a positive size "
+                         "along each axis"
+                      << std::endl;
+            return;
+        }
+        this->print_tracks(index->intersect(box));
+    }
+    else if (shape == "sphere" && v.size() == 4 && v[3] >= 0)
+    {
+        this->print_tracks(index->intersect({v[0], v[1], v[2]}, v[3]));
+    }
+    else if (shape == "ray" && (v.size() == 6 || v.size() == 7)
+             && (v[3] != 0 || v[4] != 0 || v[5] != 0))
+    {
+        double const tolerance = v.size() == 7 ? v[6] : 0.1;
+        auto const hit
+            = index->pick({v[0], v[1], v[2]}, {v[3], v[4], v[5]}, tolerance);
+        if (hit)
+        {
+            auto const& event = index->event(hit.segment);
+            auto const track = event.track(index->track_index(hit.segment));
+            std::cout << "Picked track " << viewer_.track_name(event.id, track)
+                      << " at " << hit.distance << " cm along the ray";
+        }
+        else
+        {
+            std::cout << "No track within " << tolerance << " cm of the ray";
+        }
+        std::cout << std::endl;
+    }
+    else
+    {
+        std::cout << "[WARNING] Invalid query '" << query
+                  << "'. Expected box xmin,ymin,zmin,xmax,ymax,zmax, "
+                     "sphere x,y,z,r, or ray x,y,z,dx,dy,dz[,tolerance]"
+                  << std::endl;
+        return;
+    }
+    std::cout << "Query time: " << Milliseconds(Clock::now() - start).count()
+              << " ms" << std::endl;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Only draw segments inside the clip box of the main viewer.
+ *
+ * The box clip must be enabled in the GL viewer editor; culled tracks stay
+ * drawn if it is moved or disabled afterwards.
+ */
+void SegmentQuery::cull_to_clip_box()
+{
+    auto* clip_set = gEve->GetDefaultGLViewer()->GetClipSet();
+    if (clip_set->GetClipType() != TGLClip::kClipBox)
+    {
+        std::cout << "[WARNING] Enable the box clip of the main viewer first"
+                  << std::endl;
+        return;
+    }
+
+    // Center and extents of the box
+    Double_t data[6];
+    clip_set->GetClipState(TGLClip::kClipBox, data);
+    BoundingBox box;
+    for (int i = 0; i < 3; i++)
+    {
+        box.lower[i] = data[i] - data[i + 3] / 2;
+        box.upper[i] = data[i] + data[i + 3] / 2;
+    }
+    this->cull(box);
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Only draw the segments crossing a box.
+ *
+ * Segments outside the box are skipped before any Eve element is created, so
+ * that rendering and picking only pay for the visible part of large events.
+ * Culled segments are drawn at full resolution as one segment set per
+ * species, whatever the track display; tracks crossing the box several times
+ * are split into several polylines.
+ */
+void SegmentQuery::cull(BoundingBox const& box)
+{
+    auto const* index = this->index();
+    if (!index)
+    {
+        return;
+    }
+
+    auto const start = Clock::now();
+    auto segments = index->intersect(box);
+    std::sort(segments.begin(),
+              segments.end(),
+              [](SegmentIndex::Segment a, SegmentIndex::Segment b) {
+                  return a.event != b.event ? a.event < b.event
+                                            : a.point < b.point;
+              });
+    viewer_.destroy_tracks();
+    this->draw_segments(segments);
+    culled_revision_ = viewer_.tracks_revision();
+    culled_ = true;
+    gEve->Redraw3D();
+
+    std::cout << "Drawing " << segments.size() << " of "
+              << index->num_segments() << " segments inside the clip box ("
+              << Milliseconds(Clock::now() - start).count() << " ms)"
+              << std::endl;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Draw all tracks again, if they were culled.
+ */
+void SegmentQuery::show_all()
+{
+    if (!this->culled())
+    {
+        return;
+    }
+    viewer_.redraw();
+    culled_ = false;
+    gEve->Redraw3D();
+}
+
+//---------------------------------------------------------------------------//
+// PRIVATE
+//---------------------------------------------------------------------------//
+
+//---------------------------------------------------------------------------//
+/*!
+ * Index of the segments of the drawn events, built on \c num_threads()
+ * threads if the drawn events changed since it was last built.
+ *
+ * The index only refers to the points of the events kept by the viewer, so
+ * that its memory use is a small fraction of theirs. Returns null, with a
+ * warning, while events are loading.
+ */
+SegmentIndex const* SegmentQuery::index()
+{
+    if (!viewer_.load_progress().done)
+    {
+        std::cout << "[WARNING] Segments are indexed once loading finishes"
+                  << std::endl;
+        return nullptr;
+    }
+    if (!index_ || index_revision_ != viewer_.events_revision())
+    {
+        auto const start = Clock::now();
+        index_ = std::make_unique<SegmentIndex>(viewer_.drawn_events(),
+                                                viewer_.num_threads());
+        index_revision_ = viewer_.events_revision();
+        std::cout << "Segment index: " << index_->num_segments()
+                  << " segments in " << index_->num_nodes()
+                  << " nodes, built in "
+                  << Seconds(Clock::now() - start).count() << " s"
+                  << std::endl;
+    }
+    return index_.get();
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Whether the culled segments are still drawn, i.e. the viewer did not
+ * destroy them to draw its tracks again.
+ */
+bool SegmentQuery::culled() const
+{
+    return culled_ && culled_revision_ == viewer_.tracks_revision();
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Draw segments sorted by event and point as one segment set per species.
+ *
+ * Consecutive steps of a track are merged into a single polyline.
+ */
+void SegmentQuery::draw_segments(
+    std::vector<SegmentIndex::Segment> const& segments)
+{
+    std::map<int, TrackSegmentSet*> sets;
+    for (std::size_t first = 0; first < segments.size();)
+    {
+        auto const s = segments[first];
+        auto const& event = index_->event(s);
+        auto const track = event.track(index_->track_index(s));
+        auto const track_end = track.first + track.num_points;
+
+        // Extend the run while steps follow each other in the same track
+        std::size_t last = first + 1;
+        while (last < segments.size() && segments[last].event == s.event
+               && segments[last].point == s.point + (last - first)
+               && segments[last].point < track_end)
+        {
+            ++last;
+        }
+
+        auto const pdg = MCTruthViewerInterface::species(track.pdg);
+        auto& set = sets[pdg];
+        if (!set)
+        {
+            set = viewer_.add_segment_set(
+                pdg, viewer_.species_name(track.pdg) + " (culled)");
+        }
+        auto const num_points = last - first + 1;
+        set->add_track(viewer_.track_name(event.id, track),
+                       event.points.data() + s.point - 1,
+                       num_points,
+                       viewer_.step_points() && pdg == track.pdg);
+        Profiler::add(Profiler::Counter::points_created, num_points);
+        first = last;
+    }
+
+    for (auto const& id_set : sets)
+    {
+        id_set.second->ComputeBBox();
+        id_set.second->StampObjProps();
+    }
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Print the number of segments and tracks found, and the first track names.
+ */
+void SegmentQuery::print_tracks(
+    std::vector<SegmentIndex::Segment> const& segments)
+{
+    auto const* index = index_.get();
+    std::set<std::pair<std::uint32_t, std::size_t>> tracks;
+    for (auto s : segments)
+    {
+        tracks.insert({s.event, index->track_index(s)});
+    }
+
+    std::cout << "Found " << segments.size() << " segments of "
+              << tracks.size() << " tracks" << std::endl;
+    std::size_t count = 0;
+    for (auto const& event_track : tracks)
+    {
+        if (count++ == max_printed)
+        {
+            std::cout << "  ..." << std::endl;
+            break;
+        }
+        auto const& event = index->event({event_track.first, 0});
+        std::cout << "  "
+                  << viewer_.track_name(event.id,
+                                        event.track(event_track.second))
+                  << std::endl;
+    }
+}
+
+//---------------------------------------------------------------------------//
+// FRAME
+//---------------------------------------------------------------------------//
+
+//---------------------------------------------------------------------------//
+/*!
+ * Construct in the window currently being embedded.
+ */
+SegmentQuery::Frame::Frame(SegmentQuery* query)
+    : TGMainFrame(gClient->GetRoot(), 300, 100), query_(query)
+{
+    this->SetCleanup(kDeepCleanup);
+
+    // Region query
+    auto* query_group = new TGGroupFrame(this, "Query");
+    entry_ = new TGTextEntry(
+        query_group, "box -10,-10,-10,10,10,10", query_id);
+    entry_->Associate(this);
+    query_group->AddFrame(entry_,
+                          new TGLayoutHints(kLHintsExpandX, 2, 2, 4, 2));
+    auto* run = new TGTextButton(query_group, "Run", query_id);
+    run->Associate(this);
+    query_group->AddFrame(run, new TGLayoutHints(kLHintsRight, 2, 2, 2, 4));
+    this->AddFrame(query_group, new TGLayoutHints(kLHintsExpandX, 4, 4, 4, 4));
+
+    // Clip box culling
+    auto* cull_group = new TGGroupFrame(this, "Clip box");
+    auto* cull_row = new TGHorizontalFrame(cull_group);
+    auto* cull = new TGTextButton(cull_row, "Cull", cull_id);
+    auto* show_all = new TGTextButton(cull_row, "Show all", show_all_id);
+    cull->Associate(this);
+    show_all->Associate(this);
+    cull_row->AddFrame(cull, new TGLayoutHints(kLHintsExpandX, 0, 2));
+    cull_row->AddFrame(show_all, new TGLayoutHints(kLHintsExpandX, 2, 0));
+    cull_group->AddFrame(cull_row,
+                         new TGLayoutHints(kLHintsExpandX, 2, 2, 4, 4));
+    this->AddFrame(cull_group, new TGLayoutHints(kLHintsExpandX, 4, 4, 4, 4));
+
+    this->MapSubwindows();
+    this->Resize(this->GetDefaultSize());
+    this->MapWindow();
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Run the entered query or cull tracks to the clip box.
+ */
+Bool_t SegmentQuery::Frame::ProcessMessage(Longptr_t msg,
+                                           Longptr_t parm1,
+                                           Longptr_t)
+{
+    if (!query_)
+    {
+        return kTRUE;
+    }
+
+    bool const clicked = (GET_MSG(msg) == kC_COMMAND
+                          && GET_SUBMSG(msg) == kCM_BUTTON);
+    bool const entered = (GET_MSG(msg) == kC_TEXTENTRY
+                          && GET_SUBMSG(msg) == kTE_ENTER);
+    if ((clicked || entered) && parm1 == query_id)
+    {
+        query_->run(entry_->GetText());
+    }
+    else if (clicked && parm1 == cull_id)
+    {
+        query_->cull_to_clip_box();
+    }
+    else if (clicked && parm1 == show_all_id)
+    {
+        query_->show_all();
+    }
+    return kTRUE;
+}
@@ -0,0 +1,81 @@
+//----------------------------------*-C++-*----------------------------------//
+// Copyright 2023 UT-Battelle, LLC, and other Celeritas developers.
+// See the top-level COPYRIGHT file for details.
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+//---------------------------------------------------------------------------//
+//! \file src/SegmentQuery.hh
+//---------------------------------------------------------------------------//
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "BoundingBox.hh"
+#include "MCTruthViewerInterface.hh"
+#include "SegmentIndex.hh"
+
+//---------------------------------------------------------------------------//
+/*!
+ * Region queries and clip box culling in a \c Segments tab of the browser.
+ *
+ * The step segments of the events drawn by the viewer are indexed on the
+ * first query once loading finishes, and again whenever the drawn events
+ * change. Queries print the tracks they find:
+ * - \c box \c xmin,ymin,zmin,xmax,ymax,zmax : tracks crossing a box [cm]
+ * - \c sphere \c x,y,z,r : tracks crossing a sphere [cm]
+ * - \c ray \c x,y,z,dx,dy,dz[,tolerance] : first track passing within
+ *   \c tolerance (default 0.1 cm) of a ray
+ *
+ * Culling replaces the drawn tracks with the segments inside the clip box,
+ * drawn at full resolution as one segment set per species.
+ */
+class SegmentQuery
+{
+  public:
+    // Construct and add the query frame to the browser
+    explicit SegmentQuery(MCTruthViewerInterface& viewer);
+
+    // Detach from the query frame owned by the browser
+    ~SegmentQuery();
+
+    // Run a query and print its result
+    void run(std::string const& query);
+
+    // Only draw segments inside the clip box of the main viewer
+    void cull_to_clip_box();
+
+    // Only draw segments crossing a box
+    void cull(BoundingBox const& box);
+
+    // Draw all tracks again
+    void show_all();
+
+  private:
+    //// TYPES ////
+
+    class Frame;
+
+    //// DATA ////
+
+    MCTruthViewerInterface& viewer_;
+    Frame* frame_{nullptr};
+    std::unique_ptr<SegmentIndex> index_;
+    std::size_t index_revision_{0};  //!< Drawn events that are indexed
+    std::size_t culled_revision_{0};  //!< Drawn tracks that are culled
+    bool culled_{false};
+
+    //// HELPER FUNCTIONS ////
+
+    // Index of the drawn segments, built if needed; null while loading
+    SegmentIndex const* index();
+
+    // Whether culled segments are drawn instead of the tracks
+    bool culled() const;
+
+    // Draw sorted segments as runs of consecutive steps
+    void draw_segments(std::vector<SegmentIndex::Segment> const& segments);
+
+    // Print the tracks of a list of segments
+    void print_tracks(std::vector<SegmentIndex::Segment> const& segments);
+};
@@ -0,0 +1,329 @@
+//----------------------------------*-C++-*----------------------------------//
+// Copyright 2023 UT-Battelle, LLC, and other Celeritas developers.
+// See the top-level COPYRIGHT file for details.
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+//---------------------------------------------------------------------------//
+//! \file src/ShowerNavigator.cc
+//---------------------------------------------------------------------------//
+#include "ShowerNavigator.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <TEveBrowser.h>
+#include <TEveManager.h>
+#include <TGButton.h>
+#include <TGClient.h>
+#include <TGFrame.h>
+#include <TGLabel.h>
+#include <TGLayout.h>
+#include <TGNumberEntry.h>
+#include <WidgetMessageTypes.h>
+
+namespace
+{
+//---------------------------------------------------------------------------//
+using Clock = std::chrono::steady_clock;
+using Milliseconds = std::chrono::duration<double, std::milli>;
+//---------------------------------------------------------------------------//
+}  // namespace
+
+//---------------------------------------------------------------------------//
+/*!
+ * Track id entries and shower buttons, embedded in the browser.
+ */
+class ShowerNavigator::Frame final : public TGMainFrame
+{
+  public:
+    // Construct in the window currently being embedded
+    Frame(ShowerNavigator* navigator, int event_id);
+
+    //! Stop forwarding button clicks
+    void detach() { navigator_ = nullptr; }
+
+    // Handle buttons and number entries
+    Bool_t ProcessMessage(Longptr_t msg, Longptr_t parm1, Longptr_t) final;
+
+  private:
+    enum
+    {
+        descendants_id = 1,
+        ancestry_id,
+        collapse_id,
+        show_all_id
+    };
+
+    ShowerNavigator* navigator_;
+    TGNumberEntry* event_entry_;
+    TGNumberEntry* track_entry_;
+    TGNumberEntry* generation_entry_;
+
+    // Add a labeled number entry to a frame
+    TGNumberEntry* add_entry(TGCompositeFrame* parent,
+                             char const* label,
+                             int value,
+                             int id);
+};
+
+//---------------------------------------------------------------------------//
+/*!
+ * Construct and add the shower frame to the browser.
+ */
+ShowerNavigator::ShowerNavigator(MCTruthViewerInterface& viewer)
+    : viewer_(viewer)
+{
+    auto* browser = gEve->GetBrowser();
+    browser->StartEmbedding(TRootBrowser::kLeft);
+    frame_ = new Frame(this, std::max(viewer_.current_event(), 0));
+    browser->StopEmbedding("Showers");
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * The frame is owned by the browser and may outlive the navigator.
+ */
+ShowerNavigator::~ShowerNavigator()
+{
+    frame_->detach();
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Only show the descendants, or the ancestry, of a track of a drawn event.
+ *
+ * Returns false, leaving the drawn tracks unchanged, if the track is not
+ * drawn. With one line per track, hidden lines are only disabled, so that a
+ * single shower is isolated without rebuilding any track.
+ */
+bool ShowerNavigator::show_lineage(int event_id,
+                                   int track_id,
+                                   Lineage lineage)
+{
+    if (!this->index())
+    {
+        return false;
+    }
+
+    auto const& events = viewer_.drawn_events();
+    auto const iter = std::find_if(
+        events.begin(), events.end(), [event_id](EventData const& event) {
+            return event.id == event_id;
+        });
+    if (iter == events.end())
+    {
+        std::cout << "[WARNING] event id " << event_id << " is not drawn"
+                  << std::endl;
+        return false;
+    }
+    auto const e = iter - events.begin();
+    auto const& tree = trees_[e];
+    auto const track = tree.find(track_id);
+    if (track == TrackTree::none)
+    {
+        std::cout << "[WARNING] track id " << track_id
+                  << " is not drawn in event " << event_id << std::endl;
+        return false;
+    }
+
+    std::vector<std::vector<char>> visible(events.size());
+    for (std::size_t i = 0; i < events.size(); i++)
+    {
+        visible[i].assign(events[i].num_tracks(), 0);
+    }
+    auto const tracks = (lineage == Lineage::descendants)
+                            ? tree.descendants(track)
+                            : tree.ancestry(track);
+    for (auto i : tracks)
+    {
+        visible[e][i] = 1;
+    }
+    viewer_.set_visible(std::move(visible));
+    return true;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Hide tracks more than \c max_generation generations below their root.
+ *
+ * Zero only shows primaries, and tracks whose parent is not drawn.
+ */
+void ShowerNavigator::collapse(int max_generation)
+{
+    if (!this->index())
+    {
+        return;
+    }
+
+    std::vector<std::vector<char>> visible(trees_.size());
+    for (std::size_t e = 0; e < trees_.size(); e++)
+    {
+        auto const& tree = trees_[e];
+        visible[e].resize(tree.size());
+        for (TrackTree::size_type i = 0; i < tree.size(); i++)
+        {
+            visible[e][i] = (tree.generation(i) <= max_generation);
+        }
+    }
+    viewer_.set_visible(std::move(visible));
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Show all tracks of the drawn events again.
+ */
+void ShowerNavigator::show_all()
+{
+    if (this->index())
+    {
+        viewer_.set_visible(std::vector<std::vector<char>>(trees_.size()));
+    }
+}
+
+//---------------------------------------------------------------------------//
+// PRIVATE
+//---------------------------------------------------------------------------//
+
+//---------------------------------------------------------------------------//
+/*!
+ * Index the parent/child relations of each drawn event, if they changed
+ * since they were last indexed.
+ *
+ * Drawn tracks may only change once loading finishes: returns false, with a
+ * warning, while events are loading.
+ */
+bool ShowerNavigator::index()
+{
+    if (!viewer_.load_progress().done)
+    {
+        std::cout << "[WARNING] Showers can be navigated once loading "
+                     "finishes"
+                  << std::endl;
+        return false;
+    }
+    if (trees_revision_ != viewer_.events_revision())
+    {
+        auto const start = Clock::now();
+        auto const& events = viewer_.drawn_events();
+        trees_.clear();
+        trees_.reserve(events.size());
+        for (auto const& event : events)
+        {
+            trees_.emplace_back(event);
+        }
+        trees_revision_ = viewer_.events_revision();
+        std::cout << "Track ancestry: indexed " << trees_.size()
+                  << " events in " << Milliseconds(Clock::now() - start).count()
+                  << " ms" << std::endl;
+    }
+    return true;
+}
+
+//---------------------------------------------------------------------------//
+// FRAME
+//---------------------------------------------------------------------------//
+
+//---------------------------------------------------------------------------//
+/*!
+ * Construct in the window currently being embedded.
+ */
+ShowerNavigator::Frame::Frame(ShowerNavigator* navigator, int event_id)
+    : TGMainFrame(gClient->GetRoot(), 300, 100), navigator_(navigator)
+{
+    this->SetCleanup(kDeepCleanup);
+
+    // Track lineage
+    auto* track_group = new TGGroupFrame(this, "Track");
+    event_entry_ = this->add_entry(track_group, "Event id", event_id, 0);
+    track_entry_ = this->add_entry(track_group, "Track id", 1, 0);
+    auto* lineage_row = new TGHorizontalFrame(track_group);
+    auto* descendants
+        = new TGTextButton(lineage_row, "Descendants", descendants_id);
+    auto* ancestry = new TGTextButton(lineage_row, "Ancestry", ancestry_id);
+    descendants->Associate(this);
+    ancestry->Associate(this);
+    lineage_row->AddFrame(descendants,
+                          new TGLayoutHints(kLHintsExpandX, 0, 2));
+    lineage_row->AddFrame(ancestry, new TGLayoutHints(kLHintsExpandX, 2, 0));
+    track_group->AddFrame(lineage_row,
+                          new TGLayoutHints(kLHintsExpandX, 2, 2, 2, 4));
+    this->AddFrame(track_group, new TGLayoutHints(kLHintsExpandX, 4, 4, 4, 4));
+
+    // Shower depth
+    auto* depth_group = new TGGroupFrame(this, "Generations");
+    generation_entry_
+        = this->add_entry(depth_group, "Maximum", 1, collapse_id);
+    auto* depth_row = new TGHorizontalFrame(depth_group);
+    auto* collapse = new TGTextButton(depth_row, "Collapse", collapse_id);
+    auto* show_all = new TGTextButton(depth_row, "Show all", show_all_id);
+    collapse->Associate(this);
+    show_all->Associate(this);
+    depth_row->AddFrame(collapse, new TGLayoutHints(kLHintsExpandX, 0, 2));
+    depth_row->AddFrame(show_all, new TGLayoutHints(kLHintsExpandX, 2, 0));
+    depth_group->AddFrame(depth_row,
+                          new TGLayoutHints(kLHintsExpandX, 2, 2, 2, 4));
+    this->AddFrame(depth_group, new TGLayoutHints(kLHintsExpandX, 4, 4, 4, 4));
+
+    this->MapSubwindows();
+    this->Resize(this->GetDefaultSize());
+    this->MapWindow();
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Isolate a shower, collapse showers, or show all tracks.
+ */
+Bool_t ShowerNavigator::Frame::ProcessMessage(Longptr_t msg,
+                                              Longptr_t parm1,
+                                              Longptr_t)
+{
+    if (!navigator_)
+    {
+        return kTRUE;
+    }
+
+    using Lineage = ShowerNavigator::Lineage;
+    bool const clicked = (GET_MSG(msg) == kC_COMMAND
+                          && GET_SUBMSG(msg) == kCM_BUTTON);
+    bool const entered = (GET_MSG(msg) == kC_TEXTENTRY
+                          && GET_SUBMSG(msg) == kTE_ENTER);
+    if (clicked && (parm1 == descendants_id || parm1 == ancestry_id))
+    {
+        navigator_->show_lineage(event_entry_->GetIntNumber(),
+                                 track_entry_->GetIntNumber(),
+                                 parm1 == descendants_id ? Lineage::descendants
+                                                         : Lineage::ancestry);
+    }
+    else if ((clicked || entered) && parm1 == collapse_id)
+    {
+        navigator_->collapse(generation_entry_->GetIntNumber());
+    }
+    else if (clicked && parm1 == show_all_id)
+    {
+        navigator_->show_all();
+    }
+    return kTRUE;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Add a labeled non-negative integer entry to a frame.
+ */
+TGNumberEntry* ShowerNavigator::Frame::add_entry(TGCompositeFrame* parent,
+                                                 char const* label,
+                                                 int value,
+                                                 int id)
+{
+    auto* row = new TGHorizontalFrame(parent);
+    row->AddFrame(new TGLabel(row, label),
+                  new TGLayoutHints(kLHintsCenterY, 0, 4));
+    auto* result = new TGNumberEntry(row,
+                                     value,
+                                     8,
+                                     id,
+                                     TGNumberFormat::kNESInteger,
+                                     TGNumberFormat::kNEANonNegative);
+    result->Associate(this);
+    row->AddFrame(result, new TGLayoutHints(kLHintsExpandX | kLHintsRight));
+    parent->AddFrame(row, new TGLayoutHints(kLHintsExpandX, 2, 2, 4, 2));
+    return result;
+}
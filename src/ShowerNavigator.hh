@@ -0,0 +1,68 @@
+//----------------------------------*-C++-*----------------------------------//
+// Copyright 2023 UT-Battelle, LLC, and other Celeritas developers.
+// See the top-level COPYRIGHT file for details.
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+//---------------------------------------------------------------------------//
+//! \file src/ShowerNavigator.hh
+//---------------------------------------------------------------------------//
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "MCTruthViewerInterface.hh"
+#include "TrackTree.hh"
+
+//---------------------------------------------------------------------------//
+/*!
+ * Shower isolation and collapsing controls in a \c Showers tab of the
+ * browser.
+ *
+ * A track is given by its event and track ids, as they appear in track
+ * names. Its descendants or ancestry are shown, and all showers can be
+ * collapsed below a number of generations, by hiding the other tracks drawn
+ * by the viewer. The parent/child relations of the drawn events are indexed
+ * on first use once loading finishes, and again whenever they change.
+ */
+class ShowerNavigator
+{
+  public:
+    //! Tracks related to a given one
+    enum class Lineage
+    {
+        descendants,  //!< The track and all of its secondaries
+        ancestry  //!< The track and its parents, up to a primary
+    };
+
+    // Construct and add the shower frame to the browser
+    explicit ShowerNavigator(MCTruthViewerInterface& viewer);
+
+    // Detach from the shower frame owned by the browser
+    ~ShowerNavigator();
+
+    // Only show the descendants or the ancestry of a track
+    bool show_lineage(int event_id, int track_id, Lineage lineage);
+
+    // Hide tracks more than a given number of generations below their root
+    void collapse(int max_generation);
+
+    // Show all tracks again
+    void show_all();
+
+  private:
+    //// TYPES ////
+
+    class Frame;
+
+    //// DATA ////
+
+    MCTruthViewerInterface& viewer_;
+    Frame* frame_{nullptr};
+    std::vector<TrackTree> trees_;  //!< Ancestry of each drawn event
+    std::size_t trees_revision_{0};  //!< Drawn events that are indexed
+
+    //// HELPER FUNCTIONS ////
+
+    // Index the ancestry of the drawn events if needed; false while loading
+    bool index();
+};
@@ -0,0 +1,187 @@
+//----------------------------------*-C++-*----------------------------------//
+// Copyright 2023 UT-Battelle, LLC, and other Celeritas developers.
+// See the top-level COPYRIGHT file for details.
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+//---------------------------------------------------------------------------//
+//! \file src/TimeIndex.cc
+//---------------------------------------------------------------------------//
+#include "TimeIndex.hh"
+
+#include <algorithm>
+#include <cstring>
+#include <assert.h>
+
+#include "ParallelFor.hh"
+
+namespace
+{
+//---------------------------------------------------------------------------//
+// Bits of the segment position in a sort key
+constexpr int index_bits = 32;
+constexpr std::uint64_t index_mask = (std::uint64_t(1) << index_bits) - 1;
+
+//---------------------------------------------------------------------------//
+// Map a time to an unsigned integer with the same ordering
+std::uint32_t ordered_bits(double time)
+{
+    float const value = static_cast<float>(time);
+    std::uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return (bits & 0x80000000u) ? ~bits : bits | 0x80000000u;
+}
+
+//---------------------------------------------------------------------------//
+// Sort key of a segment at a given time
+std::uint64_t make_key(double time, std::size_t segment)
+{
+    return (std::uint64_t(ordered_bits(time)) << index_bits) | segment;
+}
+
+//---------------------------------------------------------------------------//
+// Sort keys of the entries with a time in [lower, upper]
+std::pair<std::vector<std::uint64_t>::const_iterator,
+          std::vector<std::uint64_t>::const_iterator>
+key_range(std::vector<std::uint64_t> const& keys, double lower, double upper)
+{
+    return {std::lower_bound(keys.begin(), keys.end(), make_key(lower, 0)),
+            std::upper_bound(
+                keys.begin(), keys.end(), make_key(upper, index_mask))};
+}
+
+//---------------------------------------------------------------------------//
+// Whether the time range of a segment overlaps a window
+bool overlaps(TimeIndex::Window segment, TimeIndex::Window window)
+{
+    return segment.begin <= window.end && segment.end >= window.begin;
+}
+
+//---------------------------------------------------------------------------//
+}  // namespace
+
+//---------------------------------------------------------------------------//
+/*!
+ * Build over all segments of the given events, which must have times.
+ *
+ * Segments are listed in parallel over events, and both sort orders are
+ * computed by sorting 64-bit keys holding the time in their upper half and
+ * the segment in their lower half.
+ */
+TimeIndex::TimeIndex(std::vector<EventData> const& events,
+                     unsigned int num_threads)
+    : events_(events)
+{
+    // Count segments of each event
+    std::vector<std::size_t> offsets(events.size() + 1, 0);
+    for (std::size_t e = 0; e < events.size(); e++)
+    {
+        auto const& event = events[e];
+        assert(event.times.size() == event.points.size());
+        std::size_t count = 0;
+        for (std::size_t t = 0; t < event.num_tracks(); t++)
+        {
+            auto const n = event.offsets[t + 1] - event.offsets[t];
+            count += n > 0 ? n - 1 : 0;
+        }
+        offsets[e + 1] = offsets[e] + count;
+    }
+    auto const size = offsets.back();
+    assert(size <= index_mask);
+    if (size == 0)
+    {
+        return;
+    }
+
+    // List segments and their keys in input order
+    segments_.resize(size);
+    by_start_.resize(size);
+    by_end_.resize(size);
+    parallel_for(events.size(),
+                 num_threads,
+                 [&](std::size_t e, unsigned int) {
+                     auto const& event = events[e];
+                     auto i = offsets[e];
+                     for (std::size_t t = 0; t < event.num_tracks(); t++)
+                     {
+                         auto const first = event.offsets[t];
+                         auto const last = event.offsets[t + 1];
+                         for (auto p = first + 1; p < last; p++, i++)
+                         {
+                             segments_[i] = {static_cast<std::uint32_t>(e), p};
+                             auto const w = this->times(segments_[i]);
+                             by_start_[i] = make_key(w.begin, i);
+                             by_end_[i] = make_key(w.end, i);
+                         }
+                     }
+                 });
+    parallel_sort(&by_start_, num_threads);
+    parallel_sort(&by_end_, num_threads);
+
+    auto segment = [this](std::uint64_t key) {
+        return segments_[key & index_mask];
+    };
+    range_.begin = this->times(segment(by_start_.front())).begin;
+    range_.end = this->times(segment(by_end_.back())).end;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Segments entering and leaving the window when it is moved.
+ *
+ * A segment can only appear or disappear if its start lies between the ends
+ * of the two windows, or its end between their beginnings: both sets are
+ * contiguous in one of the sort orders. Moving the window from an empty one
+ * lists all segments inside the new window.
+ */
+void TimeIndex::changes(Window from,
+                        Window to,
+                        std::vector<Segment>* shown,
+                        std::vector<Segment>* hidden) const
+{
+    shown->clear();
+    hidden->clear();
+    auto visit = [&](std::uint64_t key) {
+        auto const s = segments_[key & index_mask];
+        auto const t = this->times(s);
+        bool const before = overlaps(t, from);
+        bool const after = overlaps(t, to);
+        if (before != after)
+        {
+            (after ? shown : hidden)->push_back(s);
+        }
+    };
+
+    // Segments whose start crosses the end of the window
+    double const start_lower = std::min(from.end, to.end);
+    double const start_upper = std::max(from.end, to.end);
+    auto const starts = key_range(by_start_, start_lower, start_upper);
+    std::for_each(starts.first, starts.second, visit);
+
+    // Segments whose end crosses its beginning, unless already visited
+    auto const lower_bits = ordered_bits(start_lower);
+    auto const upper_bits = ordered_bits(start_upper);
+    auto const ends = key_range(by_end_,
+                                std::min(from.begin, to.begin),
+                                std::max(from.begin, to.begin));
+    std::for_each(ends.first, ends.second, [&](std::uint64_t key) {
+        auto const start = ordered_bits(
+            this->times(segments_[key & index_mask]).begin);
+        if (start < lower_bits || start > upper_bits)
+        {
+            visit(key);
+        }
+    });
+}
+
+//---------------------------------------------------------------------------//
+// PRIVATE
+//---------------------------------------------------------------------------//
+
+//---------------------------------------------------------------------------//
+/*!
+ * Start and end times of a segment [ns].
+ */
+auto TimeIndex::times(Segment s) const -> Window
+{
+    auto const* t = events_[s.event].times.data() + s.point - 1;
+    return {std::min(t[0], t[1]), std::max(t[0], t[1])};
+}
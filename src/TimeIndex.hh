@@ -0,0 +1,84 @@
+//----------------------------------*-C++-*----------------------------------//
+// Copyright 2023 UT-Battelle, LLC, and other Celeritas developers.
+// See the top-level COPYRIGHT file for details.
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+//---------------------------------------------------------------------------//
+//! \file src/TimeIndex.hh
+//---------------------------------------------------------------------------//
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "EventData.hh"
+#include "SegmentIndex.hh"
+
+//---------------------------------------------------------------------------//
+/*!
+ * Step segments of decoded events sorted by global time.
+ *
+ * A segment spans the times of its pre- and post-step points and is inside a
+ * time window if the two ranges overlap. Segments are sorted twice, by start
+ * and by end time, so that moving a window only visits the segments whose
+ * start crosses the end of the window, or whose end crosses its beginning:
+ * these are the only ones that can appear or disappear.
+ *
+ * The index refers to the times of the events it was built from, which must
+ * outlive it and must not be modified.
+ *
+ * \code
+ *  TimeIndex index(events, num_threads);
+ *  index.changes(previous, window, &shown, &hidden);
+ * \endcode
+ */
+class TimeIndex
+{
+  public:
+    //!@{
+    //! \name Type aliases
+    using Segment = SegmentIndex::Segment;
+    //!@}
+
+    //! Closed range of global times [ns]; empty by default
+    struct Window
+    {
+        double begin{std::numeric_limits<double>::infinity()};
+        double end{-std::numeric_limits<double>::infinity()};
+
+        //! Whether the window holds any time
+        explicit operator bool() const { return begin <= end; }
+    };
+
+    // Build over all segments of the given events
+    TimeIndex(std::vector<EventData> const& events, unsigned int num_threads);
+
+    // Segments entering and leaving the window when it is moved
+    void changes(Window from,
+                 Window to,
+                 std::vector<Segment>* shown,
+                 std::vector<Segment>* hidden) const;
+
+    //! Event of a segment
+    EventData const& event(Segment s) const { return events_[s.event]; }
+
+    //! Number of indexed segments
+    std::size_t num_segments() const { return segments_.size(); }
+
+    //! Earliest start and latest end of all segments; empty if none
+    Window range() const { return range_; }
+
+  private:
+    //// DATA ////
+
+    std::vector<EventData> const& events_;
+    std::vector<Segment> segments_;
+    std::vector<std::uint64_t> by_start_;  //!< Start time and segment
+    std::vector<std::uint64_t> by_end_;  //!< End time and segment
+    Window range_;
+
+    //// HELPER FUNCTIONS ////
+
+    // Start and end times of a segment
+    Window times(Segment s) const;
+};
@@ -0,0 +1,481 @@
+//----------------------------------*-C++-*----------------------------------//
+// Copyright 2023 UT-Battelle, LLC, and other Celeritas developers.
+// See the top-level COPYRIGHT file for details.
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+//---------------------------------------------------------------------------//
+//! \file src/TimeSlider.cc
+//---------------------------------------------------------------------------//
+#include "TimeSlider.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <TEveBrowser.h>
+#include <TEveManager.h>
+#include <TGButton.h>
+#include <TGClient.h>
+#include <TGFrame.h>
+#include <TGLabel.h>
+#include <TGLayout.h>
+#include <TGNumberEntry.h>
+#include <TGSlider.h>
+#include <WidgetMessageTypes.h>
+
+#include "Profiler.hh"
+
+namespace
+{
+//---------------------------------------------------------------------------//
+using Clock = std::chrono::steady_clock;
+using Seconds = std::chrono::duration<double>;
+
+//---------------------------------------------------------------------------//
+// Timer period while playing [ms]
+constexpr Long_t timer_period = 40;
+// Number of slider positions, and of timer ticks to sweep the time range
+constexpr int num_steps = 500;
+// Default window width, as a fraction of the time range
+constexpr double default_width = 0.05;
+//---------------------------------------------------------------------------//
+}  // namespace
+
+//---------------------------------------------------------------------------//
+/*!
+ * Slider, window entries and animation buttons, embedded in the browser.
+ */
+class TimeSlider::Frame final : public TGMainFrame
+{
+  public:
+    // Construct in the window currently being embedded
+    explicit Frame(TimeSlider* slider);
+
+    // Show the time range and the current window
+    void update(TimeIndex::Window range, double begin, double width);
+
+    //! Stop forwarding button clicks
+    void detach() { slider_ = nullptr; }
+
+    // Handle slider, entries and buttons
+    Bool_t
+    ProcessMessage(Longptr_t msg, Longptr_t parm1, Longptr_t parm2) final;
+
+  private:
+    enum
+    {
+        slider_id = 1,
+        window_id,
+        play_id,
+        pause_id,
+        show_all_id
+    };
+
+    TimeSlider* slider_;
+    TGLabel* label_;
+    TGHSlider* position_;
+    TGNumberEntry* begin_entry_;
+    TGNumberEntry* width_entry_;
+};
+
+//---------------------------------------------------------------------------//
+/*!
+ * Construct and add the slider frame to the browser.
+ */
+TimeSlider::TimeSlider(MCTruthViewerInterface& viewer)
+    : TTimer(timer_period), viewer_(viewer)
+{
+    auto* browser = gEve->GetBrowser();
+    browser->StartEmbedding(TRootBrowser::kLeft);
+    frame_ = new Frame(this);
+    browser->StopEmbedding("Time");
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * The frame is owned by the browser and may outlive the slider.
+ */
+TimeSlider::~TimeSlider()
+{
+    frame_->detach();
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Advance the window by a fixed fraction of the time range.
+ *
+ * Once the window has left the range, it starts over just before it.
+ */
+Bool_t TimeSlider::Notify()
+{
+    if (!index_ || !viewer_.load_progress().done
+        || index_revision_ != viewer_.events_revision())
+    {
+        // Drawn events changed: stop until the window is moved again
+        this->TurnOff();
+        return kTRUE;
+    }
+    auto const range = index_->range();
+    double begin = begin_ + (range.end - range.begin) / num_steps;
+    if (begin > range.end)
+    {
+        begin = range.begin - width_;
+    }
+    this->show(begin, width_);
+    this->Reset();
+    return kTRUE;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Only draw segments inside the window [begin, begin + width] [ns].
+ */
+void TimeSlider::show(double begin, double width)
+{
+    if (!this->indexed())
+    {
+        return;
+    }
+    begin_ = begin;
+    width_ = width;
+    TimeIndex::Window window;
+    window.begin = begin_;
+    window.end = begin_ + width_;
+    this->show_window(window);
+    frame_->update(index_->range(), begin_, width_);
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Move the window to a fraction of the time range.
+ *
+ * A zero width is replaced by a small fraction of the range.
+ */
+void TimeSlider::seek(double fraction, double width)
+{
+    if (!this->indexed())
+    {
+        return;
+    }
+    auto const range = index_->range();
+    if (width <= 0)
+    {
+        width = default_width * (range.end - range.begin);
+    }
+    this->show(range.begin + fraction * (range.end - range.begin), width);
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Start or stop moving the window.
+ */
+void TimeSlider::play(bool value)
+{
+    if (!value)
+    {
+        this->TurnOff();
+        return;
+    }
+    if (this->indexed())
+    {
+        if (width_ <= 0)
+        {
+            this->seek(0, 0);
+        }
+        this->TurnOn();
+    }
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Stop playing and draw whole tracks again, if a window is drawn.
+ */
+void TimeSlider::show_all()
+{
+    this->TurnOff();
+    if (this->drawn())
+    {
+        viewer_.redraw();
+        lines_.clear();
+        sets_.clear();
+        gEve->Redraw3D();
+    }
+}
+
+//---------------------------------------------------------------------------//
+// PRIVATE
+//---------------------------------------------------------------------------//
+
+//---------------------------------------------------------------------------//
+/*!
+ * Sort the segments of the drawn events by time on \c num_threads() threads,
+ * if they changed since they were last sorted.
+ *
+ * Returns false, with a warning, while events are loading.
+ */
+bool TimeSlider::indexed()
+{
+    if (!viewer_.load_progress().done)
+    {
+        std::cout << "[WARNING] Segments are sorted by time once loading "
+                     "finishes"
+                  << std::endl;
+        return false;
+    }
+    if (!index_ || index_revision_ != viewer_.events_revision())
+    {
+        auto const start = Clock::now();
+        index_ = std::make_unique<TimeIndex>(viewer_.drawn_events(),
+                                             viewer_.num_threads());
+        index_revision_ = viewer_.events_revision();
+        auto const range = index_->range();
+        std::cout << "Time index: " << index_->num_segments()
+                  << " segments from " << range.begin << " to " << range.end
+                  << " ns, built in " << Seconds(Clock::now() - start).count()
+                  << " s" << std::endl;
+    }
+    return true;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Whether the time sets are still drawn, i.e. the viewer did not destroy
+ * them to draw its tracks again.
+ */
+bool TimeSlider::drawn() const
+{
+    return !lines_.empty() && sets_revision_ == viewer_.tracks_revision();
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Draw all segments of the drawn events as one set per species, with every
+ * line hidden, and record the first line of each track.
+ *
+ * Tracks are drawn at full resolution whatever the track display, detail
+ * level and visible tracks.
+ */
+void TimeSlider::draw_sets()
+{
+    viewer_.destroy_tracks();
+    auto const& events = viewer_.drawn_events();
+    std::map<int, TrackSegmentSet*> sets;
+    lines_.assign(events.size(), {});
+    for (std::size_t e = 0; e < events.size(); e++)
+    {
+        auto const& event = events[e];
+        auto& lines = lines_[e];
+        lines.resize(event.num_tracks());
+        for (std::size_t i = 0; i < event.num_tracks(); i++)
+        {
+            auto const track = event.track(i);
+            auto const pdg = MCTruthViewerInterface::species(track.pdg);
+            auto& set = sets[pdg];
+            if (!set)
+            {
+                set = viewer_.add_segment_set(
+                    pdg, viewer_.species_name(track.pdg) + " (time)");
+            }
+            lines[i] = {set,
+                        set->add_track(viewer_.track_name(event.id, track),
+                                       track.points,
+                                       track.num_points,
+                                       false)};
+            Profiler::add(Profiler::Counter::points_created,
+                          track.num_points);
+        }
+    }
+
+    // Bound all lines before hiding them
+    sets_.clear();
+    for (auto const& id_set : sets)
+    {
+        auto* set = id_set.second;
+        set->ComputeBBox();
+        for (std::size_t i = 0; i < set->num_segments(); i++)
+        {
+            set->hide_line(i);
+        }
+        set->StampObjProps();
+        sets_.push_back(set);
+    }
+    sets_revision_ = viewer_.tracks_revision();
+    window_ = {};
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Only draw the segments overlapping a time window [ns].
+ *
+ * On the first call, all segments of the drawn events are drawn at full
+ * resolution, as one hidden segment set per species. Moving the window then
+ * only shows or hides the segments that enter or leave it, so that the cost
+ * of each move is proportional to the number of changed segments.
+ */
+void TimeSlider::show_window(TimeIndex::Window window)
+{
+    if (!this->drawn())
+    {
+        this->draw_sets();
+    }
+
+    std::vector<TimeIndex::Segment> shown;
+    std::vector<TimeIndex::Segment> hidden;
+    index_->changes(window_, window, &shown, &hidden);
+
+    // Set and line of a segment
+    auto line = [this](TimeIndex::Segment s) {
+        auto const& offsets = index_->event(s).offsets;
+        auto const track = std::upper_bound(offsets.begin(),
+                                            offsets.end(),
+                                            s.point)
+                           - offsets.begin() - 1;
+        auto const& first = lines_[s.event][track];
+        return std::make_pair(
+            first.first, first.second + int(s.point - offsets[track]) - 1);
+    };
+    for (auto s : hidden)
+    {
+        auto const set_line = line(s);
+        set_line.first->hide_line(set_line.second);
+    }
+    for (auto s : shown)
+    {
+        auto const set_line = line(s);
+        set_line.first->show_line(set_line.second,
+                                  index_->event(s).points[s.point]);
+    }
+    if (!shown.empty() || !hidden.empty())
+    {
+        for (auto* set : sets_)
+        {
+            set->StampObjProps();
+        }
+        gEve->Redraw3D();
+    }
+    window_ = window;
+}
+
+//---------------------------------------------------------------------------//
+// FRAME
+//---------------------------------------------------------------------------//
+
+//---------------------------------------------------------------------------//
+/*!
+ * Construct in the window currently being embedded.
+ */
+TimeSlider::Frame::Frame(TimeSlider* slider)
+    : TGMainFrame(gClient->GetRoot(), 300, 100), slider_(slider)
+{
+    this->SetCleanup(kDeepCleanup);
+
+    // Window position
+    auto* group = new TGGroupFrame(this, "Time window [ns]");
+    label_ = new TGLabel(group, "Segments are sorted once loaded");
+    group->AddFrame(label_, new TGLayoutHints(kLHintsExpandX, 2, 2, 4, 2));
+    position_ = new TGHSlider(group, 200, kSlider1 | kScaleNo, slider_id);
+    position_->SetRange(0, num_steps);
+    position_->Associate(this);
+    group->AddFrame(position_, new TGLayoutHints(kLHintsExpandX, 2, 2, 2, 2));
+
+    // Window start and width
+    auto* entry_row = new TGHorizontalFrame(group);
+    begin_entry_ = new TGNumberEntry(entry_row,
+                                     0,
+                                     10,
+                                     window_id,
+                                     TGNumberFormat::kNESReal,
+                                     TGNumberFormat::kNEAAnyNumber);
+    width_entry_ = new TGNumberEntry(entry_row,
+                                     0,
+                                     10,
+                                     window_id,
+                                     TGNumberFormat::kNESReal,
+                                     TGNumberFormat::kNEANonNegative);
+    begin_entry_->Associate(this);
+    width_entry_->Associate(this);
+    entry_row->AddFrame(new TGLabel(entry_row, "Begin"),
+                        new TGLayoutHints(kLHintsCenterY, 0, 4));
+    entry_row->AddFrame(begin_entry_, new TGLayoutHints(kLHintsExpandX, 0, 4));
+    entry_row->AddFrame(new TGLabel(entry_row, "Width"),
+                        new TGLayoutHints(kLHintsCenterY, 0, 4));
+    entry_row->AddFrame(width_entry_, new TGLayoutHints(kLHintsExpandX));
+    group->AddFrame(entry_row, new TGLayoutHints(kLHintsExpandX, 2, 2, 2, 2));
+
+    // Animation
+    auto* button_row = new TGHorizontalFrame(group);
+    auto* play = new TGTextButton(button_row, "Play", play_id);
+    auto* pause = new TGTextButton(button_row, "Pause", pause_id);
+    auto* show_all = new TGTextButton(button_row, "Show all", show_all_id);
+    for (auto* button : {play, pause, show_all})
+    {
+        button->Associate(this);
+        button_row->AddFrame(button, new TGLayoutHints(kLHintsExpandX, 1, 1));
+    }
+    group->AddFrame(button_row,
+                    new TGLayoutHints(kLHintsExpandX, 2, 2, 2, 4));
+
+    this->AddFrame(group, new TGLayoutHints(kLHintsExpandX, 4, 4, 4, 4));
+    this->MapSubwindows();
+    this->Resize(this->GetDefaultSize());
+    this->MapWindow();
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Show the time range and the current window.
+ */
+void TimeSlider::Frame::update(TimeIndex::Window range,
+                               double begin,
+                               double width)
+{
+    std::ostringstream os;
+    os << "Range " << range.begin << " to " << range.end;
+    label_->SetText(os.str().c_str());
+
+    double const span = range.end - range.begin;
+    double const fraction = span > 0 ? (begin - range.begin) / span : 0;
+    position_->SetPosition(static_cast<int>(
+        std::min(std::max(fraction, 0.0), 1.0) * num_steps + 0.5));
+    begin_entry_->SetNumber(begin);
+    width_entry_->SetNumber(width);
+    this->Layout();
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Move the window with the slider or entries, or control the animation.
+ */
+Bool_t TimeSlider::Frame::ProcessMessage(Longptr_t msg,
+                                         Longptr_t parm1,
+                                         Longptr_t parm2)
+{
+    if (!slider_)
+    {
+        return kTRUE;
+    }
+
+    bool const clicked = (GET_MSG(msg) == kC_COMMAND
+                          && GET_SUBMSG(msg) == kCM_BUTTON);
+    bool const entered = (GET_MSG(msg) == kC_TEXTENTRY
+                          && GET_SUBMSG(msg) == kTE_ENTER);
+    bool const moved = (GET_MSG(msg) == kC_HSLIDER
+                        && GET_SUBMSG(msg) == kSL_POS);
+    if (moved && parm1 == slider_id)
+    {
+        slider_->seek(double(parm2) / num_steps, width_entry_->GetNumber());
+    }
+    else if (entered && parm1 == window_id)
+    {
+        slider_->show(begin_entry_->GetNumber(), width_entry_->GetNumber());
+    }
+    else if (clicked && (parm1 == play_id || parm1 == pause_id))
+    {
+        slider_->play(parm1 == play_id);
+    }
+    else if (clicked && parm1 == show_all_id)
+    {
+        slider_->show_all();
+    }
+    return kTRUE;
+}
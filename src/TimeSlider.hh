@@ -0,0 +1,90 @@
+//----------------------------------*-C++-*----------------------------------//
+// Copyright 2023 UT-Battelle, LLC, and other Celeritas developers.
+// See the top-level COPYRIGHT file for details.
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+//---------------------------------------------------------------------------//
+//! \file src/TimeSlider.hh
+//---------------------------------------------------------------------------//
+#pragma once
+
+#include <memory>
+#include <utility>
+#include <vector>
+#include <TTimer.h>
+
+#include "MCTruthViewerInterface.hh"
+#include "TimeIndex.hh"
+#include "TrackSegmentSet.hh"
+
+//---------------------------------------------------------------------------//
+/*!
+ * Time window slider and animation in a \c Time tab of the browser.
+ *
+ * The slider moves the beginning of a window of fixed width [ns] across the
+ * times of all drawn segments, and only the segments inside the window are
+ * drawn. When playing, the window is advanced on every timer tick and starts
+ * over once it has left the time range.
+ *
+ * The segments of the events drawn by the viewer are sorted by time on first
+ * use once loading finishes, and again whenever the drawn events change. The
+ * window replaces the drawn tracks with one hidden segment set per species,
+ * whose lines are shown or hidden as the window moves.
+ */
+class TimeSlider : public TTimer
+{
+  public:
+    // Construct and add the slider frame to the browser
+    explicit TimeSlider(MCTruthViewerInterface& viewer);
+
+    // Detach from the slider frame owned by the browser
+    ~TimeSlider();
+
+    // Advance the window while playing
+    Bool_t Notify() final;
+
+    // Only draw segments inside a window [ns]
+    void show(double begin, double width);
+
+    // Move the window to a fraction of the time range
+    void seek(double fraction, double width);
+
+    // Start or stop moving the window
+    void play(bool value);
+
+    // Draw whole tracks again
+    void show_all();
+
+  private:
+    //// TYPES ////
+
+    class Frame;
+
+    //// DATA ////
+
+    MCTruthViewerInterface& viewer_;
+    Frame* frame_{nullptr};
+    double begin_{0};  //!< Current window [ns]
+    double width_{0};
+
+    std::unique_ptr<TimeIndex> index_;
+    std::size_t index_revision_{0};  //!< Drawn events that are sorted
+    //! Segment set and first line of each track drawn in the time window
+    std::vector<std::vector<std::pair<TrackSegmentSet*, int>>> lines_;
+    std::vector<TrackSegmentSet*> sets_;
+    std::size_t sets_revision_{0};  //!< Drawn tracks replaced by the sets
+    TimeIndex::Window window_;  //!< Drawn time window
+
+    //// HELPER FUNCTIONS ////
+
+    // Sort the drawn segments by time if needed; false while loading
+    bool indexed();
+
+    // Whether the time sets are still drawn
+    bool drawn() const;
+
+    // Draw all segments of the drawn events as hidden lines
+    void draw_sets();
+
+    // Only draw segments inside a time window [ns]
+    void show_window(TimeIndex::Window window);
+};
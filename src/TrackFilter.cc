@@ -0,0 +1,205 @@
+//----------------------------------*-C++-*----------------------------------//
+// Copyright 2023 UT-Battelle, LLC, and other Celeritas developers.
+// See the top-level COPYRIGHT file for details.
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+//---------------------------------------------------------------------------//
+//! \file src/TrackFilter.cc
+//---------------------------------------------------------------------------//
+#include "TrackFilter.hh"
+
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+#include <stdlib.h>
+
+//---------------------------------------------------------------------------//
+/*!
+ * Set event range from a \c first:last:stride string.
+ *
+ * Selected events are \c first, \c first+stride , ... up to but excluding
+ * \c last . Omitted parts keep their defaults, e.g. \c :100 or \c ::10 .
+ */
+void TrackFilter::set_event_range(std::string const& range)
+{
+    std::vector<std::string> parts;
+    std::stringstream ss(range);
+    for (std::string part; std::getline(ss, part, ':');)
+    {
+        parts.push_back(part);
+    }
+
+    if (parts.empty() || parts.size() > 3)
+    {
+        std::cout << "[ERROR] Invalid event range " << range
+                  << ". Expected first:last:stride" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    if (!parts[0].empty())
+    {
+        event_first = std::stoi(parts[0]);
+    }
+    if (parts.size() > 1 && !parts[1].empty())
+    {
+        event_last = std::stoi(parts[1]);
+    }
+    if (parts.size() > 2 && !parts[2].empty())
+    {
+        event_stride = std::stoi(parts[2]);
+    }
+
+    if (event_stride < 1)
+    {
+        std::cout << "[ERROR] Event range stride must be positive"
+                  << std::endl;
+        exit(EXIT_FAILURE);
+    }
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Whether an event id is within the selected range.
+ */
+bool TrackFilter::pass_event(int event_id) const
+{
+    return event_id >= event_first && event_id < event_last
+           && (event_id - event_first) % event_stride == 0;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Whether a track passes all track-level selections.
+ */
+bool TrackFilter::pass_track(int pdg,
+                             double vertex_energy,
+                             double length,
+                             bool is_primary) const
+{
+    if (!pdg_allow.empty()
+        && std::find(pdg_allow.begin(), pdg_allow.end(), pdg)
+               == pdg_allow.end())
+    {
+        return false;
+    }
+    if (std::find(pdg_deny.begin(), pdg_deny.end(), pdg) != pdg_deny.end())
+    {
+        return false;
+    }
+    return vertex_energy >= min_vertex_energy && length >= min_length
+           && (is_primary || !primaries_only);
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Whether any track-level selection is set.
+ */
+bool TrackFilter::has_track_cuts() const
+{
+    return !pdg_allow.empty() || !pdg_deny.empty() || min_vertex_energy > 0
+           || min_length > 0 || primaries_only;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Remove the decoded tracks that fail the track expression, along with their
+ * points and per-point data. Tracks keep their order.
+ */
+void TrackFilter::select_tracks(EventData* event) const
+{
+    if (!track_select)
+    {
+        return;
+    }
+
+    auto const num_tracks = event->num_tracks();
+    std::vector<char> keep(num_tracks);
+    for (std::size_t t = 0; t < num_tracks; t++)
+    {
+        keep[t] = track_select.pass_track(*event, t);
+    }
+    if (std::all_of(keep.begin(), keep.end(), [](char k) { return k; }))
+    {
+        return;
+    }
+
+    // Move the points of kept tracks to the front of each per-point array
+    auto const& offsets = event->offsets;
+    auto compact_points = [&keep, &offsets, num_tracks](auto* values) {
+        if (values->empty())
+        {
+            return;
+        }
+        std::size_t size = 0;
+        for (std::size_t t = 0; t < num_tracks; t++)
+        {
+            for (auto p = offsets[t]; keep[t] && p < offsets[t + 1]; p++)
+            {
+                (*values)[size++] = (*values)[p];
+            }
+        }
+        values->resize(size);
+    };
+    compact_points(&event->points);
+    compact_points(&event->interaction);
+    compact_points(&event->energy_deposits);
+    compact_points(&event->times);
+    compact_points(&event->significance);
+
+    // Keep the attributes of kept tracks
+    auto compact_tracks = [&keep, num_tracks](auto* values) {
+        if (values->empty())
+        {
+            return;
+        }
+        std::size_t size = 0;
+        for (std::size_t t = 0; t < num_tracks; t++)
+        {
+            if (keep[t])
+            {
+                (*values)[size++] = (*values)[t];
+            }
+        }
+        values->resize(size);
+    };
+    compact_tracks(&event->track_ids);
+    compact_tracks(&event->pdgs);
+    compact_tracks(&event->parent_ids);
+    compact_tracks(&event->vertex_energies);
+    compact_tracks(&event->lengths);
+
+    std::vector<std::uint32_t> kept_offsets{0};
+    for (std::size_t t = 0; t < num_tracks; t++)
+    {
+        if (keep[t])
+        {
+            kept_offsets.push_back(kept_offsets.back() + offsets[t + 1]
+                                   - offsets[t]);
+        }
+    }
+    event->offsets = std::move(kept_offsets);
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Whether a decoded quantity is used by either expression, and must thus be
+ * decoded.
+ */
+bool TrackFilter::uses(Expression::Variable variable) const
+{
+    return track_select.uses(variable) || event_select.uses(variable);
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Parse a comma-separated list of PDG codes, e.g. \c 11,-11,22 .
+ */
+std::vector<int> parse_pdg_list(std::string const& list)
+{
+    std::vector<int> result;
+    std::stringstream ss(list);
+    for (std::string pdg; std::getline(ss, pdg, ',');)
+    {
+        result.push_back(std::stoi(pdg));
+    }
+    return result;
+}
@@ -0,0 +1,88 @@
+//----------------------------------*-C++-*----------------------------------//
+// Copyright 2023 UT-Battelle, LLC, and other Celeritas developers.
+// See the top-level COPYRIGHT file for details.
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+//---------------------------------------------------------------------------//
+//! \file src/TrackFilter.hh
+//---------------------------------------------------------------------------//
+#pragma once
+
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "EventData.hh"
+#include "Expression.hh"
+
+//---------------------------------------------------------------------------//
+/*!
+ * Event and track selection evaluated while reading the input.
+ *
+ * Readers evaluate \c pass_event before decoding an event, and
+ * \c pass_track using track-level quantities only, before any step data is
+ * decoded. Selection expressions are evaluated on decoded events instead,
+ * before their tracks are drawn: \c select_tracks removes the tracks failing
+ * \c track_select , and only events passing \c event_select are selected.
+ * Default-constructed filters accept everything.
+ *
+ * \code
+ *  TrackFilter filter;
+ *  filter.set_event_range("5:100:5");
+ *  filter.pdg_allow = {13, -13};
+ *  filter.min_vertex_energy = 1000;  // MeV
+ * \endcode
+ */
+struct TrackFilter
+{
+    //!@{
+    //! \name Event selection
+    int event_first{0};
+    int event_last{std::numeric_limits<int>::max()};  //!< Exclusive
+    int event_stride{1};
+    //!@}
+
+    //!@{
+    //! \name Track selection
+    std::vector<int> pdg_allow;  //!< If not empty, only these PDGs pass
+    std::vector<int> pdg_deny;  //!< These PDGs never pass
+    double min_vertex_energy{0};  //!< [MeV]
+    double min_length{0};  //!< [cm]
+    bool primaries_only{false};
+    //!@}
+
+    //!@{
+    //! \name Expression selection of decoded events
+    Expression track_select;  //!< If set, only passing tracks are kept
+    Expression event_select;  //!< If set, only passing events are selected
+    //!@}
+
+    // Set event range from "first:last:stride"; each part is optional
+    void set_event_range(std::string const& range);
+
+    // Whether an event id is selected
+    bool pass_event(int event_id) const;
+
+    // Whether a track is selected
+    bool pass_track(int pdg,
+                    double vertex_energy,
+                    double length,
+                    bool is_primary) const;
+
+    // Whether any track-level selection is set
+    bool has_track_cuts() const;
+
+    // Remove the decoded tracks that fail the track expression
+    void select_tracks(EventData* event) const;
+
+    // Whether a decoded quantity is used by either expression
+    bool uses(Expression::Variable variable) const;
+
+    //! Whether the vertex energy is needed
+    bool needs_energy() const { return min_vertex_energy > 0; }
+
+    //! Whether the track length is needed
+    bool needs_length() const { return min_length > 0; }
+};
+
+// Parse a comma-separated list of PDG codes
+std::vector<int> parse_pdg_list(std::string const& list);
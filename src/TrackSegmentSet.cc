@@ -0,0 +1,124 @@
+//----------------------------------*-C++-*----------------------------------//
+// Copyright 2023 UT-Battelle, LLC, and other Celeritas developers.
+// See the top-level COPYRIGHT file for details.
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+//---------------------------------------------------------------------------//
+//! \file src/TrackSegmentSet.cc
+//---------------------------------------------------------------------------//
+#include "TrackSegmentSet.hh"
+
+#include <algorithm>
+#include <iostream>
+#include <TGLSelectRecord.h>
+#include <assert.h>
+
+//---------------------------------------------------------------------------//
+/*!
+ * Construct with element name and enable picking of single segments.
+ *
+ * Lines and markers are allocated in large chunks: the default chunks of a
+ * few elements would cost one allocation every few segments.
+ */
+TrackSegmentSet::TrackSegmentSet(char const* name, char const* title)
+    : TEveStraightLineSet(name, title)
+{
+    this->SetAlwaysSecSelect(kTRUE);
+    fLinePlex.Reset(sizeof(Line_t), chunk_size);
+    fMarkerPlex.Reset(sizeof(Marker_t), chunk_size);
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Add a track polyline as consecutive segments.
+ *
+ * If \c step_points is true, a marker is added at every point. Returns the
+ * id of the first line of the track; the following segments have consecutive
+ * ids.
+ */
+int TrackSegmentSet::add_track(std::string name,
+                               Point const* points,
+                               std::size_t num_points,
+                               bool step_points)
+{
+    int const result = num_lines_;
+    if (num_points < 2)
+    {
+        return result;
+    }
+
+    track_names_.push_back(std::move(name));
+    track_first_line_.push_back(num_lines_);
+
+    for (std::size_t i = 1; i < num_points; i++)
+    {
+        auto const& a = points[i - 1];
+        auto const& b = points[i];
+        this->AddLine(a[0], a[1], a[2], b[0], b[1], b[2]);
+        if (step_points)
+        {
+            if (i == 1)
+            {
+                this->AddMarker(num_lines_, 0);
+            }
+            this->AddMarker(num_lines_, 1);
+        }
+        num_lines_++;
+    }
+    return result;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Collapse a line onto its first point so that it is not drawn.
+ *
+ * The set must be stamped with \c StampObjProps once all lines are changed.
+ */
+void TrackSegmentSet::hide_line(int line_id)
+{
+    assert(line_id >= 0 && line_id < num_lines_);
+    auto* line = reinterpret_cast<Line_t*>(fLinePlex.Atom(line_id));
+    std::copy(line->fV1, line->fV1 + 3, line->fV2);
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Restore the end point of a hidden line.
+ */
+void TrackSegmentSet::show_line(int line_id, Point const& end)
+{
+    assert(line_id >= 0 && line_id < num_lines_);
+    auto* line = reinterpret_cast<Line_t*>(fLinePlex.Atom(line_id));
+    std::copy(end.begin(), end.end(), line->fV2);
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Name of the track that owns a given line.
+ */
+std::string const& TrackSegmentSet::track_name(int line_id) const
+{
+    assert(line_id >= 0 && line_id < num_lines_);
+    auto iter = std::upper_bound(
+        track_first_line_.begin(), track_first_line_.end(), line_id);
+    return track_names_[iter - track_first_line_.begin() - 1];
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Print the name of the picked track.
+ *
+ * Line selection records contain the item \c 1 followed by the line id.
+ */
+void TrackSegmentSetGL::ProcessSelection(TGLRnrCtx& rnrCtx,
+                                         TGLSelectRecord& rec)
+{
+    if (rec.GetN() != 3 || rec.GetItem(1) != 1)
+    {
+        TEveStraightLineSetGL::ProcessSelection(rnrCtx, rec);
+        return;
+    }
+
+    auto const* segments = static_cast<TrackSegmentSet const*>(fM);
+    std::cout << "Selected track " << segments->track_name(rec.GetItem(2))
+              << std::endl;
+}
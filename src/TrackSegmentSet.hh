@@ -0,0 +1,78 @@
+//----------------------------------*-C++-*----------------------------------//
+// Copyright 2023 UT-Battelle, LLC, and other Celeritas developers.
+// See the top-level COPYRIGHT file for details.
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+//---------------------------------------------------------------------------//
+//! \file src/TrackSegmentSet.hh
+//! \brief Batched track segments sharing a single Eve element.
+//---------------------------------------------------------------------------//
+#pragma once
+
+#include <string>
+#include <vector>
+#include <TEveStraightLineSet.h>
+#include <TEveStraightLineSetGL.h>
+
+#include "EventData.hh"
+
+//---------------------------------------------------------------------------//
+/*!
+ * Straight line set holding every segment of many tracks.
+ *
+ * A single Eve element (and a single draw call) replaces one \c TEveLine per
+ * track. Each segment remembers the track it came from, so that picking a
+ * segment in the viewer reports the track name. Single segments can be
+ * hidden by collapsing them onto their first point, which is cheaper than
+ * rebuilding the set when only a few of them change.
+ */
+class TrackSegmentSet : public TEveStraightLineSet
+{
+  public:
+    // Construct with element name
+    TrackSegmentSet(char const* name = "TrackSegmentSet",
+                    char const* title = "");
+
+    // Add a track polyline as consecutive segments; returns the first line
+    int add_track(std::string name,
+                  Point const* points,
+                  std::size_t num_points,
+                  bool step_points);
+
+    // Collapse a line onto its first point so that it is not drawn
+    void hide_line(int line_id);
+
+    // Restore the end point of a hidden line
+    void show_line(int line_id, Point const& end);
+
+    // Name of the track that owns a given line
+    std::string const& track_name(int line_id) const;
+
+    //! Number of tracks in the set
+    std::size_t num_tracks() const { return track_names_.size(); }
+
+    //! Number of segments in the set
+    std::size_t num_segments() const { return num_lines_; }
+
+  private:
+    //! Number of lines or markers per allocation
+    static constexpr int chunk_size = 4096;
+
+    std::vector<std::string> track_names_;  //!
+    std::vector<int> track_first_line_;  //!
+    int num_lines_{0};  //!
+
+    ClassDefOverride(TrackSegmentSet, 0);
+};
+
+//---------------------------------------------------------------------------//
+/*!
+ * GL renderer of \c TrackSegmentSet , reporting picked tracks.
+ */
+class TrackSegmentSetGL : public TEveStraightLineSetGL
+{
+  public:
+    // Report name of picked track
+    void ProcessSelection(TGLRnrCtx& rnrCtx, TGLSelectRecord& rec) override;
+
+    ClassDefOverride(TrackSegmentSetGL, 0);
+};
@@ -0,0 +1,166 @@
+//----------------------------------*-C++-*----------------------------------//
+// Copyright 2023 UT-Battelle, LLC, and other Celeritas developers.
+// See the top-level COPYRIGHT file for details.
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+//---------------------------------------------------------------------------//
+//! \file src/TrackSimplifier.cc
+//---------------------------------------------------------------------------//
+#include "TrackSimplifier.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <tuple>
+#include <assert.h>
+
+namespace
+{
+//---------------------------------------------------------------------------//
+/*!
+ * Distance between point \c p and the segment [a, b].
+ */
+double distance_to_segment(Point const& p, Point const& a, Point const& b)
+{
+    double ab[3], ap[3];
+    double ab2{0}, ab_ap{0};
+    for (int i = 0; i < 3; i++)
+    {
+        ab[i] = b[i] - a[i];
+        ap[i] = p[i] - a[i];
+        ab2 += ab[i] * ab[i];
+        ab_ap += ab[i] * ap[i];
+    }
+
+    double const t = (ab2 > 0) ? std::min(1.0, std::max(0.0, ab_ap / ab2)) : 0;
+    double dist2{0};
+    for (int i = 0; i < 3; i++)
+    {
+        double const d = ap[i] - t * ab[i];
+        dist2 += d * d;
+    }
+    return std::sqrt(dist2);
+}
+
+//---------------------------------------------------------------------------//
+}  // namespace
+
+//---------------------------------------------------------------------------//
+/*!
+ * Construct with the coarsest tolerance [cm] and the number of levels.
+ */
+TrackSimplifier::TrackSimplifier(double tolerance, int num_levels)
+    : tolerance_(tolerance), num_levels_(num_levels)
+{
+    assert(tolerance_ > 0);
+    assert(num_levels_ > 1);
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Compute the significance of every point of an event.
+ *
+ * Each track is simplified independently. Polylines are split at endpoints
+ * and interaction points, which have an infinite significance. Each remaining
+ * piece is recursively split at its farthest point. A point's significance is
+ * capped by that of the split that created its piece, so that the points kept
+ * at a tolerance are always a subset of those kept at any smaller tolerance.
+ */
+void TrackSimplifier::operator()(EventData* event) const
+{
+    assert(event);
+    auto const& points = event->points;
+    auto const& interaction = event->interaction;
+    auto& significance = event->significance;
+    auto const inf = std::numeric_limits<float>::infinity();
+    assert(interaction.empty() || interaction.size() == points.size());
+
+    significance.assign(points.size(), 0);
+    for (std::size_t i = 0; i < interaction.size(); i++)
+    {
+        if (interaction[i])
+        {
+            significance[i] = inf;
+        }
+    }
+
+    // Pieces of the polylines that still need to be split
+    std::vector<std::tuple<std::size_t, std::size_t, float>> pieces;
+    for (std::size_t t = 0; t < event->num_tracks(); t++)
+    {
+        std::size_t const begin = event->offsets[t];
+        std::size_t const end = event->offsets[t + 1];
+        if (begin == end)
+        {
+            continue;
+        }
+        significance[begin] = inf;
+        significance[end - 1] = inf;
+        for (std::size_t first = begin, last = begin + 1; last < end; last++)
+        {
+            if (significance[last] == inf)
+            {
+                pieces.emplace_back(first, last, inf);
+                first = last;
+            }
+        }
+    }
+
+    while (!pieces.empty())
+    {
+        std::size_t first, last;
+        float parent;
+        std::tie(first, last, parent) = pieces.back();
+        pieces.pop_back();
+        if (last - first < 2)
+        {
+            continue;
+        }
+
+        // Find farthest point from the segment
+        std::size_t split = first + 1;
+        double max_dist = -1;
+        for (auto i = first + 1; i < last; i++)
+        {
+            double const dist
+                = distance_to_segment(points[i], points[first], points[last]);
+            if (dist > max_dist)
+            {
+                max_dist = dist;
+                split = i;
+            }
+        }
+
+        float const sig = std::min(static_cast<float>(max_dist), parent);
+        significance[split] = sig;
+        pieces.emplace_back(first, split, sig);
+        pieces.emplace_back(split, last, sig);
+    }
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Tolerance [cm] of a given detail level.
+ */
+double TrackSimplifier::tolerance(int level) const
+{
+    assert(level >= 0 && level < num_levels_);
+    if (level == num_levels_ - 1)
+    {
+        // Full resolution
+        return 0;
+    }
+    return tolerance_ / std::pow(4.0, level);
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Whether point \c i of an event is kept at a given tolerance. Events without
+ * computed significance are always drawn at full resolution.
+ */
+bool TrackSimplifier::keep(EventData const& event,
+                           std::size_t i,
+                           double tolerance)
+{
+    return tolerance <= 0 || event.significance.empty()
+           || event.significance[i] > tolerance;
+}
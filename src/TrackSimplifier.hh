@@ -0,0 +1,47 @@
+//----------------------------------*-C++-*----------------------------------//
+// Copyright 2023 UT-Battelle, LLC, and other Celeritas developers.
+// See the top-level COPYRIGHT file for details.
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+//---------------------------------------------------------------------------//
+//! \file src/TrackSimplifier.hh
+//---------------------------------------------------------------------------//
+#pragma once
+
+#include "EventData.hh"
+
+//---------------------------------------------------------------------------//
+/*!
+ * Geometric simplification of track polylines with multiple levels of detail.
+ *
+ * Each point is assigned a significance, following the Douglas-Peucker
+ * algorithm: the distance [cm] at which it would be removed from the
+ * polyline. Track endpoints and interaction points are never removed. The
+ * simplified track at any tolerance is the set of points whose significance
+ * exceeds the tolerance, so all detail levels are available from the same
+ * decoded data.
+ *
+ * Detail level 0 is the coarsest and uses the given tolerance; every next
+ * level divides it by four, and the last level keeps all points.
+ */
+class TrackSimplifier
+{
+  public:
+    // Construct with the coarsest tolerance [cm] and the number of levels
+    TrackSimplifier(double tolerance, int num_levels);
+
+    // Compute the significance of every point of an event
+    void operator()(EventData* event) const;
+
+    // Tolerance [cm] of a given detail level
+    double tolerance(int level) const;
+
+    //! Number of detail levels
+    int num_levels() const { return num_levels_; }
+
+    // Whether a point is kept at a given tolerance
+    static bool keep(EventData const& event, std::size_t i, double tolerance);
+
+  private:
+    double tolerance_;
+    int num_levels_;
+};
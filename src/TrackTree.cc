@@ -0,0 +1,152 @@
+//----------------------------------*-C++-*----------------------------------//
+// Copyright 2023 UT-Battelle, LLC, and other Celeritas developers.
+// See the top-level COPYRIGHT file for details.
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+//---------------------------------------------------------------------------//
+//! \file src/TrackTree.cc
+//---------------------------------------------------------------------------//
+#include "TrackTree.hh"
+
+#include <numeric>
+#include <assert.h>
+
+constexpr TrackTree::size_type TrackTree::none;
+
+//---------------------------------------------------------------------------//
+/*!
+ * Build from the parent ids of an event.
+ *
+ * Child lists are filled with a counting sort over the parent of each track.
+ * Generations are then assigned breadth first from the roots; tracks that
+ * cannot be reached from a root, which only happens with inconsistent parent
+ * ids, are detached from their parent and become roots. Without parent ids,
+ * all tracks are roots.
+ */
+TrackTree::TrackTree(EventData const& event)
+{
+    auto const num_tracks = static_cast<size_type>(event.num_tracks());
+    assert(event.parent_ids.empty() || event.parent_ids.size() == num_tracks);
+
+    index_.reserve(num_tracks);
+    for (size_type i = 0; i < num_tracks; i++)
+    {
+        index_.emplace(event.track_ids[i], i);
+    }
+
+    // Count children of each track, then list them
+    parents_.assign(num_tracks, none);
+    child_offsets_.assign(num_tracks + 1, 0);
+    for (size_type i = 0; i < num_tracks && !event.parent_ids.empty(); i++)
+    {
+        auto const parent_id = event.parent_ids[i];
+        auto const parent = parent_id < 0 ? none : this->find(parent_id);
+        if (parent != none && parent != i)
+        {
+            parents_[i] = parent;
+            ++child_offsets_[parent + 1];
+        }
+    }
+    std::partial_sum(
+        child_offsets_.begin(), child_offsets_.end(), child_offsets_.begin());
+    children_.resize(child_offsets_.back());
+    std::vector<size_type> next(child_offsets_.begin(),
+                                child_offsets_.end() - 1);
+    for (size_type i = 0; i < num_tracks; i++)
+    {
+        if (parents_[i] != none)
+        {
+            children_[next[parents_[i]]++] = i;
+        }
+    }
+
+    // Assign generations breadth first from the roots
+    generations_.assign(num_tracks, -1);
+    std::vector<size_type> queue;
+    queue.reserve(num_tracks);
+    for (size_type i = 0; i < num_tracks; i++)
+    {
+        if (parents_[i] == none)
+        {
+            generations_[i] = 0;
+            queue.push_back(i);
+        }
+    }
+    for (std::size_t q = 0; q < queue.size(); q++)
+    {
+        for (auto child : this->children(queue[q]))
+        {
+            generations_[child] = generations_[queue[q]] + 1;
+            queue.push_back(child);
+        }
+    }
+    if (queue.size() == num_tracks)
+    {
+        return;
+    }
+
+    // Detach tracks in parent cycles and compact the child lists
+    for (size_type i = 0; i < num_tracks; i++)
+    {
+        if (generations_[i] < 0)
+        {
+            generations_[i] = 0;
+            parents_[i] = none;
+        }
+    }
+    size_type count = 0;
+    for (size_type i = 0; i < num_tracks; i++)
+    {
+        auto const first = child_offsets_[i];
+        child_offsets_[i] = count;
+        for (auto c = first; c < child_offsets_[i + 1]; c++)
+        {
+            if (parents_[children_[c]] == i)
+            {
+                children_[count++] = children_[c];
+            }
+        }
+    }
+    child_offsets_[num_tracks] = count;
+    children_.resize(count);
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Index of a track id, or \c none if it is not in the event.
+ */
+auto TrackTree::find(int track_id) const -> size_type
+{
+    auto iter = index_.find(track_id);
+    return iter == index_.end() ? none : iter->second;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * A track and all of its descendants, listed breadth first.
+ */
+auto TrackTree::descendants(size_type track) const -> std::vector<size_type>
+{
+    assert(track < this->size());
+    std::vector<size_type> result{track};
+    for (std::size_t i = 0; i < result.size(); i++)
+    {
+        auto const children = this->children(result[i]);
+        result.insert(result.end(), children.begin(), children.end());
+    }
+    return result;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * A track followed by its parent, grandparent, and so on up to its root.
+ */
+auto TrackTree::ancestry(size_type track) const -> std::vector<size_type>
+{
+    assert(track < this->size());
+    std::vector<size_type> result;
+    for (; track != none; track = parents_[track])
+    {
+        result.push_back(track);
+    }
+    return result;
+}
@@ -0,0 +1,97 @@
+//----------------------------------*-C++-*----------------------------------//
+// Copyright 2023 UT-Battelle, LLC, and other Celeritas developers.
+// See the top-level COPYRIGHT file for details.
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+//---------------------------------------------------------------------------//
+//! \file src/TrackTree.hh
+//---------------------------------------------------------------------------//
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "EventData.hh"
+
+//---------------------------------------------------------------------------//
+/*!
+ * Parent/child relations between the tracks of a decoded event.
+ *
+ * Tracks are addressed by their index in the event. Children are stored as
+ * one contiguous list per parent, so that the children of a track are found
+ * in constant time. Tracks whose parent is not in the event, e.g. because it
+ * was removed by the track filter, are roots of their own shower along with
+ * the primaries. The generation of a track is its distance to its root.
+ *
+ * \code
+ *  TrackTree tree(event);
+ *  for (auto child : tree.children(tree.find(track_id)))
+ *  {
+ *      ...
+ *  }
+ * \endcode
+ */
+class TrackTree
+{
+  public:
+    //!@{
+    //! \name Type aliases
+    using size_type = std::uint32_t;
+    //!@}
+
+    //! Marks a missing track
+    static constexpr size_type none = static_cast<size_type>(-1);
+
+    //! Contiguous list of track indices
+    class Range
+    {
+      public:
+        Range(size_type const* first, size_type const* last)
+            : first_(first), last_(last)
+        {
+        }
+        size_type const* begin() const { return first_; }
+        size_type const* end() const { return last_; }
+        std::size_t size() const { return last_ - first_; }
+        bool empty() const { return first_ == last_; }
+
+      private:
+        size_type const* first_;
+        size_type const* last_;
+    };
+
+    // Build from the parent ids of an event
+    explicit TrackTree(EventData const& event);
+
+    //! Number of tracks
+    size_type size() const { return static_cast<size_type>(parents_.size()); }
+
+    // Index of a track id, or \c none if it is not in the event
+    size_type find(int track_id) const;
+
+    //! Parent of a track, or \c none for a root
+    size_type parent(size_type track) const { return parents_[track]; }
+
+    //! Children of a track
+    Range children(size_type track) const
+    {
+        return {children_.data() + child_offsets_[track],
+                children_.data() + child_offsets_[track + 1]};
+    }
+
+    //! Number of generations between a track and its root
+    int generation(size_type track) const { return generations_[track]; }
+
+    // A track and all of its descendants, parents before children
+    std::vector<size_type> descendants(size_type track) const;
+
+    // A track and all of its ancestors, up to its root
+    std::vector<size_type> ancestry(size_type track) const;
+
+  private:
+    std::unordered_map<int, size_type> index_;  //!< Track id to index
+    std::vector<size_type> parents_;
+    std::vector<size_type> child_offsets_;
+    std::vector<size_type> children_;
+    std::vector<int> generations_;
+};
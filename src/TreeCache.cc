@@ -0,0 +1,64 @@
+//----------------------------------*-C++-*----------------------------------//
+// Copyright 2023 UT-Battelle, LLC, and other Celeritas developers.
+// See the top-level COPYRIGHT file for details.
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+//---------------------------------------------------------------------------//
+//! \file src/TreeCache.cc
+//---------------------------------------------------------------------------//
+#include "TreeCache.hh"
+
+#include <algorithm>
+#include <TTreeCache.h>
+
+//---------------------------------------------------------------------------//
+/*!
+ * Set up a read-ahead cache for the given branches of a tree.
+ *
+ * The cache is sized for the compressed baskets of the branches that are
+ * actually read, up to \c max_size [bytes]; a non-positive size disables it.
+ * Since the branches are known, they are registered directly instead of
+ * letting the cache learn them over the first entries, so that the very
+ * first read already fetches the baskets of all of them in one request.
+ */
+void setup_tree_cache(TTree& ttree,
+                      std::vector<TBranch*> const& branches,
+                      Long64_t max_size)
+{
+    if (max_size <= 0 || branches.empty())
+    {
+        ttree.SetCacheSize(0);
+        return;
+    }
+
+    Long64_t used_size = 0;
+    for (auto const* branch : branches)
+    {
+        used_size += branch->GetZipBytes();
+    }
+    used_size = std::max<Long64_t>(used_size, 1 << 20);
+    ttree.SetCacheSize(std::min(max_size, used_size));
+
+    ttree.DropBranchFromCache("*", /* subbranches = */ true);
+    for (auto* branch : branches)
+    {
+        ttree.AddBranchToCache(branch, /* subbranches = */ false);
+    }
+    ttree.StopCacheLearningPhase();
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Input statistics of the read-ahead cache of a tree.
+ */
+TreeCacheStats tree_cache_stats(TTree& ttree, TFile& tfile)
+{
+    TreeCacheStats result;
+    if (auto const* cache = ttree.GetReadCache(&tfile))
+    {
+        result.cached_bytes = cache->GetBytesRead();
+        result.cached_reads = cache->GetReadCalls();
+        result.uncached_bytes = cache->GetNoCacheBytesRead();
+        result.uncached_reads = cache->GetNoCacheReadCalls();
+    }
+    return result;
+}
@@ -0,0 +1,54 @@
+//----------------------------------*-C++-*----------------------------------//
+// Copyright 2023 UT-Battelle, LLC, and other Celeritas developers.
+// See the top-level COPYRIGHT file for details.
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+//---------------------------------------------------------------------------//
+//! \file src/TreeCache.hh
+//---------------------------------------------------------------------------//
+#pragma once
+
+#include <vector>
+#include <TBranch.h>
+#include <TFile.h>
+#include <TTree.h>
+
+//---------------------------------------------------------------------------//
+/*!
+ * Input statistics of a \c TTreeCache , summed over readers.
+ *
+ * Cached reads fill the cache with the baskets of all cached branches for the
+ * upcoming entries in a few large requests. Uncached reads are the baskets
+ * requested outside of the cache, e.g. for entries before the cached range.
+ */
+struct TreeCacheStats
+{
+    Long64_t cached_bytes{0};  //!< Bytes read to fill the cache
+    Long64_t cached_reads{0};  //!< Number of cache fills
+    Long64_t uncached_bytes{0};  //!< Bytes read directly from the file
+    Long64_t uncached_reads{0};  //!< Number of direct reads
+
+    //! Fraction of bytes read through the cache
+    double hit_fraction() const
+    {
+        auto const total = cached_bytes + uncached_bytes;
+        return total > 0 ? static_cast<double>(cached_bytes) / total : 0;
+    }
+
+    //! Accumulate statistics of another reader
+    TreeCacheStats& operator+=(TreeCacheStats const& other)
+    {
+        cached_bytes += other.cached_bytes;
+        cached_reads += other.cached_reads;
+        uncached_bytes += other.uncached_bytes;
+        uncached_reads += other.uncached_reads;
+        return *this;
+    }
+};
+
+// Set up a read-ahead cache for the given branches of a tree
+void setup_tree_cache(TTree& ttree,
+                      std::vector<TBranch*> const& branches,
+                      Long64_t max_size);
+
+// Input statistics of the read-ahead cache of a tree
+TreeCacheStats tree_cache_stats(TTree& ttree, TFile& tfile);
@@ -0,0 +1,160 @@
+//----------------------------------*-C++-*----------------------------------//
+// Copyright 2023 UT-Battelle, LLC, and other Celeritas developers.
+// See the top-level COPYRIGHT file for details.
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+//---------------------------------------------------------------------------//
+//! \file tools/convert.cc
+//! \brief Convert MC truth ROOT files to the display-optimized event file.
+//---------------------------------------------------------------------------//
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <TROOT.h>
+
+#include "EvdCacheFile.hh"
+#include "EventViewer.hh"
+#include "ParallelFor.hh"
+
+//---------------------------------------------------------------------------//
+/*!
+ * Terminal input options.
+ */
+struct TerminalInput
+{
+    std::string input_file;
+    std::string output_file;
+    unsigned int num_threads{default_num_threads()};
+    TrackFilter filter;
+
+    // Input and output are necessary
+    explicit operator bool() const
+    {
+        return !input_file.empty() && !output_file.empty();
+    }
+};
+
+//---------------------------------------------------------------------------//
+/*!
+ * Parse terminal input parameters.
+ */
+TerminalInput parse(int argc, char* argv[])
+{
+    TerminalInput input;
+    auto value = [&](int i) -> std::string {
+        if (i == argc - 1)
+        {
+            std::cout << "[ERROR] missing value for " << argv[i] << " flag."
+                      << std::endl;
+            std::exit(EXIT_FAILURE);
+        }
+        return argv[i + 1];
+    };
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg_i(argv[i]);
+        if (arg_i == "-threads")
+        {
+            input.num_threads = std::stoul(value(i++));
+        }
+        else if (arg_i == "-events")
+        {
+            input.filter.set_event_range(value(i++));
+        }
+        else if (arg_i == "-select")
+        {
+            input.filter.track_select
+                = Expression(value(i++), Expression::Scope::track);
+        }
+        else if (arg_i == "-event-select")
+        {
+            input.filter.event_select
+                = Expression(value(i++), Expression::Scope::event);
+        }
+        else if (input.input_file.empty())
+        {
+            input.input_file = arg_i;
+        }
+        else if (input.output_file.empty())
+        {
+            input.output_file = arg_i;
+        }
+        else
+        {
+            std::cout << "[WARNING] Parameter " << arg_i
+                      << " not known. Skipping..." << std::endl;
+        }
+    }
+    return input;
+}
+
+//---------------------------------------------------------------------------//
+/*!
+ * Convert a geant4-validation-app or RootStepWriter file.
+ *
+ * All tracks of the selected events are decoded with their attributes and
+ * interaction flags on worker threads, and written in event id order. Only
+ * the tracks and events passing the selection expressions are written, and
+ * energy deposits and global times only if the input has them.
+ *
+ * \code
+ *  evd-convert simulation.root simulation.evd [-threads n]
+ *              [-events first:last:stride] [-select expr]
+ *              [-event-select expr]
+ * \endcode
+ */
+int main(int argc, char* argv[])
+{
+    auto const input = parse(argc, argv);
+    if (!input || input.num_threads < 1)
+    {
+        std::cout << "Usage: evd-convert input.root output.evd [-threads n] "
+                     "[-events first:last:stride] [-select expr] "
+                     "[-event-select expr]"
+                  << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    ROOT::EnableThreadSafety();
+    auto const start = std::chrono::steady_clock::now();
+
+    UPRootExtern<TFile> tfile(TFile::Open(input.input_file.c_str(), "read"));
+    if (!tfile || tfile->IsZombie())
+    {
+        std::cout << "[ERROR] Could not open " << input.input_file
+                  << std::endl;
+        return EXIT_FAILURE;
+    }
+    auto viewer = EventViewer::make_viewer(std::move(tfile));
+    viewer->set_num_threads(input.num_threads);
+    viewer->set_filter(input.filter);
+    viewer->set_decode_attributes(true);
+
+    // Only store the per-point data that the input provides
+    std::uint32_t flags = 0;
+    if (viewer->has_energy_deposition())
+    {
+        flags |= EvdCacheFormat::energy_deposition;
+    }
+    if (viewer->has_times())
+    {
+        flags |= EvdCacheFormat::times;
+    }
+    EvdCacheWriter writer(input.output_file, flags);
+    std::size_t num_events = 0;
+    std::size_t num_tracks = 0;
+    viewer->for_each_event([&](EventData const& event) {
+        writer.write(event);
+        ++num_events;
+        num_tracks += event.num_tracks();
+    });
+    writer.close();
+
+    std::chrono::duration<double> const time
+        = std::chrono::steady_clock::now() - start;
+    std::cout << "Wrote " << num_events << " events with " << num_tracks
+              << " tracks to " << input.output_file << " ("
+              << writer.num_bytes() / (1024.0 * 1024.0) << " MiB) in "
+              << time.count() << " s" << std::endl;
+    return EXIT_SUCCESS;
+}